@@ -20,6 +20,7 @@
 /* Includes ------------------------------------------------------------------*/
 #include "main.h"
 #include "modbus_slave.h"
+#include "modbus_cfg_store.h"
 #include <string.h>
 
 /* ============================================================================
@@ -53,8 +54,11 @@ extern UART_HandleTypeDef huart2;  /* UART2句柄 */
  *    // 访问共享数据
  *    osMutexRelease(dataMutexHandle);
  * 
- * 3. 无锁方案 - 使用volatile + 原子标志位:
- *    适用于单写者多读者场景
+ * 3. 无锁方案 - 顺序锁 (data_map.seqlock / Modbus_Segment_t.seqlock):
+ *    适用于单写者多读者场景，写入方不被阻塞，读请求得到一致快照
+ *    Modbus_SeqlockWriteBegin(&data_lock);
+ *    // 更新跨寄存器的数据 (如32位浮点数)
+ *    Modbus_SeqlockWriteEnd(&data_lock);
  * 
  * 对于本示例的简单应用场景(主循环更新数据, 两个Modbus只读访问):
  * - 16位寄存器的读取天然是原子的
@@ -101,24 +105,35 @@ static uint8_t mb2_tx_buf[MODBUS_BUF_SIZE];
  * ============================================================================ */
 
 /**
- * @brief   Flash存储的配置结构体
+ * @brief   运行时配置结构体
  */
 typedef struct {
-    uint32_t magic_key;     /* 魔数标识 (0xDEADBEEF) */
     uint8_t  slave_addr1;   /* 实例1从站地址 */
     uint8_t  slave_addr2;   /* 实例2从站地址 */
     uint32_t baud_rate;     /* 波特率 */
-    uint8_t  reserved[2];   /* 对齐填充 */
 } FlashConfig_t;
 
-#define FLASH_MAGIC_KEY     0xDEADBEEF
 #define DEFAULT_SLAVE_ADDR1 0x01
 #define DEFAULT_SLAVE_ADDR2 0x02
 #define DEFAULT_BAUD_RATE   9600
 
-/* 存储的配置 (实际应用中应从Flash读取) */
+/* 配置存储中的参数键 */
+#define CFG_KEY_SLAVE_ADDR1 0x0000
+#define CFG_KEY_SLAVE_ADDR2 0x0001
+#define CFG_KEY_BAUD_RATE   0x0002
+
+/* 配置存储区: Flash末尾两页 (此处以G4系列2KB页为例，按芯片修改) */
+static const ModbusCfg_Config_t g_cfg_store = {
+    .page_addr = { 0x0807F000, 0x0807F800 },
+    .page_size = 0x800,
+    .erase = {
+        { .TypeErase = FLASH_TYPEERASE_PAGES, .Banks = FLASH_BANK_2, .Page = 126, .NbPages = 1 },
+        { .TypeErase = FLASH_TYPEERASE_PAGES, .Banks = FLASH_BANK_2, .Page = 127, .NbPages = 1 },
+    },
+};
+
+/* 当前配置 (默认值，启动时由配置存储覆盖) */
 static FlashConfig_t g_flash_config = {
-    .magic_key = FLASH_MAGIC_KEY,
     .slave_addr1 = DEFAULT_SLAVE_ADDR1,
     .slave_addr2 = DEFAULT_SLAVE_ADDR2,
     .baud_rate = DEFAULT_BAUD_RATE
@@ -137,9 +152,31 @@ static const uint32_t BAUD_RATE_TABLE[] = {
     115200   /* 8 */
 };
 
-/* 待处理的配置更新标志 */
+/* 待生效的配置更新标志 (持久化完成后复位) */
 static volatile bool g_config_update_pending = false;
 
+/**
+ * @brief   从配置存储加载参数
+ * @note    未存储或超出范围的参数保持默认值
+ */
+static void Config_Load(void) {
+    uint32_t value;
+    
+    if (!ModbusCfg_Init(&g_cfg_store)) {
+        return;
+    }
+    
+    value = g_flash_config.slave_addr1;
+    if (ModbusCfg_Get(CFG_KEY_SLAVE_ADDR1, &value) && value >= 1 && value <= 247) {
+        g_flash_config.slave_addr1 = (uint8_t)value;
+    }
+    value = g_flash_config.slave_addr2;
+    if (ModbusCfg_Get(CFG_KEY_SLAVE_ADDR2, &value) && value >= 1 && value <= 247) {
+        g_flash_config.slave_addr2 = (uint8_t)value;
+    }
+    (void)ModbusCfg_Get(CFG_KEY_BAUD_RATE, &g_flash_config.baud_rate);
+}
+
 /* ============================================================================
  *                              回调函数实现
  * ============================================================================ */
@@ -156,7 +193,9 @@ static volatile bool g_config_update_pending = false;
  *          param_addr = 0x0000: 修改从站地址, param_val = 1~247
  *          param_addr = 0x0001: 修改波特率, param_val = 1~8 (查表)
  * 
- * @warning Flash写入和系统复位应在主循环中执行，避免在中断上下文中操作
+ * @note    ModbusCfg_Set() 只更新RAM并登记写入，Flash编程由主循环中的 ModbusCfg_Poll() 在后台完成
+ * 
+ * @warning 系统复位应在主循环中执行，避免在中断上下文中操作
  */
 static bool CustomConfigCallback(ModbusHandle_t *hmodbus, uint16_t param_addr, uint16_t param_val) {
     /* 参数地址 0x0000: 修改从站地址 */
@@ -165,8 +204,8 @@ static bool CustomConfigCallback(ModbusHandle_t *hmodbus, uint16_t param_addr, u
             /* 更新运行时地址 */
             Modbus_SetSlaveAddr(hmodbus, (uint8_t)param_val);
             
-            /* 标记需要保存配置
-             * 实际Flash写入和复位应在主循环中执行 */
+            /* 登记持久化 (立即返回)，复位在主循环中写入完成后执行 */
+            (void)ModbusCfg_Set(hmodbus == &hModbus1 ? CFG_KEY_SLAVE_ADDR1 : CFG_KEY_SLAVE_ADDR2, param_val);
             g_config_update_pending = true;
             
             return true;
@@ -181,7 +220,8 @@ static bool CustomConfigCallback(ModbusHandle_t *hmodbus, uint16_t param_addr, u
             /* 更新运行时波特率 */
             Modbus_SetBaudRate(hmodbus, new_baud);
             
-            /* 标记需要保存配置 */
+            /* 登记持久化 */
+            (void)ModbusCfg_Set(CFG_KEY_BAUD_RATE, new_baud);
             g_config_update_pending = true;
             
             return true;
@@ -207,7 +247,8 @@ static bool CustomConfigCallback(ModbusHandle_t *hmodbus, uint16_t param_addr, u
 static bool WriteCallback(ModbusHandle_t *hmodbus, uint8_t func_code, 
                           uint16_t start_addr, uint16_t quantity) {
     /* 示例: 禁止写入地址100以后的寄存器 */
-    if (func_code == MB_FUNC_WRITE_SINGLE_REG || func_code == MB_FUNC_WRITE_MULTI_REGS) {
+    if (func_code == MB_FUNC_WRITE_SINGLE_REG || func_code == MB_FUNC_WRITE_MULTI_REGS ||
+        func_code == MB_FUNC_MASK_WRITE_REG || func_code == MB_FUNC_READ_WRITE_REGS) {
         if (start_addr + quantity > 100) {
             return false;  /* 拒绝写入 */
         }
@@ -332,23 +373,32 @@ static bool Modbus_AppInit(void) {
  *          或者直接在此文件中实现
  */
 void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) {
-    /* 根据UART实例分发到对应的Modbus处理 */
-    if (huart->Instance == USART1) {
-        Modbus_RxCallback(&hModbus1, Size);
-    } else if (huart->Instance == USART2) {
-        Modbus_RxCallback(&hModbus2, Size);
-    }
+    /* 经注册表按UART实例查表分发到对应的Modbus处理 */
+    Modbus_DispatchRxEvent(huart, Size);
 }
 
 /**
  * @brief   UART发送完成回调函数 (DMA模式时需要)
  */
 void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
-    if (huart->Instance == USART1) {
-        Modbus_TxCallback(&hModbus1);
-    } else if (huart->Instance == USART2) {
-        Modbus_TxCallback(&hModbus2);
-    }
+    Modbus_DispatchTxCplt(huart);
+}
+
+/**
+ * @brief   Flash操作完成回调函数 (配置存储后台写入)
+ * @note    需在CubeMX中使能FLASH全局中断
+ */
+void HAL_FLASH_EndOfOperationCallback(uint32_t ReturnValue) {
+    (void)ReturnValue;
+    ModbusCfg_FlashCallback(true);
+}
+
+/**
+ * @brief   Flash操作错误回调函数
+ */
+void HAL_FLASH_OperationErrorCallback(uint32_t ReturnValue) {
+    (void)ReturnValue;
+    ModbusCfg_FlashCallback(false);
 }
 
 /* ============================================================================
@@ -367,6 +417,9 @@ int main(void) {
     // MX_USART1_UART_Init();
     // MX_USART2_UART_Init();
     
+    /* 读取已保存的从站地址与波特率 */
+    Config_Load();
+    
     /* 初始化所有Modbus实例 */
     if (!Modbus_AppInit()) {
         Error_Handler();
@@ -382,9 +435,9 @@ int main(void) {
     
     while (1) {
         /* ==================== Modbus协议处理 ==================== */
-        /* 两个实例并行工作，处理各自UART接收的数据 */
-        Modbus_Process(&hModbus1);
-        Modbus_Process(&hModbus2);
+        /* 两个实例并行工作，仅处理已收到完整帧的实例
+         * (等价于依次调用 Modbus_Process(&hModbus1) / Modbus_Process(&hModbus2)) */
+        Modbus_ProcessAll();
         
         /* ==================== 应用逻辑示例 ==================== */
         
@@ -412,26 +465,48 @@ int main(void) {
             HAL_GPIO_WritePin(GPIOC, GPIO_PIN_13, GPIO_PIN_SET);    /* LED OFF */
         }
         
-        /* 示例3: 处理配置更新请求
-         * 0x64功能码回调只设置标志位，实际Flash操作在这里执行
-         * 这样避免了在中断上下文中进行耗时的Flash操作 */
-        if (g_config_update_pending) {
+        /* 示例3: 配置持久化
+         * 0x64功能码回调只登记参数，擦除/编程在后台进行，每次调用不等待Flash
+         * 所有修改写入完成后再复位使新配置生效 */
+        ModbusCfg_Poll();
+        if (g_config_update_pending && !ModbusCfg_Busy()) {
             g_config_update_pending = false;
             
-            /* 更新配置结构体 */
-            g_flash_config.slave_addr1 = Modbus_GetSlaveAddr(&hModbus1);
-            g_flash_config.slave_addr2 = Modbus_GetSlaveAddr(&hModbus2);
-            g_flash_config.baud_rate = Modbus_GetBaudRate(&hModbus1);
-            
-            /* TODO: 保存配置到Flash
-             * Flash_SaveConfig(&g_flash_config);
-             * 
-             * 延时后重启:
-             * HAL_Delay(50);
-             * NVIC_SystemReset();
-             */
+            /* 延时等待0x64响应发送完成后重启 */
+            HAL_Delay(50);
+            NVIC_SystemReset();
         }
         
+        /* 示例4: 低功耗 (电池供电、轮询间隔较长的节点)
+         * 两个实例均空闲时进入STOP模式，主站请求的起始位唤醒MCU
+         * (config.stop_wake = true，且USART内核时钟在CubeMX中选为HSI)
+         * 
+         * __disable_irq();
+         * if (Modbus_IsIdle(&hModbus1) && Modbus_IsIdle(&hModbus2)) {
+         *     Modbus_EnterStop(&hModbus1);
+         *     Modbus_EnterStop(&hModbus2);
+         *     HAL_SuspendTick();
+         *     HAL_PWREx_EnterSTOP2Mode(PWR_STOPENTRY_WFI);
+         *     __enable_irq();
+         *     SystemClock_Config();
+         *     HAL_ResumeTick();
+         *     Modbus_ExitStop(&hModbus1);
+         *     Modbus_ExitStop(&hModbus2);
+         * }
+         * __enable_irq();
+         */
+        
+        /* 示例5: 写入事件队列 (config.event_queue 配置时)
+         * 写请求校验后立即应答，耗时的后续处理在此取出执行，不影响应答延迟
+         * 
+         * Modbus_Event_t event;
+         * while (Modbus_EventFetch(&hModbus1, &event)) {
+         *     if (event.func_code == MB_FUNC_WRITE_MULTI_REGS) {
+         *         Control_ApplyRegisters(event.addr, event.value);
+         *     }
+         * }
+         */
+        
         /* 其他应用逻辑... */
     }
 }
@@ -0,0 +1,894 @@
+/**
+ * @file    modbus_bench.c
+ * @brief   Modbus从站协议栈主机基准测试
+ * @version 2.0.0
+ * @date    2025
+ *
+ * @details 经模拟串口逐字节送入请求帧，计时从首字节到达至响应发送完成的完整路径
+ *          (接收中断、快速路径、Modbus_Process() 解析与组帧、CRC):
+ *          1. 各功能码 × CRC后端/接收方式/发送方式/传输层 (HAL或LL)，输出每帧耗时 (ns)
+ *          2. 1~8个实例经注册表分发 (Modbus_DispatchRxEvent / Modbus_ProcessAll) 的每帧耗时
+ *          3. 网关转发 (实例0路由到实例1) 的往返耗时
+ *          每种组合先校验一次响应 (地址、功能码、CRC)，网关逐字节校验转发的请求、发回的应答、
+ *          等待期间保持待处理的请求与超时异常; 响应缓存逐字节校验 0x03/0x04 响应在每种失效
+ *          操作后与数据区一致; 脏位图与写入提交逐项校验取出的连续范围与 commit_cb 收到的各批范围，
+ *          校验失败时返回非0
+ *
+ * @note    用法: modbus_bench [--quick] [--iterations N] [--csv]
+ *          主机耗时只用于比较同一机器上的前后版本，不代表目标板上的绝对时间
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include "modbus_slave.h"
+#include "modbus_port_ll.h"
+#include "host_hal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* ============================================================================
+ *                              测试配置
+ * ============================================================================ */
+
+#define BENCH_SLAVE_ADDR     1U
+#define BENCH_BUF_SIZE       256U
+#define BENCH_RING_SIZE      512U
+#define BENCH_MAX_INSTANCES  8U
+#define BENCH_POINTS         256U
+#define BENCH_ROUTE_ADDR     0x11U    /**< 网关转发到实例1的从站地址 */
+#define BENCH_BRIDGE_TIMEOUT 50U      /**< 网关下游应答超时 (ms) */
+
+/**
+ * @brief   协议栈配置组合 (基准表的列)
+ */
+typedef struct {
+    const char      *name;
+    Modbus_CrcMode_t crc_mode;
+    bool             incremental_crc;
+    Modbus_RxMode_t  rx_mode;
+    bool             use_dma_tx;
+    bool             fast_path;
+    bool             pipelined_tx;
+    bool             ll_port;
+    bool             resp_cache;
+} Bench_Config_t;
+
+static const Bench_Config_t s_configs[] = {
+    { "shift",     MODBUS_CRC_SHIFT,  false, MODBUS_RX_IT_PINGPONG, false, false, false, false, false },
+    { "table",     MODBUS_CRC_TABLE,  false, MODBUS_RX_IT_PINGPONG, false, false, false, false, false },
+    { "nibble",    MODBUS_CRC_NIBBLE, false, MODBUS_RX_IT_PINGPONG, false, false, false, false, false },
+    { "table+inc", MODBUS_CRC_TABLE,  true,  MODBUS_RX_IT_PINGPONG, false, false, false, false, false },
+    { "ring",      MODBUS_CRC_TABLE,  false, MODBUS_RX_DMA_RING,    true,  false, false, false, false },
+    { "fast",      MODBUS_CRC_TABLE,  false, MODBUS_RX_IT_PINGPONG, true,  true,  false, false, false },
+    { "pipe",      MODBUS_CRC_TABLE,  false, MODBUS_RX_IT_PINGPONG, true,  false, true,  false, false },
+    { "ll",        MODBUS_CRC_TABLE,  false, MODBUS_RX_IT_PINGPONG, true,  false, false, true,  false },
+    { "ll+inc",    MODBUS_CRC_TABLE,  true,  MODBUS_RX_IT_PINGPONG, true,  false, false, true,  false },
+    { "cache",     MODBUS_CRC_TABLE,  false, MODBUS_RX_IT_PINGPONG, true,  false, false, false, true  },
+};
+
+#define BENCH_CONFIG_COUNT   (sizeof(s_configs) / sizeof(s_configs[0]))
+
+/**
+ * @brief   基准请求 (基准表的行)
+ */
+typedef struct {
+    const char *name;
+    uint8_t     frame[BENCH_BUF_SIZE];
+    uint16_t    length;           /**< 含地址与CRC */
+    bool        expect_reply;     /**< false=他站帧，不应应答 */
+    bool        expect_exception; /**< 期望异常响应 */
+} Bench_Request_t;
+
+/* ============================================================================
+ *                              数据区与实例
+ * ============================================================================ */
+
+static uint8_t  s_coils[BENCH_POINTS / 8];
+static uint8_t  s_discrete[BENCH_POINTS / 8];
+static uint16_t s_holding[BENCH_POINTS];
+static uint16_t s_input[BENCH_POINTS];
+
+static HostUart_t     s_uart[BENCH_MAX_INSTANCES];
+static ModbusLL_Port_t s_ll_port[BENCH_MAX_INSTANCES];
+static ModbusHandle_t s_modbus[BENCH_MAX_INSTANCES];
+static uint8_t        s_rx_a[BENCH_MAX_INSTANCES][BENCH_RING_SIZE];
+static uint8_t        s_rx_b[BENCH_MAX_INSTANCES][BENCH_BUF_SIZE];
+static uint8_t        s_tx[BENCH_MAX_INSTANCES][BENCH_BUF_SIZE];
+static Modbus_RespCacheEntry_t s_resp_cache[BENCH_MAX_INSTANCES][4];
+
+static Bench_Request_t s_requests[16];
+static uint32_t        s_request_count;
+
+/* ============================================================================
+ *                              HAL回调 (与目标板上的写法相同)
+ * ============================================================================ */
+
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) {
+    Modbus_DispatchRxEvent(huart, Size);
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
+    Modbus_DispatchTxCplt(huart);
+}
+
+static void Bench_UartIrq(HostUart_t *uart) {
+    Modbus_UART_IRQHandler(Modbus_FindByUart(&uart->huart));
+}
+
+static void Bench_UartIrqLL(HostUart_t *uart) {
+    ModbusLL_IRQHandler(&s_modbus[uart - s_uart]);
+}
+
+static bool Bench_CustomConfig(ModbusHandle_t *hmodbus, uint16_t param_addr, uint16_t param_value) {
+    (void)hmodbus;
+    (void)param_addr;
+    (void)param_value;
+    return true;
+}
+
+/* ============================================================================
+ *                              请求构造
+ * ============================================================================ */
+
+/**
+ * @brief   参考CRC (逐位实现，与协议栈的各后端互相独立)
+ */
+static uint16_t Bench_CRC16(const uint8_t *data, uint16_t len) {
+    uint16_t crc = 0xFFFF;
+    for (uint16_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (uint8_t j = 0; j < 8; j++) {
+            crc = (crc & 1U) ? (uint16_t)((crc >> 1) ^ 0xA001U) : (uint16_t)(crc >> 1);
+        }
+    }
+    return crc;
+}
+
+static void Bench_Frame(Bench_Request_t *req, const char *name, uint8_t addr, const uint8_t *pdu, uint16_t pdu_len) {
+    req->name = name;
+    req->frame[0] = addr;
+    memcpy(&req->frame[1], pdu, pdu_len);
+    uint16_t crc = Bench_CRC16(req->frame, pdu_len + 1);
+    req->frame[pdu_len + 1] = crc & 0xFF;
+    req->frame[pdu_len + 2] = (crc >> 8) & 0xFF;
+    req->length = pdu_len + 3;
+}
+
+static void Bench_AddRequest(const char *name, uint8_t addr, const uint8_t *pdu, uint16_t pdu_len,
+                             bool expect_exception) {
+    Bench_Request_t *req = &s_requests[s_request_count++];
+
+    Bench_Frame(req, name, addr, pdu, pdu_len);
+    req->expect_reply = (addr == BENCH_SLAVE_ADDR);
+    req->expect_exception = expect_exception;
+}
+
+static void Bench_BuildRequests(void) {
+    static const uint8_t rd_coils[]    = { 0x01, 0x00, 0x00, 0x00, 0x40 };
+    static const uint8_t rd_discrete[] = { 0x02, 0x00, 0x00, 0x00, 0x40 };
+    static const uint8_t rd_hold_16[]  = { 0x03, 0x00, 0x00, 0x00, 0x10 };
+    static const uint8_t rd_hold_125[] = { 0x03, 0x00, 0x00, 0x00, 0x7D };
+    static const uint8_t rd_input[]    = { 0x04, 0x00, 0x00, 0x00, 0x10 };
+    static const uint8_t wr_coil[]     = { 0x05, 0x00, 0x03, 0xFF, 0x00 };
+    static const uint8_t wr_reg[]      = { 0x06, 0x00, 0x05, 0x12, 0x34 };
+    static const uint8_t diag_echo[]   = { 0x08, 0x00, 0x00, 0xA5, 0x5A };
+    static const uint8_t wr_coils[]    = { 0x0F, 0x00, 0x00, 0x00, 0x20, 0x04, 0x55, 0xAA, 0x0F, 0xF0 };
+    static const uint8_t mask_wr[]     = { 0x16, 0x00, 0x04, 0x00, 0xF2, 0x00, 0x25 };
+    static const uint8_t custom[]      = { 0x64, 0x00, 0x10, 0x00, 0x01 };
+    static const uint8_t bad_addr[]    = { 0x03, 0xFF, 0x00, 0x00, 0x01 };
+    uint8_t pdu[BENCH_BUF_SIZE];
+
+    Bench_AddRequest("01 read 64 coils", BENCH_SLAVE_ADDR, rd_coils, sizeof(rd_coils), false);
+    Bench_AddRequest("02 read 64 inputs", BENCH_SLAVE_ADDR, rd_discrete, sizeof(rd_discrete), false);
+    Bench_AddRequest("03 read 16 regs", BENCH_SLAVE_ADDR, rd_hold_16, sizeof(rd_hold_16), false);
+    Bench_AddRequest("03 read 125 regs", BENCH_SLAVE_ADDR, rd_hold_125, sizeof(rd_hold_125), false);
+    Bench_AddRequest("04 read 16 regs", BENCH_SLAVE_ADDR, rd_input, sizeof(rd_input), false);
+    Bench_AddRequest("05 write coil", BENCH_SLAVE_ADDR, wr_coil, sizeof(wr_coil), false);
+    Bench_AddRequest("06 write reg", BENCH_SLAVE_ADDR, wr_reg, sizeof(wr_reg), false);
+    Bench_AddRequest("08 echo", BENCH_SLAVE_ADDR, diag_echo, sizeof(diag_echo), false);
+    Bench_AddRequest("0F write 32 coils", BENCH_SLAVE_ADDR, wr_coils, sizeof(wr_coils), false);
+
+    /* 0x10: 写16个寄存器 */
+    pdu[0] = 0x10; pdu[1] = 0x00; pdu[2] = 0x20; pdu[3] = 0x00; pdu[4] = 0x10; pdu[5] = 0x20;
+    for (uint16_t i = 0; i < 32; i++) {
+        pdu[6 + i] = (uint8_t)i;
+    }
+    Bench_AddRequest("10 write 16 regs", BENCH_SLAVE_ADDR, pdu, 38, false);
+
+    Bench_AddRequest("16 mask write", BENCH_SLAVE_ADDR, mask_wr, sizeof(mask_wr), false);
+
+    /* 0x17: 写16个寄存器后读16个寄存器 */
+    pdu[0] = 0x17;
+    pdu[1] = 0x00; pdu[2] = 0x40; pdu[3] = 0x00; pdu[4] = 0x10;
+    pdu[5] = 0x00; pdu[6] = 0x40; pdu[7] = 0x00; pdu[8] = 0x10; pdu[9] = 0x20;
+    for (uint16_t i = 0; i < 32; i++) {
+        pdu[10 + i] = (uint8_t)(0x80 + i);
+    }
+    Bench_AddRequest("17 read/write 16", BENCH_SLAVE_ADDR, pdu, 42, false);
+
+    Bench_AddRequest("64 custom config", BENCH_SLAVE_ADDR, custom, sizeof(custom), false);
+    Bench_AddRequest("exception (address)", BENCH_SLAVE_ADDR, bad_addr, sizeof(bad_addr), true);
+    Bench_AddRequest("foreign slave", BENCH_SLAVE_ADDR + 1, rd_hold_125, sizeof(rd_hold_125), false);
+}
+
+/* ============================================================================
+ *                              实例与计时
+ * ============================================================================ */
+
+/**
+ * @brief   按配置组合初始化一个实例
+ * @param   extra   附加配置 (NULL=无): 取其中的网关转发、脏位图与写入提交配置
+ */
+static bool Bench_InitInstance(uint32_t idx, const Bench_Config_t *cfg, const Modbus_Config_t *extra) {
+    if (cfg->ll_port) {
+        HostUart_InitLL(&s_uart[idx]);
+        s_uart[idx].irq_handler = Bench_UartIrqLL;
+        ModbusLL_Init(&s_ll_port[idx], &s_uart[idx].regs);
+    } else {
+        HostUart_Init(&s_uart[idx], cfg->rx_mode == MODBUS_RX_DMA_RING);
+        s_uart[idx].irq_handler = Bench_UartIrq;
+    }
+    memset(&s_modbus[idx], 0, sizeof(s_modbus[idx]));
+
+    Modbus_Config_t config = {
+        .huart = cfg->ll_port ? NULL : &s_uart[idx].huart,
+        .transport = cfg->ll_port ? &ModbusLL_Transport : NULL,
+        .transport_ctx = &s_ll_port[idx],
+        .slave_addr = BENCH_SLAVE_ADDR,
+        .baud_rate = 115200,
+        .buffer = {
+            .rx_buf_a = s_rx_a[idx],
+            .rx_buf_b = s_rx_b[idx],
+            .tx_buf = s_tx[idx],
+            .rx_buf_size = (cfg->rx_mode == MODBUS_RX_DMA_RING) ? BENCH_RING_SIZE : BENCH_BUF_SIZE,
+            .tx_buf_size = BENCH_BUF_SIZE,
+        },
+        .data_map = {
+            .coils = s_coils,                .coil_count = BENCH_POINTS,
+            .discrete_inputs = s_discrete,   .discrete_count = BENCH_POINTS,
+            .holding_regs = s_holding,       .holding_reg_count = BENCH_POINTS,
+            .input_regs = s_input,           .input_reg_count = BENCH_POINTS,
+        },
+        .fast_path = {
+            .enabled = cfg->fast_path,
+            .flat_areas = 0x0F,
+        },
+        .rx_mode = cfg->rx_mode,
+        .use_dma_tx = cfg->use_dma_tx,
+        .pipelined_tx = cfg->pipelined_tx,
+        .incremental_crc = cfg->incremental_crc,
+        .crc_mode = cfg->crc_mode,
+        .custom_config_cb = Bench_CustomConfig,
+        .resp_cache = { s_resp_cache[idx], cfg->resp_cache ? 4U : 0U },
+    };
+    if (extra != NULL) {
+        config.bridge = extra->bridge;
+        config.data_map.coil_dirty = extra->data_map.coil_dirty;
+        config.data_map.holding_dirty = extra->data_map.holding_dirty;
+        config.commit_cb = extra->commit_cb;
+        config.commit_window_ms = extra->commit_window_ms;
+    }
+
+    return Modbus_Init(&s_modbus[idx], &config);
+}
+
+/**
+ * @brief   送入一帧并运行至响应发送完成
+ */
+static void Bench_Exchange(uint32_t idx, const Bench_Request_t *req) {
+    HostUart_t *uart = &s_uart[idx];
+
+    HostUart_TxClear(uart);
+    HostUart_Receive(uart, req->frame, req->length);
+    Modbus_Process(&s_modbus[idx]);
+    while (HostUart_TxComplete(uart)) {
+        Modbus_Process(&s_modbus[idx]);
+    }
+}
+
+/**
+ * @brief   校验最近一次响应
+ */
+static bool Bench_CheckReply(uint32_t idx, const Bench_Request_t *req) {
+    const HostUart_t *uart = &s_uart[idx];
+
+    if (!req->expect_reply) {
+        return uart->tx_len == 0;
+    }
+    if (uart->tx_len < 5 || Bench_CRC16(uart->tx_buf, uart->tx_len) != 0) {
+        return false;
+    }
+    if (uart->tx_buf[0] != BENCH_SLAVE_ADDR || (uart->tx_buf[1] & 0x7FU) != req->frame[1]) {
+        return false;
+    }
+    return ((uart->tx_buf[1] & 0x80U) != 0) == req->expect_exception;
+}
+
+static uint64_t Bench_NowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* ============================================================================
+ *                              基准
+ * ============================================================================ */
+
+/**
+ * @brief   各功能码 × 配置组合
+ * @return  校验失败的组合数
+ */
+static uint32_t Bench_FunctionCodes(uint32_t iterations, bool csv) {
+    static double ns[16][BENCH_CONFIG_COUNT];
+    uint32_t failures = 0;
+
+    for (uint32_t c = 0; c < BENCH_CONFIG_COUNT; c++) {
+        if (!Bench_InitInstance(0, &s_configs[c], NULL)) {
+            printf("init failed: %s\n", s_configs[c].name);
+            return 1;
+        }
+        for (uint32_t r = 0; r < s_request_count; r++) {
+            const Bench_Request_t *req = &s_requests[r];
+
+            Bench_Exchange(0, req);
+            if (!Bench_CheckReply(0, req)) {
+                printf("bad reply: %s / %s\n", req->name, s_configs[c].name);
+                failures++;
+            }
+
+            uint64_t start = Bench_NowNs();
+            for (uint32_t i = 0; i < iterations; i++) {
+                Bench_Exchange(0, req);
+            }
+            ns[r][c] = (double)(Bench_NowNs() - start) / iterations;
+        }
+    }
+
+    if (csv) {
+        for (uint32_t r = 0; r < s_request_count; r++) {
+            for (uint32_t c = 0; c < BENCH_CONFIG_COUNT; c++) {
+                printf("fc,%s,%s,%.1f\n", s_requests[r].name, s_configs[c].name, ns[r][c]);
+            }
+        }
+        return failures;
+    }
+
+    printf("%-22s", "ns/frame");
+    for (uint32_t c = 0; c < BENCH_CONFIG_COUNT; c++) {
+        printf("%10s", s_configs[c].name);
+    }
+    printf("\n");
+    for (uint32_t r = 0; r < s_request_count; r++) {
+        printf("%-22s", s_requests[r].name);
+        for (uint32_t c = 0; c < BENCH_CONFIG_COUNT; c++) {
+            printf("%10.1f", ns[r][c]);
+        }
+        printf("\n");
+    }
+    return failures;
+}
+
+/**
+ * @brief   1~8个实例轮流接收请求，经注册表分发
+ * @return  校验失败的组合数
+ */
+static uint32_t Bench_Instances(uint32_t iterations, bool csv) {
+    const Bench_Config_t *cfg = &s_configs[1];
+    const Bench_Request_t *req = &s_requests[2];  /* 03 read 16 regs */
+    uint32_t failures = 0;
+
+    if (!csv) {
+        printf("\n%-22s%10s\n", "instances", "ns/frame");
+    }
+    for (uint32_t n = 1; n <= BENCH_MAX_INSTANCES; n++) {
+        for (uint32_t i = 0; i < n; i++) {
+            if (!Bench_InitInstance(i, cfg, NULL)) {
+                printf("init failed: instance %lu\n", (unsigned long)i);
+                return failures + 1;
+            }
+        }
+
+        uint64_t start = Bench_NowNs();
+        for (uint32_t i = 0; i < iterations; i++) {
+            HostUart_t *uart = &s_uart[i % n];
+            HostUart_TxClear(uart);
+            HostUart_Receive(uart, req->frame, req->length);
+            Modbus_ProcessAll();
+        }
+        double ns = (double)(Bench_NowNs() - start) / iterations;
+
+        for (uint32_t i = 0; i < n; i++) {
+            if (!Bench_CheckReply(i, req)) {
+                printf("bad reply: instance %lu of %lu\n", (unsigned long)i, (unsigned long)n);
+                failures++;
+            }
+        }
+
+        if (csv) {
+            printf("instances,%lu,%s,%.1f\n", (unsigned long)n, cfg->name, ns);
+        } else {
+            printf("%-22lu%10.1f\n", (unsigned long)n, ns);
+        }
+    }
+    return failures;
+}
+
+/**
+ * @brief   核对总线上捕获的发送内容恰为给定帧
+ */
+static bool Bench_Captured(uint32_t idx, const uint8_t *frame, uint16_t length) {
+    return s_uart[idx].tx_len == length && memcmp(s_uart[idx].tx_buf, frame, length) == 0;
+}
+
+/**
+ * @brief   完成实例的全部发送
+ * @note    与网关相关的校验只经 Modbus_ProcessAll() 驱动，依赖就绪通知而非逐实例轮询
+ */
+static void Bench_Flush(uint32_t idx) {
+    while (HostUart_TxComplete(&s_uart[idx])) {
+        Modbus_ProcessAll();
+    }
+}
+
+/**
+ * @brief   网关往返: 请求经实例0转发到实例1的总线，下游应答经实例0发回
+ * @retval  true    转发的请求与发回的应答均与原帧逐字节一致
+ */
+static bool Bench_BridgeRoundTrip(const Bench_Request_t *req, const Bench_Request_t *reply) {
+    HostUart_TxClear(&s_uart[0]);
+    HostUart_TxClear(&s_uart[1]);
+    HostUart_Receive(&s_uart[0], req->frame, req->length);
+    Modbus_ProcessAll();
+    bool ok = Bench_Captured(1, req->frame, req->length);
+    Bench_Flush(1);
+
+    HostUart_Receive(&s_uart[1], reply->frame, reply->length);
+    Modbus_ProcessAll();
+    Bench_Flush(0);
+    return ok && Bench_Captured(0, reply->frame, reply->length);
+}
+
+/**
+ * @brief   网关转发: 实例0把 BENCH_ROUTE_ADDR 路由到实例1
+ * @details 校验一次完整的时序后计时往返:
+ *          1. 请求原样转发，下游等待应答期间新的转发请求在实例0保持待处理
+ *          2. 下游应答原样发回后待处理的请求随即转发
+ *          3. 下游超时未应答时实例0以目标地址返回 MB_EX_GATEWAY_TARGET，转发与超时计数一致，下游恢复空闲
+ *          全程只调用 Modbus_ProcessAll()，超时须由转发时的就绪通知触发
+ * @return  校验失败的项数
+ */
+static uint32_t Bench_Bridge(uint32_t iterations, bool csv) {
+    static const uint8_t rd_hold[]   = { 0x03, 0x00, 0x00, 0x00, 0x04 };
+    static const uint8_t hold_data[] = { 0x03, 0x08, 0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0 };
+    static const uint8_t timeout[]   = { 0x83, MB_EX_GATEWAY_TARGET };
+    static const Modbus_Route_t routes[1] = { { BENCH_ROUTE_ADDR, BENCH_ROUTE_ADDR, &s_modbus[1] } };
+    const Modbus_Config_t extra = { .bridge = { routes, 1, BENCH_BRIDGE_TIMEOUT } };
+    const Bench_Config_t *cfg = &s_configs[4];  /* ring: DMA发送 */
+    Bench_Request_t req, reply, exception;
+    uint32_t failures = 0;
+
+    Bench_Frame(&req, "bridge request", BENCH_ROUTE_ADDR, rd_hold, sizeof(rd_hold));
+    Bench_Frame(&reply, "bridge reply", BENCH_ROUTE_ADDR, hold_data, sizeof(hold_data));
+    Bench_Frame(&exception, "bridge timeout", BENCH_ROUTE_ADDR, timeout, sizeof(timeout));
+
+    if (!Bench_InitInstance(0, cfg, &extra) || !Bench_InitInstance(1, cfg, NULL)) {
+        printf("init failed: bridge\n");
+        return 1;
+    }
+
+    /* 实例0/1占槽位0/1: 单任务时同组，两个任务时分属不同任务 */
+    if (!Modbus_RoutesGrouped(1) || Modbus_RoutesGrouped(2)) {
+        printf("bad reply: bridge route grouping\n");
+        failures++;
+    }
+
+    /* 1. 转发请求A; 下游等待期间请求B保持待处理 */
+    HostUart_TxClear(&s_uart[1]);
+    HostUart_Receive(&s_uart[0], req.frame, req.length);
+    Modbus_ProcessAll();
+    bool ok = Bench_Captured(1, req.frame, req.length);
+    Bench_Flush(1);
+    HostUart_TxClear(&s_uart[1]);
+    HostUart_Receive(&s_uart[0], req.frame, req.length);
+    Modbus_ProcessAll();
+    ok = ok && s_uart[1].tx_len == 0;
+
+    /* 2. 应答A原样发回，随后转发请求B */
+    HostUart_TxClear(&s_uart[0]);
+    HostUart_Receive(&s_uart[1], reply.frame, reply.length);
+    Modbus_ProcessAll();
+    Bench_Flush(0);
+    ok = ok && Bench_Captured(0, reply.frame, reply.length);
+    Modbus_ProcessAll();
+    ok = ok && Bench_Captured(1, req.frame, req.length);
+    Bench_Flush(1);
+
+    /* 3. 下游不应答，请求B超时 */
+    HostUart_TxClear(&s_uart[0]);
+    HostHal_AdvanceTick(BENCH_BRIDGE_TIMEOUT - 1U);
+    Modbus_ProcessAll();
+    ok = ok && s_uart[0].tx_len == 0 && !Modbus_IsIdle(&s_modbus[1]);
+    HostHal_AdvanceTick(1);
+    Modbus_ProcessAll();
+    Bench_Flush(0);
+    ok = ok && Bench_Captured(0, exception.frame, exception.length) && Modbus_IsIdle(&s_modbus[1]);
+    ok = ok && s_modbus[0].stats.bridge_fwd == 2 && s_modbus[0].stats.bridge_timeout == 1;
+    if (!ok) {
+        printf("bad reply: bridge forward/timeout sequence\n");
+        failures++;
+    }
+
+    if (!Bench_BridgeRoundTrip(&req, &reply)) {
+        printf("bad reply: bridge round trip\n");
+        failures++;
+    }
+    uint64_t start = Bench_NowNs();
+    for (uint32_t i = 0; i < iterations; i++) {
+        (void)Bench_BridgeRoundTrip(&req, &reply);
+    }
+    double ns = (double)(Bench_NowNs() - start) / iterations;
+
+    if (csv) {
+        printf("bridge,round trip,%s,%.1f\n", cfg->name, ns);
+    } else {
+        printf("\n%-22s%10s\n%-22s%10.1f\n", "bridge", "ns/frame", "round trip", ns);
+    }
+    return failures;
+}
+
+/* ============================================================================
+ *                              响应缓存校验
+ * ============================================================================ */
+
+#define BENCH_CACHE_REGS     8U       /**< 校验读取的寄存器数 (地址0起) */
+
+/**
+ * @brief   读取 BENCH_CACHE_REGS 个寄存器，逐字节核对响应与数据区当前值
+ * @param   name    校验项名称 (失败时输出)
+ * @param   addr    请求的从站地址 (响应地址应相同)
+ * @param   cached  true=应由缓存重发, false=应重新组帧 (由 cache_hits 判定)
+ * @return  失败时返回1
+ */
+static uint32_t Bench_CacheRead(const char *name, uint8_t addr, uint8_t func_code, bool cached) {
+    const uint16_t *regs = (func_code == 0x03) ? s_holding : s_input;
+    const uint8_t pdu[] = { func_code, 0x00, 0x00, 0x00, BENCH_CACHE_REGS };
+    uint8_t data[2 + 2 * BENCH_CACHE_REGS];
+    Bench_Request_t req, expect;
+
+    data[0] = func_code;
+    data[1] = 2 * BENCH_CACHE_REGS;
+    for (uint16_t i = 0; i < BENCH_CACHE_REGS; i++) {
+        data[2 + 2 * i] = (uint8_t)(regs[i] >> 8);
+        data[3 + 2 * i] = (uint8_t)regs[i];
+    }
+    Bench_Frame(&req, name, addr, pdu, sizeof(pdu));
+    Bench_Frame(&expect, name, addr, data, sizeof(data));
+
+    uint32_t hits = s_modbus[0].stats.cache_hits;
+    Bench_Exchange(0, &req);
+    if (!Bench_Captured(0, expect.frame, expect.length) || s_modbus[0].stats.cache_hits != hits + (cached ? 1U : 0U)) {
+        printf("bad reply: cache %s %02X\n", name, func_code);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief   经实例0写入，核对正常响应
+ * @retval  true    响应为正常响应 (地址、功能码、CRC正确)
+ */
+static bool Bench_Write(const char *name, const uint8_t *pdu, uint16_t pdu_len) {
+    Bench_Request_t req;
+
+    Bench_Frame(&req, name, BENCH_SLAVE_ADDR, pdu, pdu_len);
+    req.expect_reply = true;
+    req.expect_exception = false;
+    Bench_Exchange(0, &req);
+    return Bench_CheckReply(0, &req);
+}
+
+/**
+ * @brief   经协议栈写入，核对正常响应与写入后的寄存器值
+ * @return  失败时返回1
+ */
+static uint32_t Bench_CacheWrite(const char *name, const uint8_t *pdu, uint16_t pdu_len, uint16_t reg, uint16_t value) {
+    if (!Bench_Write(name, pdu, pdu_len) || s_holding[reg] != value) {
+        printf("bad reply: cache %s\n", name);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief   响应缓存失效: 每种失效操作前确认响应已缓存，操作后的读取应重新组帧并反映新值
+ * @note    失效操作使全部缓存项失效，其他功能码的缓存项在下一次确认前先重新填充
+ * @details 失效操作依次为 0x06/0x10/0x17 写入、Modbus_SeqlockWriteEnd()、
+ *          Modbus_DataChanged() 与 Modbus_SetSlaveAddr() (缓存帧带有原地址)
+ * @return  校验失败的项数
+ */
+static uint32_t Bench_RespCache(void) {
+    static const uint8_t wr_reg[]  = { 0x06, 0x00, 0x02, 0xBE, 0xEF };
+    static const uint8_t wr_regs[] = { 0x10, 0x00, 0x04, 0x00, 0x02, 0x04, 0xCA, 0xFE, 0xF0, 0x0D };
+    static const uint8_t rd_wr[]   = { 0x17, 0x00, 0x00, 0x00, 0x01, 0x00, 0x06, 0x00, 0x01, 0x02, 0x5A, 0xA5 };
+    Modbus_Seqlock_t lock = { 0 };
+    uint32_t failures = 0;
+
+    if (!Bench_InitInstance(0, &s_configs[9], NULL)) {  /* cache */
+        printf("init failed: cache\n");
+        return 1;
+    }
+    failures += Bench_CacheRead("first read", BENCH_SLAVE_ADDR, 0x03, false);
+
+    failures += Bench_CacheRead("before 06", BENCH_SLAVE_ADDR, 0x03, true);
+    failures += Bench_CacheWrite("06 write", wr_reg, sizeof(wr_reg), 2, 0xBEEF);
+    failures += Bench_CacheRead("after 06", BENCH_SLAVE_ADDR, 0x03, false);
+
+    failures += Bench_CacheRead("before 10", BENCH_SLAVE_ADDR, 0x03, true);
+    failures += Bench_CacheWrite("10 write", wr_regs, sizeof(wr_regs), 5, 0xF00D);
+    failures += Bench_CacheRead("after 10", BENCH_SLAVE_ADDR, 0x03, false);
+
+    failures += Bench_CacheRead("before 17", BENCH_SLAVE_ADDR, 0x03, true);
+    failures += Bench_CacheWrite("17 write", rd_wr, sizeof(rd_wr), 6, 0x5AA5);
+    failures += Bench_CacheRead("after 17", BENCH_SLAVE_ADDR, 0x03, false);
+
+    /* 应用在顺序锁写入区间内修改保持寄存器 */
+    failures += Bench_CacheRead("before seqlock", BENCH_SLAVE_ADDR, 0x03, true);
+    Modbus_SeqlockWriteBegin(&lock);
+    s_holding[0] ^= 0xFFFFU;
+    Modbus_SeqlockWriteEnd(&lock);
+    failures += Bench_CacheRead("after seqlock", BENCH_SLAVE_ADDR, 0x03, false);
+
+    /* 应用直接修改输入寄存器 */
+    failures += Bench_CacheRead("refill", BENCH_SLAVE_ADDR, 0x04, false);
+    failures += Bench_CacheRead("before DataChanged", BENCH_SLAVE_ADDR, 0x04, true);
+    s_input[1] ^= 0xFFFFU;
+    Modbus_DataChanged();
+    failures += Bench_CacheRead("after DataChanged", BENCH_SLAVE_ADDR, 0x04, false);
+
+    /* 新地址的响应重新组帧，原地址不再应答 */
+    failures += Bench_CacheRead("refill", BENCH_SLAVE_ADDR, 0x03, false);
+    failures += Bench_CacheRead("before SetSlaveAddr", BENCH_SLAVE_ADDR, 0x03, true);
+    Modbus_SetSlaveAddr(&s_modbus[0], BENCH_SLAVE_ADDR + 1);
+    failures += Bench_CacheRead("after SetSlaveAddr", BENCH_SLAVE_ADDR + 1, 0x03, false);
+    failures += Bench_CacheRead("after SetSlaveAddr", BENCH_SLAVE_ADDR + 1, 0x04, false);
+    Bench_Exchange(0, &s_requests[2]);  /* 03 read 16 regs (原地址) */
+    if (s_uart[0].tx_len != 0) {
+        printf("bad reply: cache old address answered\n");
+        failures++;
+    }
+    return failures;
+}
+
+/* ============================================================================
+ *                              脏位图与写入提交校验
+ * ============================================================================ */
+
+#define BENCH_COMMIT_WINDOW  100U     /**< 提交合并窗口 (ms) */
+#define BENCH_COMMIT_BATCHES 4U       /**< 记录的提交批数 */
+
+static uint32_t        s_coil_dirty[(BENCH_POINTS + 31) / 32];
+static uint32_t        s_holding_dirty[(BENCH_POINTS + 31) / 32];
+static Modbus_Change_t s_commits[BENCH_COMMIT_BATCHES][MODBUS_COMMIT_MAX_RANGES];
+static uint8_t         s_commit_counts[BENCH_COMMIT_BATCHES];
+static uint32_t        s_commit_calls;
+
+static void Bench_Commit(ModbusHandle_t *hmodbus, const Modbus_Change_t *changes, uint8_t count) {
+    (void)hmodbus;
+    if (s_commit_calls < BENCH_COMMIT_BATCHES) {
+        memcpy(s_commits[s_commit_calls], changes, count * sizeof(Modbus_Change_t));
+        s_commit_counts[s_commit_calls] = count;
+    }
+    s_commit_calls++;
+}
+
+/**
+ * @brief   0x06 写单个寄存器
+ */
+static bool Bench_WriteReg(uint16_t addr) {
+    const uint8_t pdu[] = { 0x06, (uint8_t)(addr >> 8), (uint8_t)addr, 0x55, 0xAA };
+    return Bench_Write("dirty 06", pdu, sizeof(pdu));
+}
+
+/**
+ * @brief   0x10 写多个寄存器
+ */
+static bool Bench_WriteRegs(uint16_t start, uint16_t quantity) {
+    uint8_t pdu[6 + 2 * 123];
+
+    pdu[0] = 0x10;
+    pdu[1] = (uint8_t)(start >> 8);
+    pdu[2] = (uint8_t)start;
+    pdu[3] = (uint8_t)(quantity >> 8);
+    pdu[4] = (uint8_t)quantity;
+    pdu[5] = (uint8_t)(2 * quantity);
+    for (uint16_t i = 0; i < 2 * quantity; i++) {
+        pdu[6 + i] = (uint8_t)i;
+    }
+    return Bench_Write("dirty 10", pdu, (uint16_t)(6 + 2 * quantity));
+}
+
+/**
+ * @brief   0x0F 写多个线圈 (全部置1)
+ */
+static bool Bench_WriteCoils(uint16_t start, uint16_t quantity) {
+    uint8_t pdu[6 + 32];
+    uint8_t bytes = (uint8_t)((quantity + 7) / 8);
+
+    pdu[0] = 0x0F;
+    pdu[1] = (uint8_t)(start >> 8);
+    pdu[2] = (uint8_t)start;
+    pdu[3] = (uint8_t)(quantity >> 8);
+    pdu[4] = (uint8_t)quantity;
+    pdu[5] = bytes;
+    memset(&pdu[6], 0xFF, bytes);
+    return Bench_Write("dirty 0F", pdu, (uint16_t)(6 + bytes));
+}
+
+/**
+ * @brief   依次取出数据区的全部变更，核对为给定的 (起始地址, 数量) 序列
+ * @param   runs    期望的范围序列 (按地址升序)，随后应无更多变更
+ * @return  失败时返回1
+ */
+static uint32_t Bench_DirtyExpect(const char *name, Modbus_Area_t area, const Modbus_Change_t *runs, uint32_t count) {
+    uint16_t start, quantity;
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (!Modbus_DirtyFetch(&s_modbus[0], area, &start, &quantity) ||
+            start != runs[i].start || quantity != runs[i].quantity) {
+            printf("bad dirty run: %s #%lu\n", name, (unsigned long)i);
+            return 1;
+        }
+    }
+    if (Modbus_DirtyFetch(&s_modbus[0], area, &start, &quantity)) {
+        printf("bad dirty run: %s extra %u+%u\n", name, start, quantity);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief   核对第 batch 次提交收到的范围 (包括范围次序)
+ * @return  失败时返回1
+ */
+static uint32_t Bench_CommitExpect(const char *name, uint32_t batch, const Modbus_Change_t *ranges, uint8_t count) {
+    if (batch >= s_commit_calls || s_commit_counts[batch] != count) {
+        printf("bad commit: %s\n", name);
+        return 1;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        const Modbus_Change_t *got = &s_commits[batch][i];
+        if (got->area != ranges[i].area || got->start != ranges[i].start || got->quantity != ranges[i].quantity) {
+            printf("bad commit: %s range %u\n", name, i);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief   脏位图与写入提交
+ * @details 1. 跨32位字边界的写入 (含整字置位与首末地址) 经 Modbus_DirtyFetch() 取出为精确的连续范围
+ *          2. 合并窗口内相邻、重叠的同区写入合并为一个范围，不同数据区不合并
+ *          3. 第 MODBUS_COMMIT_MAX_RANGES+1 个不相邻范围到达时先提交已有范围，其余在窗口到期后提交
+ * @return  校验失败的项数
+ */
+static uint32_t Bench_Dirty(void) {
+    static const Modbus_Change_t holding_runs[] = {
+        { MODBUS_AREA_HOLDING, 0, 1 },   { MODBUS_AREA_HOLDING, 30, 6 }, { MODBUS_AREA_HOLDING, 63, 3 },
+        { MODBUS_AREA_HOLDING, 90, 70 }, { MODBUS_AREA_HOLDING, 255, 1 },
+    };
+    static const Modbus_Change_t coil_runs[] = {
+        { MODBUS_AREA_COILS, 28, 13 }, { MODBUS_AREA_COILS, 200, 1 },
+    };
+    static const Modbus_Change_t merged[] = {
+        { MODBUS_AREA_HOLDING, 10, 4 }, { MODBUS_AREA_COILS, 10, 1 }, { MODBUS_AREA_HOLDING, 100, 1 },
+    };
+    static const Modbus_Change_t later_runs[] = {
+        { MODBUS_AREA_HOLDING, 0, 1 },  { MODBUS_AREA_HOLDING, 2, 1 },  { MODBUS_AREA_HOLDING, 4, 1 },
+        { MODBUS_AREA_HOLDING, 6, 1 },  { MODBUS_AREA_HOLDING, 8, 1 },  { MODBUS_AREA_HOLDING, 10, 5 },
+        { MODBUS_AREA_HOLDING, 16, 1 }, { MODBUS_AREA_HOLDING, 100, 1 },
+    };
+    const Modbus_Config_t extra = {
+        .data_map = { .coil_dirty = s_coil_dirty, .holding_dirty = s_holding_dirty },
+        .commit_cb = Bench_Commit,
+        .commit_window_ms = BENCH_COMMIT_WINDOW,
+    };
+    Modbus_Change_t full[MODBUS_COMMIT_MAX_RANGES + 1];
+    uint32_t failures = 0;
+    bool ok = true;
+
+    memset(s_coil_dirty, 0, sizeof(s_coil_dirty));
+    memset(s_holding_dirty, 0, sizeof(s_holding_dirty));
+    if (!Bench_InitInstance(0, &s_configs[1], &extra)) {  /* table */
+        printf("init failed: dirty\n");
+        return 1;
+    }
+
+    /* 1. 63~65 由两次写入拼接并跨字边界，90~159 覆盖一个整字 */
+    const uint8_t coil_on[] = { 0x05, 0x00, 200, 0xFF, 0x00 };
+    ok = Bench_WriteRegs(30, 6) && Bench_WriteReg(255) && Bench_WriteRegs(64, 2) && Bench_WriteReg(63) &&
+         Bench_WriteRegs(90, 70) && Bench_WriteReg(0) && Bench_WriteCoils(28, 13) &&
+         Bench_Write("dirty 05", coil_on, sizeof(coil_on));
+    failures += ok ? 0U : 1U;
+    failures += Bench_DirtyExpect("holding", MODBUS_AREA_HOLDING, holding_runs, 5);
+    failures += Bench_DirtyExpect("coils", MODBUS_AREA_COILS, coil_runs, 2);
+
+    /* 清除第1步留下的待提交范围 */
+    HostHal_AdvanceTick(BENCH_COMMIT_WINDOW);
+    Modbus_Process(&s_modbus[0]);
+    s_commit_calls = 0;
+
+    /* 2. 相邻与重叠合并: 10, 11~13, 12 -> 10~13; 线圈10与保持寄存器不合并 */
+    const uint8_t coil_10[] = { 0x05, 0x00, 10, 0xFF, 0x00 };
+    ok = Bench_WriteReg(10) && Bench_WriteRegs(11, 3) && Bench_WriteReg(12) &&
+         Bench_Write("dirty 05", coil_10, sizeof(coil_10)) && Bench_WriteReg(100);
+    ok = ok && s_commit_calls == 0;
+    HostHal_AdvanceTick(BENCH_COMMIT_WINDOW - 1U);
+    Modbus_Process(&s_modbus[0]);
+    ok = ok && s_commit_calls == 0;
+    HostHal_AdvanceTick(1);
+    Modbus_Process(&s_modbus[0]);
+    if (!ok) {
+        printf("bad commit: merge window\n");
+        failures++;
+    }
+    failures += Bench_CommitExpect("merge", 0, merged, 3);
+
+    /* 3. 9个不相邻的寄存器: 第9个到达时先提交前8个 */
+    s_commit_calls = 0;
+    ok = true;
+    for (uint16_t i = 0; i <= MODBUS_COMMIT_MAX_RANGES; i++) {
+        full[i] = (Modbus_Change_t){ MODBUS_AREA_HOLDING, (uint16_t)(2 * i), 1 };
+        ok = ok && Bench_WriteReg(full[i].start);
+        ok = ok && s_commit_calls == ((i < MODBUS_COMMIT_MAX_RANGES) ? 0U : 1U);
+    }
+    HostHal_AdvanceTick(BENCH_COMMIT_WINDOW);
+    Modbus_Process(&s_modbus[0]);
+    if (!ok || s_commit_calls != 2) {
+        printf("bad commit: early flush\n");
+        failures++;
+    }
+    failures += Bench_CommitExpect("early flush", 0, full, MODBUS_COMMIT_MAX_RANGES);
+    failures += Bench_CommitExpect("flush rest", 1, &full[MODBUS_COMMIT_MAX_RANGES], 1);
+
+    /* 第2、3步的写入同样置位脏位图，与提交互不影响 */
+    failures += Bench_DirtyExpect("after commit", MODBUS_AREA_HOLDING, later_runs, 8);
+    failures += Bench_DirtyExpect("after commit", MODBUS_AREA_COILS, merged + 1, 1);
+    return failures;
+}
+
+int main(int argc, char **argv) {
+    uint32_t iterations = 20000;
+    bool csv = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            iterations = 200;
+        } else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--csv") == 0) {
+            csv = true;
+        } else {
+            printf("usage: %s [--quick] [--iterations N] [--csv]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (iterations == 0) {
+        iterations = 1;
+    }
+
+    for (uint16_t i = 0; i < BENCH_POINTS; i++) {
+        s_holding[i] = (uint16_t)(0x1000U + i);
+        s_input[i] = (uint16_t)(0x2000U + i);
+    }
+    memset(s_discrete, 0xA5, sizeof(s_discrete));
+    Bench_BuildRequests();
+
+    uint32_t failures = Bench_FunctionCodes(iterations, csv);
+    failures += Bench_Instances(iterations, csv);
+    failures += Bench_Bridge(iterations, csv);
+    failures += Bench_RespCache();
+    failures += Bench_Dirty();
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,611 @@
+/**
+ * @file    modbus_fuzz.c
+ * @brief   Modbus从站协议栈模糊测试目标 (libFuzzer)
+ * @version 2.0.0
+ * @date    2025
+ *
+ * @details 输入格式:
+ *          | 字节0: 配置 | 字节1: 配置 | 帧块... |
+ *          字节0: bit0 环形DMA接收, bit1 增量CRC, bit2~3 CRC后端, bit4 DMA发送,
+ *                 bit5 中断快速路径, bit6 流水线发送, bit7 他站帧静默
+ *          字节1: bit0~1 发送槽数-1, bit2 使用段表, bit3 脏位图与0x64延后执行, bit4 拒绝所有写入,
+ *                 bit5 缩小缓冲区至最小尺寸, bit6 LL传输层 (忽略环形DMA与他站帧静默),
+ *                 bit7 经TCP前端送入 (字节0 bit0 选择RTU over TCP, 否则为MBAP);
+ *                 bit6与bit7同时置位时为网关模式: 地址 FUZZ_ROUTE_FIRST~FUZZ_ROUTE_LAST 转发到第二个串口实例
+ *                 (两个实例均为HAL传输层、DMA发送且不流水线，每帧单独检查)
+ *          字节0与字节1的异或作为快速路径 max_regs (0~255, 含超出协议上限的值)
+ *          帧块: [长度][标志][数据...]
+ *                标志 bit0 在数据后追加正确CRC (否则几乎所有帧都止步于CRC校验),
+ *                     bit1 送入后不等待发送完成, bit2~7 送入后推进的节拍 (ms, 奇数时取出写入事件)
+ *                网关模式: 标志 bit1 改为送入下游总线 (模拟下游从站的应答或发往下游实例本身的请求)
+ *                TCP前端: 标志 bit0 在数据前加正确的MBAP头 (MBAP) 或追加正确CRC (RTU over TCP),
+ *                     bit1 送入后取出写入事件, bit2 选择两个连接之一, bit3~7 分两段送入时第一段的长度
+ *
+ *          缓冲区与数据区按配置的精确大小从堆分配，越界访问由 AddressSanitizer 报告;
+ *          每个排空的响应都检查长度、地址与CRC (TCP前端检查MBAP头或CRC，网关模式检查两条总线上的每一帧)，
+ *          违反时 abort()
+ *
+ * @note    定义 MODBUS_FUZZ_STANDALONE 时附带独立驱动 (无需libFuzzer):
+ *          modbus_fuzz [文件...]          逐个执行输入文件
+ *          modbus_fuzz --iterations N     执行N个随机生成的输入
+ */
+
+#include "modbus_slave.h"
+#include "modbus_port_ll.h"
+#include "modbus_tcp.h"
+#include "host_hal.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/* ============================================================================
+ *                              测试配置
+ * ============================================================================ */
+
+#define FUZZ_SLAVE_ADDR      1U
+#define FUZZ_POINTS          256U     /**< 每个数据区的点数 (超过128个寄存器，覆盖字节数超出8位的响应) */
+#define FUZZ_SEG_BASE        1000U    /**< 段表模式: 第二段起始地址 */
+#define FUZZ_EVENTS          4U       /**< 写入事件队列长度 (取出不及时即返回从站忙) */
+#define FUZZ_ROUTE_FIRST     2U       /**< 网关模式: 转发到下游实例的起始从站地址 */
+#define FUZZ_ROUTE_LAST      9U       /**< 网关模式: 转发到下游实例的结束从站地址 */
+#define FUZZ_DOWN_ADDR       10U      /**< 网关模式: 下游实例本身的从站地址 */
+#define FUZZ_BRIDGE_TIMEOUT  20U      /**< 网关模式: 下游应答超时 (ms, 帧块节拍可越过) */
+
+/** 静态实例: 注册表按 USART 实例登记，每个输入复用同一槽位 */
+static HostUart_t     s_uart;
+static ModbusLL_Port_t s_ll_port;
+static ModbusHandle_t s_modbus;
+static HostUart_t     s_down_uart;    /**< 网关模式: 下游总线 */
+static ModbusHandle_t s_down;         /**< 网关模式: 下游实例 */
+static ModbusTCP_Server_t s_tcp;
+static uint8_t        s_tcp_conn[2];  /**< TCP连接句柄 (仅取地址) */
+static bool           s_veto_writes;
+
+/* ============================================================================
+ *                              HAL 与协议栈回调
+ * ============================================================================ */
+
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) {
+    Modbus_DispatchRxEvent(huart, Size);
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
+    Modbus_DispatchTxCplt(huart);
+}
+
+static void Fuzz_UartIrq(HostUart_t *uart) {
+    Modbus_UART_IRQHandler(Modbus_FindByUart(&uart->huart));
+}
+
+static void Fuzz_UartIrqLL(HostUart_t *uart) {
+    (void)uart;
+    ModbusLL_IRQHandler(&s_modbus);
+}
+
+static bool Fuzz_WriteCallback(ModbusHandle_t *hmodbus, uint8_t func_code, uint16_t start_addr, uint16_t quantity) {
+    (void)hmodbus;
+    (void)func_code;
+    (void)start_addr;
+    (void)quantity;
+    return !s_veto_writes;
+}
+
+static bool Fuzz_CustomConfig(ModbusHandle_t *hmodbus, uint16_t param_addr, uint16_t param_value) {
+    (void)hmodbus;
+    (void)param_value;
+    return param_addr < 0x10U;
+}
+
+static void Fuzz_Commit(ModbusHandle_t *hmodbus, const Modbus_Change_t *changes, uint8_t count) {
+    (void)hmodbus;
+    if (count == 0 || count > MODBUS_COMMIT_MAX_RANGES) {
+        abort();
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        if (changes[i].quantity == 0) {
+            abort();
+        }
+    }
+}
+
+static void Fuzz_Event(ModbusHandle_t *hmodbus, const Modbus_Event_t *event) {
+    (void)hmodbus;
+    if (event->func_code == 0x64 || event->value == 0 || (uint32_t)event->addr + event->value > 0x10000UL) {
+        abort();
+    }
+}
+
+static uint16_t Fuzz_CRC16(const uint8_t *data, uint16_t len);
+
+/**
+ * @brief   TCP前端发送: 检查MBAP头 (协议号0、长度与帧长一致、单元号为本机/0/0xFF) 或RTU帧的地址与CRC
+ */
+static bool Fuzz_TcpSend(void *conn_ctx, const uint8_t *data, uint16_t len) {
+    if (conn_ctx != &s_tcp_conn[0] && conn_ctx != &s_tcp_conn[1]) {
+        abort();
+    }
+    if (s_tcp.config.framing == MODBUS_TCP_MBAP) {
+        if (len < 9 || len > MODBUS_TCP_ADU_MAX || data[2] != 0 || data[3] != 0 ||
+            ((data[4] << 8) | data[5]) != len - 6 ||
+            (data[6] != FUZZ_SLAVE_ADDR && data[6] != 0 && data[6] != 0xFF)) {
+            abort();
+        }
+    } else if (len < 5 || len > MODBUS_RTU_ADU_MAX || data[0] != FUZZ_SLAVE_ADDR || Fuzz_CRC16(data, len) != 0) {
+        abort();
+    }
+    return true;
+}
+
+static void Fuzz_TcpClose(void *conn_ctx) {
+    (void)conn_ctx;
+    abort();  /* 只使用两个连接，不应替换 */
+}
+
+static uint16_t Fuzz_CRC16(const uint8_t *data, uint16_t len) {
+    uint16_t crc = 0xFFFF;
+    for (uint16_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (uint8_t j = 0; j < 8; j++) {
+            crc = (crc & 1U) ? (uint16_t)((crc >> 1) ^ 0xA001U) : (uint16_t)(crc >> 1);
+        }
+    }
+    return crc;
+}
+
+/* ============================================================================
+ *                              单个输入
+ * ============================================================================ */
+
+/**
+ * @brief   排空发送队列并检查捕获的响应
+ * @param   check   检查捕获内容 (上一帧块未等待发送完成时，捕获中可能混有其残余)
+ */
+static void Fuzz_Drain(bool check) {
+    for (uint32_t n = 0; n < 4U * MODBUS_TX_QUEUE_MAX; n++) {
+        Modbus_Process(&s_modbus);
+        if (!HostUart_TxComplete(&s_uart)) {
+            if (s_modbus.tx_count == 0) {
+                break;
+            }
+            HostHal_AdvanceTick(10);
+        }
+    }
+
+    /* 排空后恰有一帧响应 (广播/他站/不应答时为空) */
+    if (check && s_uart.tx_len != 0) {
+        if (s_uart.tx_len < 5 || s_uart.tx_len > MODBUS_RTU_ADU_MAX) {
+            abort();
+        }
+        if (s_uart.tx_buf[0] != s_modbus.slave_addr || Fuzz_CRC16(s_uart.tx_buf, s_uart.tx_len) != 0) {
+            abort();
+        }
+    }
+}
+
+/**
+ * @brief   网关模式: 检查并清空一条总线的捕获
+ * @details 两个实例均为DMA发送，每一步之间每条总线至多启动一帧，捕获中恰为完整的一帧:
+ *          长度4~256、CRC正确，地址为该实例的从站地址或路由地址 (转发的请求、下游应答或网关异常)
+ */
+static void Fuzz_BridgeCheck(HostUart_t *uart, const ModbusHandle_t *hmodbus) {
+    if (uart->tx_len != 0) {
+        uint8_t addr = uart->tx_buf[0];
+        if (uart->tx_len < 4 || uart->tx_len > MODBUS_RTU_ADU_MAX || Fuzz_CRC16(uart->tx_buf, uart->tx_len) != 0) {
+            abort();
+        }
+        if (addr != hmodbus->slave_addr && (addr < FUZZ_ROUTE_FIRST || addr > FUZZ_ROUTE_LAST)) {
+            abort();
+        }
+    }
+    HostUart_TxClear(uart);
+}
+
+/**
+ * @brief   网关模式: 经 Modbus_ProcessAll() 推进两个实例直至两条总线的发送队列排空，每一步后检查捕获
+ * @param   settle  同时等待下游的转发请求应答或超时 (只靠就绪通知驱动，超时后下游须恢复空闲)
+ */
+static void Fuzz_BridgeDrain(bool settle) {
+    for (uint32_t n = 0; n < 8U * MODBUS_TX_QUEUE_MAX; n++) {
+        Fuzz_BridgeCheck(&s_uart, &s_modbus);
+        Fuzz_BridgeCheck(&s_down_uart, &s_down);
+        Modbus_ProcessAll();
+        Fuzz_BridgeCheck(&s_uart, &s_modbus);
+        Fuzz_BridgeCheck(&s_down_uart, &s_down);
+
+        bool up = HostUart_TxComplete(&s_uart);
+        Fuzz_BridgeCheck(&s_uart, &s_modbus);
+        bool down = HostUart_TxComplete(&s_down_uart);
+        Fuzz_BridgeCheck(&s_down_uart, &s_down);
+        if (!up && !down) {
+            if (s_modbus.tx_count == 0 && s_down.tx_count == 0 && (!settle || s_down.bridge_origin == NULL)) {
+                break;
+            }
+            HostHal_AdvanceTick(10);
+        }
+    }
+    if (settle && s_down.bridge_origin != NULL) {
+        abort();
+    }
+}
+
+/**
+ * @brief   经TCP前端送入一个帧块: 按标志分两段送入，帧格式错误时重建连接
+ * @note    两段各自复制到精确大小的堆缓冲区，直接在收到的数据中解析时的越界读取同样由ASan报告
+ */
+static void Fuzz_TcpFeed(const uint8_t *frame, uint16_t len, uint8_t flags) {
+    void *ctx = &s_tcp_conn[(flags >> 2) & 0x01U];
+    uint16_t split = (uint16_t)(flags >> 3);
+    if (split > len) {
+        split = len;
+    }
+
+    uint8_t *head = malloc(split > 0 ? split : 1);
+    uint8_t *tail = malloc(len > split ? len - split : 1);
+    if (head != NULL && tail != NULL) {
+        memcpy(head, frame, split);
+        memcpy(tail, &frame[split], len - split);
+        if (!ModbusTCP_Receive(&s_tcp, ctx, head, split) ||
+            !ModbusTCP_Receive(&s_tcp, ctx, tail, (uint16_t)(len - split))) {
+            ModbusTCP_Close(&s_tcp, ctx);
+            if (!ModbusTCP_Open(&s_tcp, ctx)) {
+                abort();
+            }
+        }
+    }
+    free(head);
+    free(tail);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    static const Modbus_CrcMode_t crc_modes[4] = {
+        MODBUS_CRC_SHIFT, MODBUS_CRC_TABLE, MODBUS_CRC_NIBBLE, MODBUS_CRC_DEFAULT
+    };
+
+    if (size < 2) {
+        return 0;
+    }
+    uint8_t cfg0 = data[0];
+    uint8_t cfg1 = data[1];
+    data += 2;
+    size -= 2;
+
+    bool bridge = (cfg1 & 0xC0U) == 0xC0U;
+    bool tcp = !bridge && (cfg1 & 0x80U) != 0;
+    bool ll = !tcp && !bridge && (cfg1 & 0x40U) != 0;
+    bool ring = !tcp && !ll && (cfg0 & 0x01U) != 0;
+    bool small = (cfg1 & 0x20U) != 0;
+    uint8_t slots = (uint8_t)((cfg1 & 0x03U) + 1U);
+    uint16_t rx_size = small ? 8U : (ring ? 512U : MODBUS_RTU_ADU_MAX);
+    uint16_t tx_size = small ? 8U : MODBUS_RTU_ADU_MAX;
+
+    uint8_t  *rx_a = malloc(rx_size);
+    uint8_t  *rx_b = malloc(rx_size);
+    uint8_t  *tx = malloc((size_t)tx_size * slots);
+    uint8_t  *bits = calloc(4, FUZZ_POINTS / 8);
+    uint16_t *regs = calloc(4, FUZZ_POINTS * sizeof(uint16_t));
+    uint32_t *dirty = calloc(4, (FUZZ_POINTS + 31) / 32 * sizeof(uint32_t));
+    Modbus_Event_t *events = malloc(FUZZ_EVENTS * sizeof(Modbus_Event_t));
+    Modbus_Seqlock_t seqlock = { 0 };
+    Modbus_Segment_t coil_segs[2], holding_segs[2];
+    static const Modbus_Route_t routes[1] = { { FUZZ_ROUTE_FIRST, FUZZ_ROUTE_LAST, &s_down } };
+    uint8_t  *down_rx_a = bridge ? malloc(rx_size) : NULL;
+    uint8_t  *down_rx_b = bridge ? malloc(rx_size) : NULL;
+    uint8_t  *down_tx = bridge ? malloc((size_t)tx_size * slots) : NULL;
+
+    if (ll) {
+        HostUart_InitLL(&s_uart);
+        s_uart.irq_handler = Fuzz_UartIrqLL;
+        ModbusLL_Init(&s_ll_port, &s_uart.regs);
+    } else {
+        HostUart_Init(&s_uart, ring);
+        s_uart.irq_handler = Fuzz_UartIrq;
+    }
+    s_veto_writes = (cfg1 & 0x10U) != 0;
+    memset(&s_modbus, 0, sizeof(s_modbus));
+
+    Modbus_Config_t config = {
+        .huart = ll ? NULL : &s_uart.huart,
+        .transport = ll ? &ModbusLL_Transport : NULL,
+        .transport_ctx = &s_ll_port,
+        .slave_addr = FUZZ_SLAVE_ADDR,
+        .baud_rate = 19200,
+        .buffer = { rx_a, rx_b, tx, rx_size, tx_size, slots },
+        .data_map = {
+            .coils = bits,                            .coil_count = FUZZ_POINTS,
+            .discrete_inputs = bits + FUZZ_POINTS / 8, .discrete_count = FUZZ_POINTS,
+            .holding_regs = regs,                     .holding_reg_count = FUZZ_POINTS,
+            .input_regs = regs + FUZZ_POINTS,         .input_reg_count = FUZZ_POINTS,
+        },
+        .fast_path = { .enabled = (cfg0 & 0x20U) != 0, .max_regs = (uint8_t)(cfg0 ^ cfg1), .flat_areas = 0x0F },
+        .rx_mode = ring ? MODBUS_RX_DMA_RING : MODBUS_RX_IT_PINGPONG,
+        .mute_foreign = !ll && (cfg0 & 0x80U) != 0,
+        .use_dma_tx = bridge || (cfg0 & 0x10U) != 0,
+        .pipelined_tx = !bridge && (cfg0 & 0x40U) != 0,
+        .incremental_crc = (cfg0 & 0x02U) != 0,
+        .crc_mode = crc_modes[(cfg0 >> 2) & 0x03U],
+        .custom_config_cb = Fuzz_CustomConfig,
+        .write_cb = Fuzz_WriteCallback,
+        .commit_cb = Fuzz_Commit,
+        .event_queue = {
+            .entries = events, .size = FUZZ_EVENTS, .event_cb = Fuzz_Event,
+            .defer_config = (cfg1 & 0x08U) != 0, .config_check_cb = Fuzz_CustomConfig,
+        },
+    };
+
+    /* 段表: 两段中第二段只读并带顺序锁，段间留有空洞 */
+    if (cfg1 & 0x04U) {
+        coil_segs[0] = (Modbus_Segment_t){ .base = 0, .count = FUZZ_POINTS / 2, .data = bits + FUZZ_POINTS / 4,
+                                           .dirty = (cfg1 & 0x08U) ? dirty + 2 : NULL };
+        coil_segs[1] = (Modbus_Segment_t){ .base = FUZZ_SEG_BASE, .count = FUZZ_POINTS / 2,
+                                           .data = bits + FUZZ_POINTS * 3 / 8, .flags = MODBUS_SEG_READONLY };
+        holding_segs[0] = (Modbus_Segment_t){ .base = 0, .count = FUZZ_POINTS, .data = regs + FUZZ_POINTS * 2,
+                                              .dirty = (cfg1 & 0x08U) ? dirty + 4 : NULL,
+                                              .flags = MODBUS_SEG_ISR_READ };
+        holding_segs[1] = (Modbus_Segment_t){ .base = FUZZ_SEG_BASE, .count = FUZZ_POINTS, .data = regs + FUZZ_POINTS * 3,
+                                              .flags = MODBUS_SEG_READONLY, .seqlock = &seqlock };
+        config.data_map.coil_segs = coil_segs;
+        config.data_map.coil_seg_count = 2;
+        config.data_map.holding_segs = holding_segs;
+        config.data_map.holding_seg_count = 2;
+    } else if (cfg1 & 0x08U) {
+        config.data_map.coil_dirty = dirty;
+        config.data_map.holding_dirty = dirty + 2;
+    }
+
+    if (bridge) {
+        config.bridge = (Modbus_BridgeConfig_t){ routes, 1, FUZZ_BRIDGE_TIMEOUT };
+    }
+
+    if (tcp) {
+        ModbusTCP_Config_t tcp_config = {
+            .framing = (cfg0 & 0x01U) ? MODBUS_TCP_RTU : MODBUS_TCP_MBAP,
+            .send = Fuzz_TcpSend,
+            .close = Fuzz_TcpClose,
+        };
+        if (bits != NULL && regs != NULL && dirty != NULL && events != NULL && ModbusTCP_Init(&s_tcp, &config, &tcp_config) &&
+            ModbusTCP_Open(&s_tcp, &s_tcp_conn[0]) && ModbusTCP_Open(&s_tcp, &s_tcp_conn[1])) {
+            uint8_t frame[6 + MODBUS_RTU_ADU_MAX + 2];
+            uint16_t transaction = 0;
+
+            while (size >= 2) {
+                uint16_t len = data[0];
+                uint8_t flags = data[1];
+                data += 2;
+                size -= 2;
+                if (len > size) {
+                    len = (uint16_t)size;
+                }
+                uint16_t n = 0;
+                if ((flags & 0x01U) && tcp_config.framing == MODBUS_TCP_MBAP) {
+                    frame[n++] = (uint8_t)(transaction >> 8);
+                    frame[n++] = (uint8_t)transaction++;
+                    frame[n++] = 0;
+                    frame[n++] = 0;
+                    frame[n++] = (uint8_t)(len >> 8);
+                    frame[n++] = (uint8_t)len;
+                }
+                memcpy(&frame[n], data, len);
+                data += len;
+                size -= len;
+                n += len;
+                if ((flags & 0x01U) && tcp_config.framing == MODBUS_TCP_RTU) {
+                    uint16_t crc = Fuzz_CRC16(frame, n);
+                    frame[n++] = crc & 0xFF;
+                    frame[n++] = (crc >> 8) & 0xFF;
+                }
+                Fuzz_TcpFeed(frame, n, flags);
+                if (flags & 0x02U) {
+                    Modbus_EventDispatch(&s_tcp.engine);
+                }
+            }
+            ModbusTCP_Close(&s_tcp, &s_tcp_conn[0]);
+            ModbusTCP_Close(&s_tcp, &s_tcp_conn[1]);
+        }
+    } else if (bridge) {
+        /* 下游实例与网关共用数据区，不转发、不排队写入事件 */
+        Modbus_Config_t down_config = config;
+        down_config.huart = &s_down_uart.huart;
+        down_config.slave_addr = FUZZ_DOWN_ADDR;
+        down_config.buffer = (Modbus_BufferConfig_t){ down_rx_a, down_rx_b, down_tx, rx_size, tx_size, slots };
+        down_config.bridge = (Modbus_BridgeConfig_t){ 0 };
+        down_config.event_queue = (Modbus_EventQueueConfig_t){ 0 };
+
+        HostUart_Init(&s_down_uart, ring);
+        s_down_uart.irq_handler = Fuzz_UartIrq;
+        memset(&s_down, 0, sizeof(s_down));
+
+        if (rx_a != NULL && rx_b != NULL && tx != NULL && down_rx_a != NULL && down_rx_b != NULL && down_tx != NULL &&
+            bits != NULL && regs != NULL && dirty != NULL && events != NULL &&
+            Modbus_Init(&s_modbus, &config) && Modbus_Init(&s_down, &down_config)) {
+            uint8_t frame[MODBUS_RTU_ADU_MAX + 2];
+
+            while (size >= 2) {
+                uint16_t len = data[0];
+                uint8_t flags = data[1];
+                data += 2;
+                size -= 2;
+                if (len > size) {
+                    len = (uint16_t)size;
+                }
+                memcpy(frame, data, len);
+                data += len;
+                size -= len;
+                if (flags & 0x01U) {
+                    uint16_t crc = Fuzz_CRC16(frame, len);
+                    frame[len++] = crc & 0xFF;
+                    frame[len++] = (crc >> 8) & 0xFF;
+                }
+
+                HostUart_TxClear(&s_uart);
+                HostUart_TxClear(&s_down_uart);
+                HostUart_Receive((flags & 0x02U) ? &s_down_uart : &s_uart, frame, len);
+                HostHal_AdvanceTick(flags >> 2);
+                Fuzz_BridgeDrain(false);
+                if (flags & 0x04U) {
+                    Modbus_EventDispatch(&s_modbus);
+                }
+            }
+        }
+
+        /* 排空两条总线并等待转发请求应答或超时: 下一个输入不使用网关时不再驱动下游实例 */
+        HostUart_TxClear(&s_uart);
+        HostUart_TxClear(&s_down_uart);
+        Fuzz_BridgeDrain(true);
+    } else if (rx_a != NULL && rx_b != NULL && tx != NULL && bits != NULL && regs != NULL && dirty != NULL &&
+               events != NULL && Modbus_Init(&s_modbus, &config)) {
+        uint8_t frame[MODBUS_RTU_ADU_MAX + 2];
+        bool clean = true;
+
+        while (size >= 2) {
+            uint16_t len = data[0];
+            uint8_t flags = data[1];
+            data += 2;
+            size -= 2;
+            if (len > size) {
+                len = (uint16_t)size;
+            }
+            memcpy(frame, data, len);
+            data += len;
+            size -= len;
+            if (flags & 0x01U) {
+                uint16_t crc = Fuzz_CRC16(frame, len);
+                frame[len++] = crc & 0xFF;
+                frame[len++] = (crc >> 8) & 0xFF;
+            }
+
+            HostUart_TxClear(&s_uart);
+            HostUart_Receive(&s_uart, frame, len);
+            HostHal_AdvanceTick(flags >> 2);
+            if (flags & 0x02U) {
+                Modbus_Process(&s_modbus);
+                clean = false;
+            } else {
+                Fuzz_Drain(clean);
+                clean = true;
+            }
+            if (flags & 0x04U) {
+                Modbus_EventDispatch(&s_modbus);
+            }
+        }
+
+        HostUart_TxClear(&s_uart);
+        Fuzz_Drain(false);
+    }
+
+    free(rx_a);
+    free(rx_b);
+    free(tx);
+    free(bits);
+    free(regs);
+    free(dirty);
+    free(events);
+    free(down_rx_a);
+    free(down_rx_b);
+    free(down_tx);
+    return 0;
+}
+
+/* ============================================================================
+ *                              独立驱动
+ * ============================================================================ */
+
+#if defined(MODBUS_FUZZ_STANDALONE)
+
+static uint32_t s_rng = 0x12345678U;
+
+static uint32_t Fuzz_Random(void) {
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+/**
+ * @brief   生成一个随机输入: 请求多为本站地址、常用功能码及正确CRC，使解析走得更深
+ * @note    网关模式下请求多为路由地址，送入下游总线的帧多沿用上一请求的地址与功能码 (模拟下游应答)
+ */
+static size_t Fuzz_Generate(uint8_t *buf, size_t cap) {
+    static const uint8_t func_codes[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x08, 0x0F, 0x10, 0x16, 0x17, 0x64 };
+    size_t n = 0;
+
+    buf[n++] = (uint8_t)Fuzz_Random();
+    buf[n++] = (uint8_t)Fuzz_Random();
+    bool bridge = Fuzz_Random() % 4 == 0;
+    if (bridge) {
+        buf[1] |= 0xC0U;
+    }
+    uint8_t last_addr = FUZZ_ROUTE_FIRST;
+    uint8_t last_func = 0x03;
+
+    uint32_t frames = 1 + Fuzz_Random() % 6;
+    for (uint32_t f = 0; f < frames && n + 2 + 260 < cap; f++) {
+        uint16_t len = (uint16_t)(Fuzz_Random() % 8 == 0 ? Fuzz_Random() % 256 : 2 + Fuzz_Random() % 16);
+        uint8_t flags = (uint8_t)(Fuzz_Random() & 0xFE);
+        if (Fuzz_Random() % 4 != 0) {
+            flags |= 0x01U;
+        }
+        buf[n++] = (uint8_t)len;
+        buf[n++] = flags;
+        for (uint16_t i = 0; i < len; i++) {
+            buf[n + i] = (uint8_t)Fuzz_Random();
+        }
+        if (len > 0 && Fuzz_Random() % 8 != 0) {
+            buf[n] = (Fuzz_Random() % 16 == 0) ? 0 : FUZZ_SLAVE_ADDR;
+        }
+        if (len > 1 && Fuzz_Random() % 8 != 0) {
+            buf[n + 1] = func_codes[Fuzz_Random() % sizeof(func_codes)];
+        }
+        if (len > 5 && Fuzz_Random() % 2 != 0) {
+            buf[n + 2] = 0;                                     /* 地址多落在数据区内 */
+            buf[n + 4] = 0;
+            buf[n + 5] = (uint8_t)(Fuzz_Random() % 4 == 0 ? Fuzz_Random() : Fuzz_Random() % 16);
+        }
+        if (len > 6 && buf[n + 1] >= 0x0F && buf[n + 1] <= 0x10) {
+            buf[n + 6] = (uint8_t)(len - 7);                    /* 字节数与帧长一致 */
+        }
+        if (bridge && len > 1) {
+            if (flags & 0x02U) {
+                if (Fuzz_Random() % 4 != 0) {                   /* 下游应答 (偶有异常应答) */
+                    buf[n] = last_addr;
+                    buf[n + 1] = (uint8_t)(last_func | ((Fuzz_Random() % 8 == 0) ? 0x80U : 0U));
+                } else {
+                    buf[n] = FUZZ_DOWN_ADDR;
+                }
+            } else if (Fuzz_Random() % 2 != 0) {
+                buf[n] = (uint8_t)(FUZZ_ROUTE_FIRST + Fuzz_Random() % (FUZZ_ROUTE_LAST - FUZZ_ROUTE_FIRST + 1));
+                last_addr = buf[n];
+                last_func = buf[n + 1];
+            }
+        }
+        n += len;
+    }
+    return n;
+}
+
+int main(int argc, char **argv) {
+    static uint8_t buf[4096];
+
+    if (argc > 2 && strcmp(argv[1], "--iterations") == 0) {
+        unsigned long iterations = strtoul(argv[2], NULL, 0);
+        for (unsigned long i = 0; i < iterations; i++) {
+            size_t n = Fuzz_Generate(buf, sizeof(buf));
+            LLVMFuzzerTestOneInput(buf, n);
+        }
+        printf("%lu random inputs ok\n", iterations);
+        return 0;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        FILE *fp = fopen(argv[i], "rb");
+        if (fp == NULL) {
+            printf("cannot open %s\n", argv[i]);
+            return 1;
+        }
+        size_t n = fread(buf, 1, sizeof(buf), fp);
+        fclose(fp);
+        LLVMFuzzerTestOneInput(buf, n);
+    }
+    printf("%d inputs ok\n", argc - 1);
+    return 0;
+}
+
+#endif /* MODBUS_FUZZ_STANDALONE */
@@ -0,0 +1,370 @@
+/**
+ * @file    host_hal.c
+ * @brief   主机构建的 HAL 函数实现 (模拟串口、DMA与系统节拍)
+ * @version 2.0.0
+ * @date    2025
+ *
+ * @details 行为按 STM32 HAL 的 UART 驱动建模:
+ *          - ReceiveToIdle_IT: 缓冲区收满时以 RXEVENT_TC 结束接收，空闲线以 RXEVENT_IDLE 结束接收
+ *          - ReceiveToIdle_DMA (循环): 半满/全满/空闲时回调，Size 为当前写入位置，接收不停止;
+ *            恰在环尾空闲时以 Size = RxXferSize 回调 (与较新版本HAL一致)
+ *          - 接收未启动时到达的字节置位 ORE 并丢弃
+ *          - 写入 RQR.MMRQ 后进入静默，直到空闲线
+ *          - 寄存器模式 (LL驱动): 字节写入RDR并置位RXNE，按使能的中断调用 irq_handler，
+ *            发送由 HostUart_TxComplete() 逐字节置位TXE并读取TDR，最后置位TC
+ */
+
+#include "host_hal.h"
+
+/* ============================================================================
+ *                              全局外设
+ * ============================================================================ */
+
+static DWT_Type       s_dwt;
+static CoreDebug_Type s_core_debug;
+static SysTick_Type   s_systick = { .LOAD = 170000U - 1U, .VAL = 170000U - 1U };
+static SCB_Type       s_scb;
+static GPIO_TypeDef   s_gpio[3];
+
+DWT_Type       *DWT       = &s_dwt;
+CoreDebug_Type *CoreDebug = &s_core_debug;
+SysTick_Type   *SysTick   = &s_systick;
+SCB_Type       *SCB       = &s_scb;
+GPIO_TypeDef   *GPIOA     = &s_gpio[0];
+GPIO_TypeDef   *GPIOB     = &s_gpio[1];
+GPIO_TypeDef   *GPIOC     = &s_gpio[2];
+uint32_t        SystemCoreClock = 170000000U;
+
+static uint32_t s_tick;
+
+/* ============================================================================
+ *                              系统节拍与GPIO
+ * ============================================================================ */
+
+uint32_t HAL_GetTick(void) {
+    return s_tick;
+}
+
+void HostHal_SetTick(uint32_t tick) {
+    s_tick = tick;
+}
+
+void HostHal_AdvanceTick(uint32_t ms) {
+    s_tick += ms;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState) {
+    if (PinState != GPIO_PIN_RESET) {
+        GPIOx->ODR |= GPIO_Pin;
+    } else {
+        GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+    }
+}
+
+/* ============================================================================
+ *                              模拟串口
+ * ============================================================================ */
+
+void HostUart_Init(HostUart_t *uart, bool rx_circular) {
+    memset(uart, 0, sizeof(*uart));
+    uart->huart.Instance = &uart->regs;
+    uart->huart.gState = HAL_UART_STATE_READY;
+    uart->huart.RxState = HAL_UART_STATE_READY;
+    uart->hdmarx.Instance = &uart->rx_channel;
+    uart->hdmarx.Init.Mode = rx_circular ? DMA_CIRCULAR : DMA_NORMAL;
+    uart->hdmarx.Parent = &uart->huart;
+    uart->huart.hdmarx = &uart->hdmarx;
+    uart->regs.CR1 = USART_CR1_UE | USART_CR1_RE | USART_CR1_TE;
+}
+
+void HostUart_InitLL(HostUart_t *uart) {
+    HostUart_Init(uart, false);
+    uart->ll_mode = true;
+    uart->regs.ISR = USART_ISR_TXE | USART_ISR_TC;
+}
+
+/**
+ * @brief   产生一次USART中断 (在HAL处理之前调用应用的中断入口)
+ */
+static void HostUart_Irq(HostUart_t *uart, uint32_t flags) {
+    uart->regs.ISR |= flags;
+    if (uart->irq_handler != NULL) {
+        uart->irq_handler(uart);
+    }
+    uart->regs.ISR &= ~(flags | USART_ISR_ORE);
+
+    /* 静默请求: 丢弃后续字节直到空闲线 */
+    if (uart->regs.RQR & USART_RQR_MMRQ) {
+        uart->rx_muted = true;
+    }
+    uart->regs.RQR = 0;
+}
+
+/**
+ * @brief   结束中断方式接收并回调
+ */
+static void HostUart_RxEventIT(HostUart_t *uart, uint32_t event, uint16_t size) {
+    uart->huart.RxState = HAL_UART_STATE_READY;
+    uart->huart.RxEventType = event;
+    HAL_UARTEx_RxEventCallback(&uart->huart, size);
+}
+
+/**
+ * @brief   循环DMA接收一个字节
+ */
+static void HostUart_RxByteDMA(HostUart_t *uart, uint8_t byte) {
+    UART_HandleTypeDef *huart = &uart->huart;
+
+    huart->pRxBuffPtr[uart->rx_write++] = byte;
+    if (uart->rx_write == huart->RxXferSize) {
+        uart->rx_write = 0;
+    }
+    uart->rx_channel.CNDTR = huart->RxXferSize - uart->rx_write;
+    if (uart->rx_channel.CNDTR == 0) {
+        uart->rx_channel.CNDTR = huart->RxXferSize;
+    }
+
+    /* 半满/全满中断 (DMA中断先于同一字节的USART中断) */
+    if (uart->rx_write == huart->RxXferSize / 2U && (uart->rx_channel.CCR & DMA_IT_HT)) {
+        huart->RxEventType = HAL_UART_RXEVENT_HT;
+        HAL_UARTEx_RxEventCallback(huart, huart->RxXferSize / 2U);
+    } else if (uart->rx_write == 0) {
+        huart->RxEventType = HAL_UART_RXEVENT_TC;
+        HAL_UARTEx_RxEventCallback(huart, huart->RxXferSize);
+    }
+    HostUart_Irq(uart, USART_ISR_RXNE);
+}
+
+/**
+ * @brief   寄存器模式: 逐字节写入RDR，最后产生空闲线
+ * @note    上一字节未被读出时置位ORE (新字节覆盖RDR，与硬件丢弃新字节略有不同)
+ */
+static void HostUart_ReceiveLL(HostUart_t *uart, const uint8_t *data, uint16_t len) {
+    USART_TypeDef *regs = &uart->regs;
+
+    for (uint16_t i = 0; i < len; i++) {
+        if (regs->ISR & USART_ISR_RXNE) {
+            uart->rx_dropped++;
+            regs->ISR |= USART_ISR_ORE;
+        }
+        regs->RDR = data[i];
+        regs->ISR |= USART_ISR_RXNE;
+        if ((regs->CR1 & USART_CR1_RXNEIE) && uart->irq_handler != NULL) {
+            uart->irq_handler(uart);
+        }
+    }
+
+    if (len > 0) {
+        regs->ISR |= USART_ISR_IDLE;
+        if ((regs->CR1 & USART_CR1_IDLEIE) && uart->irq_handler != NULL) {
+            uart->irq_handler(uart);
+        }
+    }
+}
+
+void HostUart_Receive(HostUart_t *uart, const uint8_t *data, uint16_t len) {
+    UART_HandleTypeDef *huart = &uart->huart;
+    bool circular = (uart->hdmarx.Init.Mode == DMA_CIRCULAR);
+
+    if (uart->ll_mode) {
+        HostUart_ReceiveLL(uart, data, len);
+        return;
+    }
+
+    for (uint16_t i = 0; i < len; i++) {
+        if (uart->rx_muted) {
+            continue;
+        }
+        if (huart->RxState != HAL_UART_STATE_BUSY_RX) {
+            uart->rx_dropped++;
+            HostUart_Irq(uart, USART_ISR_ORE);
+            continue;
+        }
+        if (circular) {
+            HostUart_RxByteDMA(uart, data[i]);
+            continue;
+        }
+
+        huart->pRxBuffPtr[huart->RxXferSize - huart->RxXferCount] = data[i];
+        huart->RxXferCount--;
+        HostUart_Irq(uart, USART_ISR_RXNE);
+        if (huart->RxState == HAL_UART_STATE_BUSY_RX && huart->RxXferCount == 0) {
+            HostUart_RxEventIT(uart, HAL_UART_RXEVENT_TC, huart->RxXferSize);
+        }
+    }
+
+    /* 空闲线: 结束静默; 已接收数据时回调 (循环模式下恰在环尾结束的帧以 Size = RxXferSize 报告) */
+    if (uart->rx_muted) {
+        uart->rx_muted = false;
+        return;
+    }
+    if (huart->RxState != HAL_UART_STATE_BUSY_RX) {
+        return;
+    }
+    HostUart_Irq(uart, USART_ISR_IDLE);
+    if (circular) {
+        uint32_t remaining = uart->rx_channel.CNDTR;
+        huart->RxEventType = HAL_UART_RXEVENT_IDLE;
+        if (remaining > 0 && remaining < huart->RxXferSize) {
+            HAL_UARTEx_RxEventCallback(huart, (uint16_t)(huart->RxXferSize - remaining));
+        } else if (len > 0) {
+            HAL_UARTEx_RxEventCallback(huart, huart->RxXferSize);
+        }
+    } else if (huart->RxState == HAL_UART_STATE_BUSY_RX && huart->RxXferCount < huart->RxXferSize) {
+        HostUart_RxEventIT(uart, HAL_UART_RXEVENT_IDLE, huart->RxXferSize - huart->RxXferCount);
+    }
+}
+
+/**
+ * @brief   追加发送内容到捕获缓冲区
+ */
+static void HostUart_Capture(HostUart_t *uart, const uint8_t *data, uint16_t len) {
+    uint16_t room = (uint16_t)(HOST_UART_TX_CAPTURE - uart->tx_len);
+    uint16_t n = (len < room) ? len : room;
+
+    memcpy(&uart->tx_buf[uart->tx_len], data, n);
+    uart->tx_len += n;
+    uart->tx_calls++;
+    uart->regs.ISR |= USART_ISR_TC;
+}
+
+/**
+ * @brief   寄存器模式: 由TXE中断送出全部字节，再以TC中断结束发送
+ */
+static bool HostUart_TxCompleteLL(HostUart_t *uart) {
+    USART_TypeDef *regs = &uart->regs;
+
+    if ((regs->CR1 & (USART_CR1_TXEIE | USART_CR1_TCIE)) == 0U || uart->irq_handler == NULL) {
+        return false;
+    }
+
+    uart->tx_calls++;
+
+    /* 接收中断中启动的发送 (快速通道) 已在同一次中断里写入首字节 */
+    if ((regs->ISR & USART_ISR_TXE) == 0U && uart->tx_len < HOST_UART_TX_CAPTURE) {
+        uart->tx_buf[uart->tx_len++] = (uint8_t)regs->TDR;
+    }
+    while (regs->CR1 & USART_CR1_TXEIE) {
+        regs->ISR |= USART_ISR_TXE;
+        uart->irq_handler(uart);
+        if (regs->ISR & USART_ISR_TXE) {
+            break;  /* 中断未写入TDR */
+        }
+        if (uart->tx_len < HOST_UART_TX_CAPTURE) {
+            uart->tx_buf[uart->tx_len++] = (uint8_t)regs->TDR;
+        }
+    }
+
+    regs->ISR |= USART_ISR_TXE | USART_ISR_TC;
+    if (regs->CR1 & USART_CR1_TCIE) {
+        uart->irq_handler(uart);
+    }
+    return true;
+}
+
+bool HostUart_TxComplete(HostUart_t *uart) {
+    if (uart->ll_mode) {
+        return HostUart_TxCompleteLL(uart);
+    }
+    if (!uart->tx_busy) {
+        return false;
+    }
+
+    uart->tx_busy = false;
+    uart->huart.gState = HAL_UART_STATE_READY;
+    HAL_UART_TxCpltCallback(&uart->huart);
+    return true;
+}
+
+void HostUart_TxClear(HostUart_t *uart) {
+    uart->tx_len = 0;
+    uart->tx_calls = 0;
+}
+
+/* ============================================================================
+ *                              HAL UART
+ * ============================================================================ */
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size) {
+    if (pData == NULL || Size == 0) {
+        return HAL_ERROR;
+    }
+
+    huart->pRxBuffPtr = pData;
+    huart->RxXferSize = Size;
+    huart->RxXferCount = Size;
+    huart->RxState = HAL_UART_STATE_BUSY_RX;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size) {
+    HostUart_t *uart = (HostUart_t *)huart;
+
+    if (pData == NULL || Size == 0) {
+        return HAL_ERROR;
+    }
+
+    huart->pRxBuffPtr = pData;
+    huart->RxXferSize = Size;
+    huart->RxXferCount = Size;
+    huart->RxState = HAL_UART_STATE_BUSY_RX;
+    uart->rx_write = 0;
+    uart->rx_channel.CNDTR = Size;
+    uart->rx_channel.CCR |= DMA_IT_HT;
+    return HAL_OK;
+}
+
+uint32_t HAL_UARTEx_GetRxEventType(UART_HandleTypeDef *huart) {
+    return huart->RxEventType;
+}
+
+HAL_StatusTypeDef HAL_UART_AbortReceive(UART_HandleTypeDef *huart) {
+    huart->RxState = HAL_UART_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+    (void)Timeout;
+
+    if (((HostUart_t *)huart)->tx_busy) {
+        return HAL_BUSY;
+    }
+    HostUart_Capture((HostUart_t *)huart, pData, Size);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size) {
+    HostUart_t *uart = (HostUart_t *)huart;
+
+    if (uart->tx_busy) {
+        return HAL_BUSY;
+    }
+    HostUart_Capture(uart, pData, Size);
+    uart->tx_busy = true;
+    huart->gState = HAL_UART_STATE_BUSY_TX;
+    return HAL_OK;
+}
+
+/* ============================================================================
+ *                              HAL DMA (无内存到外设通道)
+ * ============================================================================ */
+
+HAL_StatusTypeDef HAL_DMA_Start(DMA_HandleTypeDef *hdma, uint32_t SrcAddress, uint32_t DstAddress, uint32_t DataLength) {
+    (void)hdma;
+    (void)SrcAddress;
+    (void)DstAddress;
+    (void)DataLength;
+    return HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_DMA_PollForTransfer(DMA_HandleTypeDef *hdma, uint32_t CompleteLevel, uint32_t Timeout) {
+    (void)hdma;
+    (void)CompleteLevel;
+    (void)Timeout;
+    return HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef *hdma) {
+    (void)hdma;
+    return HAL_OK;
+}
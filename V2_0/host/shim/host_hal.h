@@ -0,0 +1,102 @@
+/**
+ * @file    host_hal.h
+ * @brief   主机构建的模拟串口与系统节拍
+ * @version 2.0.0
+ * @date    2025
+ *
+ * @details 以字节为单位模拟USART接收中断/循环DMA与空闲线检测，按真实HAL的顺序调用
+ *          HAL_UARTEx_RxEventCallback() / HAL_UART_TxCpltCallback()，发送内容追加到捕获缓冲区:
+ *          1. HostUart_Receive() 逐字节写入接收缓冲区，每字节调用一次 irq_handler，最后产生空闲事件
+ *          2. DMA发送在 HostUart_TxComplete() 调用前保持进行中，可复现流水线与发送队列的时序
+ *          3. 系统节拍只由 HostHal_SetTick() / HostHal_AdvanceTick() 推进，结果与运行速度无关
+ *          4. 寄存器模式 (HostUart_InitLL) 不经HAL函数，按USART寄存器与中断使能位驱动LL传输层
+ */
+
+#ifndef __HOST_HAL_H
+#define __HOST_HAL_H
+
+#include "main.h"
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   发送捕获缓冲区大小 (字节)
+ */
+#ifndef HOST_UART_TX_CAPTURE
+#define HOST_UART_TX_CAPTURE         2048U
+#endif
+
+/**
+ * @brief   模拟串口
+ * @note    huart 须为第一个成员，HAL函数据此由句柄找回模拟串口
+ */
+typedef struct HostUart {
+    UART_HandleTypeDef  huart;        /**< HAL句柄 (传给 Modbus_Config_t.huart) */
+    USART_TypeDef       regs;         /**< USART寄存器 */
+    DMA_Channel_TypeDef rx_channel;   /**< 接收DMA通道寄存器 */
+    DMA_HandleTypeDef   hdmarx;       /**< 接收DMA句柄 */
+
+    void (*irq_handler)(struct HostUart *uart); /**< USART中断入口 (对应 USARTx_IRQHandler, 可为NULL) */
+    bool                ll_mode;      /**< 寄存器模式 (LL驱动) */
+
+    uint16_t            rx_write;     /**< 循环DMA写入位置 */
+    bool                rx_muted;     /**< 静默模式 (至空闲线解除) */
+    uint32_t            rx_dropped;   /**< 未启动接收时到达而丢失的字节数 */
+
+    bool                tx_busy;      /**< DMA发送进行中 */
+    uint16_t            tx_len;       /**< 已捕获的发送字节数 */
+    uint32_t            tx_calls;     /**< 发送启动次数 */
+    uint8_t             tx_buf[HOST_UART_TX_CAPTURE]; /**< 发送捕获缓冲区 (超出部分丢弃) */
+} HostUart_t;
+
+/**
+ * @brief   初始化模拟串口
+ * @param   uart        模拟串口
+ * @param   rx_circular true=接收DMA配置为循环模式 (MODBUS_RX_DMA_RING)
+ */
+void HostUart_Init(HostUart_t *uart, bool rx_circular);
+
+/**
+ * @brief   初始化为寄存器模式的模拟串口 (供 modbus_port_ll.c 使用)
+ * @param   uart        模拟串口 (uart->regs 即传给 ModbusLL_Init() 的USART)
+ */
+void HostUart_InitLL(HostUart_t *uart);
+
+/**
+ * @brief   接收一段字节流并产生空闲线事件
+ * @param   uart    模拟串口
+ * @param   data    字节流
+ * @param   len     字节数
+ */
+void HostUart_Receive(HostUart_t *uart, const uint8_t *data, uint16_t len);
+
+/**
+ * @brief   完成进行中的DMA发送 (寄存器模式: 送出中断发送的全部字节)
+ * @retval  true    已完成一次发送并调用 HAL_UART_TxCpltCallback() (寄存器模式: TC中断)
+ * @retval  false   没有进行中的发送
+ */
+bool HostUart_TxComplete(HostUart_t *uart);
+
+/**
+ * @brief   清空发送捕获缓冲区
+ */
+void HostUart_TxClear(HostUart_t *uart);
+
+/**
+ * @brief   设置系统节拍 (ms)
+ */
+void HostHal_SetTick(uint32_t tick);
+
+/**
+ * @brief   推进系统节拍 (ms)
+ */
+void HostHal_AdvanceTick(uint32_t ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HOST_HAL_H */
@@ -0,0 +1,329 @@
+/**
+ * @file    main.h
+ * @brief   主机构建用的 STM32 HAL/CMSIS 最小子集 (仅用于 host/ 下的基准与模糊测试)
+ * @version 2.0.0
+ * @date    2025
+ *
+ * @details 替代 CubeMX 生成的 main.h，使 modbus_slave.c 无需修改即可在PC上编译:
+ *          1. 外设寄存器为普通内存结构体，按 USART v2 (G4/L4/F7/H7等) 提供位定义，
+ *             接收超时、硬件DE、静默模式等条件编译分支均参与编译
+ *          2. HAL UART 函数由 host_hal.c 以模拟串口实现，发送内容被捕获供校验
+ *          3. 未定义 HAL_CRC_MODULE_ENABLED / HAL_TIM_MODULE_ENABLED，硬件CRC与帧定时器不参与主机构建
+ *          4. 单线程执行，PRIMASK/屏障指令为空操作
+ *          5. 提供 modbus_port_ll.c 所用的LL USART函数，读写数据寄存器的硬件副作用(清除RXNE/TXE/TC)
+ *             在函数内模拟
+ */
+
+#ifndef __MAIN_H
+#define __MAIN_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================
+ *                              基本类型
+ * ============================================================================ */
+
+#define __IO    volatile
+
+typedef enum {
+    HAL_OK      = 0x00U,
+    HAL_ERROR   = 0x01U,
+    HAL_BUSY    = 0x02U,
+    HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+typedef enum { RESET = 0, SET = !RESET } FlagStatus;
+typedef enum { DISABLE = 0, ENABLE = !DISABLE } FunctionalState;
+
+/* ============================================================================
+ *                              外设寄存器
+ * ============================================================================ */
+
+typedef struct {
+    __IO uint32_t CR1, CR2, CR3, BRR, GTPR, RTOR, RQR, ISR, ICR, RDR, TDR, PRESC;
+} USART_TypeDef;
+
+typedef struct {
+    __IO uint32_t CCR, CNDTR, CPAR, CMAR;
+} DMA_Channel_TypeDef;
+
+typedef struct {
+    __IO uint32_t MODER, OTYPER, OSPEEDR, PUPDR, IDR, ODR, BSRR;
+} GPIO_TypeDef;
+
+typedef struct {
+    __IO uint32_t DR, IDR, CR, RES, INIT, POL;
+} CRC_TypeDef;
+
+typedef struct {
+    __IO uint32_t CTRL, CYCCNT;
+} DWT_Type;
+
+typedef struct {
+    __IO uint32_t DEMCR;
+} CoreDebug_Type;
+
+typedef struct {
+    __IO uint32_t CTRL, LOAD, VAL, CALIB;
+} SysTick_Type;
+
+typedef struct {
+    __IO uint32_t CPUID, ICSR;
+} SCB_Type;
+
+extern DWT_Type       *DWT;
+extern CoreDebug_Type *CoreDebug;
+extern SysTick_Type   *SysTick;
+extern SCB_Type       *SCB;
+extern GPIO_TypeDef   *GPIOA, *GPIOB, *GPIOC;
+extern uint32_t        SystemCoreClock;
+
+#define DWT_CTRL_CYCCNTENA_Msk       (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk   (1UL << 24)
+#define SCB_ICSR_PENDSTSET_Msk       (1UL << 26)
+
+/* USART v2 寄存器位 */
+#define USART_CR1_UE                 (1UL << 0)
+#define USART_CR1_UESM               (1UL << 1)
+#define USART_CR1_RE                 (1UL << 2)
+#define USART_CR1_TE                 (1UL << 3)
+#define USART_CR1_IDLEIE             (1UL << 4)
+#define USART_CR1_RXNEIE             (1UL << 5)
+#define USART_CR1_TCIE               (1UL << 6)
+#define USART_CR1_TXEIE              (1UL << 7)
+#define USART_CR1_MME                (1UL << 13)
+#define USART_CR1_DEDT_Pos           16U
+#define USART_CR1_DEDT               (0x1FUL << USART_CR1_DEDT_Pos)
+#define USART_CR1_DEAT_Pos           21U
+#define USART_CR1_DEAT               (0x1FUL << USART_CR1_DEAT_Pos)
+#define USART_CR1_RTOIE              (1UL << 26)
+#define USART_CR2_RTOEN              (1UL << 23)
+#define USART_CR3_EIE                (1UL << 0)
+#define USART_CR3_DMAR               (1UL << 6)
+#define USART_CR3_DMAT               (1UL << 7)
+#define USART_CR3_DEM                (1UL << 14)
+#define USART_CR3_DEP                (1UL << 15)
+#define USART_CR3_WUS                (3UL << 20)
+#define USART_CR3_WUS_1              (2UL << 20)
+#define USART_CR3_WUFIE              (1UL << 22)
+#define USART_RTOR_RTO               (0xFFFFFFUL)
+#define USART_RQR_MMRQ               (1UL << 2)
+#define USART_RQR_RXFRQ              (1UL << 3)
+#define USART_ISR_PE                 (1UL << 0)
+#define USART_ISR_FE                 (1UL << 1)
+#define USART_ISR_NE                 (1UL << 2)
+#define USART_ISR_ORE                (1UL << 3)
+#define USART_ISR_IDLE               (1UL << 4)
+#define USART_ISR_RXNE               (1UL << 5)
+#define USART_ISR_TC                 (1UL << 6)
+#define USART_ISR_TXE                (1UL << 7)
+#define USART_ISR_RTOF               (1UL << 11)
+#define USART_ISR_BUSY               (1UL << 16)
+#define USART_ISR_RWU                (1UL << 19)
+#define USART_ISR_WUF                (1UL << 20)
+#define USART_ICR_PECF               (1UL << 0)
+#define USART_ICR_FECF               (1UL << 1)
+#define USART_ICR_NECF               (1UL << 2)
+#define USART_ICR_ORECF              (1UL << 3)
+#define USART_ICR_IDLECF             (1UL << 4)
+#define USART_ICR_TCCF               (1UL << 6)
+#define USART_ICR_RTOCF              (1UL << 11)
+#define USART_ICR_WUCF               (1UL << 20)
+
+#define IS_UART_RECEIVER_TIMEOUT_INSTANCE(inst) (1)
+#define IS_UART_DRIVER_ENABLE_INSTANCE(inst)    (1)
+#define IS_LPUART_INSTANCE(inst)                (0)
+
+#define SET_BIT(REG, BIT)                       ((REG) |= (BIT))
+#define CLEAR_BIT(REG, BIT)                     ((REG) &= ~(BIT))
+#define READ_BIT(REG, BIT)                      ((REG) & (BIT))
+#define MODIFY_REG(REG, CLEARMASK, SETMASK)     ((REG) = (((REG) & (~(CLEARMASK))) | (SETMASK)))
+
+/* ============================================================================
+ *                              HAL 句柄
+ * ============================================================================ */
+
+typedef struct {
+    uint32_t Direction, PeriphInc, MemInc, PeriphDataAlignment, MemDataAlignment, Mode, Priority;
+} DMA_InitTypeDef;
+
+typedef struct __DMA_HandleTypeDef {
+    DMA_Channel_TypeDef *Instance;
+    DMA_InitTypeDef      Init;
+    void                *Parent;
+} DMA_HandleTypeDef;
+
+#define DMA_NORMAL                   0x00000000U
+#define DMA_CIRCULAR                 0x00000020U
+#define DMA_IT_HT                    0x00000004U
+#define HAL_DMA_FULL_TRANSFER        0x00U
+
+#define __HAL_DMA_GET_COUNTER(h)     ((h)->Instance->CNDTR)
+#define __HAL_DMA_DISABLE_IT(h, it)  ((h)->Instance->CCR &= ~(it))
+
+typedef struct {
+    USART_TypeDef      *Instance;
+    uint8_t            *pRxBuffPtr;
+    uint16_t            RxXferSize;
+    __IO uint16_t       RxXferCount;
+    DMA_HandleTypeDef  *hdmatx;
+    DMA_HandleTypeDef  *hdmarx;
+    __IO uint32_t       gState;
+    __IO uint32_t       RxState;
+    __IO uint32_t       ErrorCode;
+    __IO uint32_t       RxEventType;
+} UART_HandleTypeDef;
+
+typedef struct {
+    CRC_TypeDef *Instance;
+} CRC_HandleTypeDef;
+
+typedef struct {
+    void *Instance;
+} TIM_HandleTypeDef;
+
+#define HAL_UART_STATE_READY         0x20U
+#define HAL_UART_STATE_BUSY_TX       0x21U
+#define HAL_UART_STATE_BUSY_RX       0x22U
+
+#define HAL_UART_RXEVENT_TC          0x00U
+#define HAL_UART_RXEVENT_HT          0x01U
+#define HAL_UART_RXEVENT_IDLE        0x02U
+
+#define HAL_UART_ERROR_NONE          0x00U
+#define HAL_UART_ERROR_ORE           0x08U
+#define HAL_UART_ERROR_RTO           0x20U
+
+#define UART_FLAG_ORE                USART_ISR_ORE
+#define UART_FLAG_IDLE               USART_ISR_IDLE
+#define UART_FLAG_RXNE               USART_ISR_RXNE
+#define UART_FLAG_TC                 USART_ISR_TC
+#define UART_IT_TC                   0x0626U
+
+#define __HAL_UART_GET_FLAG(h, flag)  (((h)->Instance->ISR & (flag)) == (flag))
+#define __HAL_UART_ENABLE_IT(h, it)   ((h)->Instance->CR1 |= USART_CR1_TCIE)
+#define __HAL_UART_DISABLE_IT(h, it)  ((h)->Instance->CR1 &= ~USART_CR1_TCIE)
+#define __HAL_UART_ENABLE(h)          ((h)->Instance->CR1 |= USART_CR1_UE)
+#define __HAL_UART_DISABLE(h)         ((h)->Instance->CR1 &= ~USART_CR1_UE)
+
+typedef enum {
+    GPIO_PIN_RESET = 0U,
+    GPIO_PIN_SET
+} GPIO_PinState;
+
+/* ============================================================================
+ *                              HAL 函数 (host_hal.c)
+ * ============================================================================ */
+
+uint32_t HAL_GetTick(void);
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+uint32_t HAL_UARTEx_GetRxEventType(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_AbortReceive(UART_HandleTypeDef *huart);
+
+HAL_StatusTypeDef HAL_DMA_Start(DMA_HandleTypeDef *hdma, uint32_t SrcAddress, uint32_t DstAddress, uint32_t DataLength);
+HAL_StatusTypeDef HAL_DMA_PollForTransfer(DMA_HandleTypeDef *hdma, uint32_t CompleteLevel, uint32_t Timeout);
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef *hdma);
+
+/* 由应用实现的HAL回调 (在目标板上为弱定义) */
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size);
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart);
+
+/* ============================================================================
+ *                              LL USART (modbus_port_ll.c 所用部分)
+ * ============================================================================ */
+
+#define LL_USART_DIRECTION_TX_RX     (USART_CR1_TE | USART_CR1_RE)
+
+static inline uint32_t LL_USART_IsActiveFlag_RXNE(USART_TypeDef *USARTx) { return (USARTx->ISR & USART_ISR_RXNE) != 0U; }
+static inline uint32_t LL_USART_IsActiveFlag_ORE(USART_TypeDef *USARTx)  { return (USARTx->ISR & USART_ISR_ORE) != 0U; }
+static inline uint32_t LL_USART_IsActiveFlag_IDLE(USART_TypeDef *USARTx) { return (USARTx->ISR & USART_ISR_IDLE) != 0U; }
+static inline uint32_t LL_USART_IsActiveFlag_TXE(USART_TypeDef *USARTx)  { return (USARTx->ISR & USART_ISR_TXE) != 0U; }
+static inline uint32_t LL_USART_IsActiveFlag_TC(USART_TypeDef *USARTx)   { return (USARTx->ISR & USART_ISR_TC) != 0U; }
+
+/* 硬件上ICR写1清除ISR对应位 */
+static inline void LL_USART_ClearFlag_ORE(USART_TypeDef *USARTx)  { USARTx->ISR &= ~USART_ISR_ORE; }
+static inline void LL_USART_ClearFlag_IDLE(USART_TypeDef *USARTx) { USARTx->ISR &= ~USART_ISR_IDLE; }
+static inline void LL_USART_ClearFlag_TC(USART_TypeDef *USARTx)   { USARTx->ISR &= ~USART_ISR_TC; }
+
+static inline void LL_USART_EnableIT_RXNE(USART_TypeDef *USARTx) { USARTx->CR1 |= USART_CR1_RXNEIE; }
+static inline void LL_USART_EnableIT_IDLE(USART_TypeDef *USARTx) { USARTx->CR1 |= USART_CR1_IDLEIE; }
+static inline void LL_USART_EnableIT_TXE(USART_TypeDef *USARTx)  { USARTx->CR1 |= USART_CR1_TXEIE; }
+static inline void LL_USART_DisableIT_TXE(USART_TypeDef *USARTx) { USARTx->CR1 &= ~USART_CR1_TXEIE; }
+static inline void LL_USART_EnableIT_TC(USART_TypeDef *USARTx)   { USARTx->CR1 |= USART_CR1_TCIE; }
+static inline void LL_USART_DisableIT_TC(USART_TypeDef *USARTx)  { USARTx->CR1 &= ~USART_CR1_TCIE; }
+static inline uint32_t LL_USART_IsEnabledIT_TXE(USART_TypeDef *USARTx) { return (USARTx->CR1 & USART_CR1_TXEIE) != 0U; }
+static inline uint32_t LL_USART_IsEnabledIT_TC(USART_TypeDef *USARTx)  { return (USARTx->CR1 & USART_CR1_TCIE) != 0U; }
+
+/* 读RDR清除RXNE; 写TDR清除TXE与TC */
+static inline uint8_t LL_USART_ReceiveData8(USART_TypeDef *USARTx) {
+    USARTx->ISR &= ~USART_ISR_RXNE;
+    return (uint8_t)USARTx->RDR;
+}
+
+static inline void LL_USART_TransmitData8(USART_TypeDef *USARTx, uint8_t Value) {
+    USARTx->TDR = Value;
+    USARTx->ISR &= ~(USART_ISR_TXE | USART_ISR_TC);
+}
+
+/* ============================================================================
+ *                              CMSIS 内建函数
+ * ============================================================================ */
+
+#define __STATIC_FORCEINLINE  static inline __attribute__((always_inline))
+
+__STATIC_FORCEINLINE uint32_t __get_PRIMASK(void) { return 0U; }
+__STATIC_FORCEINLINE void __set_PRIMASK(uint32_t priMask) { (void)priMask; }
+__STATIC_FORCEINLINE void __disable_irq(void) { }
+__STATIC_FORCEINLINE void __enable_irq(void) { }
+__STATIC_FORCEINLINE void __DMB(void) { __asm__ volatile("" ::: "memory"); }
+__STATIC_FORCEINLINE void __DSB(void) { __asm__ volatile("" ::: "memory"); }
+__STATIC_FORCEINLINE void __WFI(void) { }
+
+__STATIC_FORCEINLINE uint32_t __REV(uint32_t value) { return __builtin_bswap32(value); }
+__STATIC_FORCEINLINE uint32_t __REV16(uint32_t value) {
+    return ((value & 0xFF00FF00U) >> 8) | ((value & 0x00FF00FFU) << 8);
+}
+__STATIC_FORCEINLINE uint32_t __RBIT(uint32_t value) {
+    uint32_t result = 0;
+    for (uint32_t i = 0; i < 32U; i++) {
+        result = (result << 1) | (value & 1U);
+        value >>= 1;
+    }
+    return result;
+}
+__STATIC_FORCEINLINE uint8_t __CLZ(uint32_t value) {
+    return (value != 0U) ? (uint8_t)__builtin_clz(value) : 32U;
+}
+
+/* 非对齐访问经 memcpy 实现，避免主机上的未定义行为 */
+__STATIC_FORCEINLINE uint32_t __host_u32_read(const void *addr) {
+    uint32_t v;
+    memcpy(&v, addr, sizeof(v));
+    return v;
+}
+__STATIC_FORCEINLINE uint16_t __host_u16_read(const void *addr) {
+    uint16_t v;
+    memcpy(&v, addr, sizeof(v));
+    return v;
+}
+#define __UNALIGNED_UINT32_READ(addr)       __host_u32_read(addr)
+#define __UNALIGNED_UINT16_READ(addr)       __host_u16_read(addr)
+#define __UNALIGNED_UINT32_WRITE(addr, val) do { uint32_t __v = (val); memcpy((addr), &__v, 4); } while (0)
+#define __UNALIGNED_UINT16_WRITE(addr, val) do { uint16_t __v = (val); memcpy((addr), &__v, 2); } while (0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MAIN_H */
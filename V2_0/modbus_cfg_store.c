@@ -0,0 +1,426 @@
+/**
+ * @file    modbus_cfg_store.c
+ * @brief   Modbus从站配置参数的日志式Flash存储实现
+ * @version 2.0.0
+ * @date    2025
+ * 
+ * @details 本文件实现:
+ *          - 页内追加写入: 每条记录 {key, crc, value}，同一键以最后一条有效记录为准
+ *          - 页写满时压缩: 擦除备用页 -> 写入全部当前值 -> 最后写页头(代数+1)
+ *          - 中断驱动的后台状态机: 主循环每次调用只启动一次Flash操作，从不等待
+ * 
+ *          页布局 (每槽8字节):
+ *          | 槽0: 页头 {0xFFFE, crc, 代数} | 槽1..n: 参数记录 | 空槽: 全0xFF |
+ */
+
+#include "modbus_cfg_store.h"
+#include <string.h>
+
+/* ============================================================================
+ *                              内部定义
+ * ============================================================================ */
+
+#define CFG_RECORD_SIZE     8U                                           /**< 记录(槽)字节数 */
+#define CFG_UNITS           (CFG_RECORD_SIZE / MODBUS_CFG_PROGRAM_BYTES) /**< 每条记录的编程次数 */
+#define CFG_ENTRY_HEADER    0xFFU                                        /**< 正在编程的记录为页头 */
+
+#define CFG_OP_BUSY         0U      /**< Flash操作进行中 */
+#define CFG_OP_OK           1U      /**< Flash操作成功 */
+#define CFG_OP_FAIL         2U      /**< Flash操作失败 */
+
+#if MODBUS_CFG_MAX_KEYS > 32
+#error "MODBUS_CFG_MAX_KEYS must not exceed 32"
+#endif
+
+/**
+ * @brief   Flash记录
+ */
+typedef struct {
+    uint16_t key;                   /**< 参数键 */
+    uint16_t crc;                   /**< key与value的CRC16 */
+    uint32_t value;                 /**< 参数值 */
+} ModbusCfg_Record_t;
+
+/**
+ * @brief   后台状态
+ */
+typedef enum {
+    CFG_STATE_IDLE = 0,             /**< 无Flash操作 */
+    CFG_STATE_ERASE,                /**< 正在擦除备用页 */
+    CFG_STATE_PROGRAM               /**< 正在编程一条记录 */
+} ModbusCfg_State_t;
+
+/* ============================================================================
+ *                              存储状态
+ * ============================================================================ */
+
+static ModbusCfg_Config_t s_config;                   /**< 存储配置 */
+static bool               s_ready;                    /**< 已初始化 */
+
+static uint16_t s_keys[MODBUS_CFG_MAX_KEYS];          /**< 参数键 */
+static uint32_t s_values[MODBUS_CFG_MAX_KEYS];        /**< 参数当前值 */
+static uint8_t  s_count;                              /**< 参数个数 */
+static uint32_t s_pending;                            /**< 待写入的参数位图 */
+
+static uint8_t  s_active;                             /**< 当前页序号 */
+static bool     s_formatted;                          /**< 当前页已有有效页头 */
+static uint32_t s_generation;                         /**< 当前页代数 */
+static uint32_t s_slot;                               /**< 当前页下一个空槽 */
+
+static bool     s_compacting;                         /**< 正在向备用页压缩 */
+static bool     s_spare_erased;                       /**< 备用页已擦除 */
+static uint32_t s_copy_slot;                          /**< 备用页下一个空槽 */
+
+static ModbusCfg_State_t  s_state;                    /**< 后台状态 */
+static ModbusCfg_Record_t s_record;                   /**< 正在编程的记录 */
+static uint32_t           s_record_addr;              /**< 正在编程的记录地址 */
+static uint8_t            s_record_entry;             /**< 记录对应的参数序号 (CFG_ENTRY_HEADER为页头) */
+static uint8_t            s_unit;                     /**< 本记录已启动的编程单元序号 */
+static volatile uint8_t   s_op_result;                /**< 当前Flash操作结果 */
+
+/* ============================================================================
+ *                              内部函数
+ * ============================================================================ */
+
+/**
+ * @brief   计算记录校验 (CRC16-Modbus, 覆盖key与value共6字节)
+ */
+static uint16_t ModbusCfg_Crc(uint16_t key, uint32_t value) {
+    const uint8_t bytes[6] = {
+        (uint8_t)key, (uint8_t)(key >> 8),
+        (uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24)
+    };
+    uint16_t crc = 0xFFFF;
+    
+    for (uint32_t i = 0; i < sizeof(bytes); i++) {
+        crc ^= bytes[i];
+        for (uint32_t bit = 0; bit < 8U; bit++) {
+            crc = (crc & 1U) ? (uint16_t)((crc >> 1) ^ 0xA001U) : (uint16_t)(crc >> 1);
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief   读取页内一个槽
+ */
+static void ModbusCfg_ReadSlot(uint8_t page, uint32_t slot, ModbusCfg_Record_t *record) {
+    memcpy(record, (const void *)(uintptr_t)(s_config.page_addr[page] + slot * CFG_RECORD_SIZE), sizeof(*record));
+}
+
+/**
+ * @brief   判断槽是否为擦除状态
+ */
+static bool ModbusCfg_SlotErased(const ModbusCfg_Record_t *record) {
+    return record->key == MODBUS_CFG_KEY_ERASED && record->crc == 0xFFFFU && record->value == 0xFFFFFFFFUL;
+}
+
+/**
+ * @brief   查找参数序号
+ * @return  参数序号; 未找到时返回 s_count
+ */
+static uint32_t ModbusCfg_Find(uint16_t key) {
+    uint32_t i;
+    for (i = 0; i < s_count; i++) {
+        if (s_keys[i] == key) {
+            break;
+        }
+    }
+    return i;
+}
+
+/**
+ * @brief   全部参数的位图
+ */
+static uint32_t ModbusCfg_AllMask(void) {
+    return (s_count >= 32U) ? 0xFFFFFFFFUL : ((1UL << s_count) - 1U);
+}
+
+/**
+ * @brief   序号最小的待写入参数
+ */
+static uint8_t ModbusCfg_FirstPending(void) {
+    return (uint8_t)(31U - __CLZ(s_pending & (0U - s_pending)));
+}
+
+/**
+ * @brief   启动当前记录的下一个编程单元
+ */
+static void ModbusCfg_ProgramUnit(void) {
+    uint64_t data = 0;
+    memcpy(&data, (const uint8_t *)&s_record + s_unit * MODBUS_CFG_PROGRAM_BYTES, MODBUS_CFG_PROGRAM_BYTES);
+    
+    s_op_result = CFG_OP_BUSY;
+    if (HAL_FLASH_Program_IT(MODBUS_CFG_PROGRAM_TYPE,
+                             s_record_addr + s_unit * MODBUS_CFG_PROGRAM_BYTES, data) != HAL_OK) {
+        s_op_result = CFG_OP_FAIL;
+    }
+}
+
+/**
+ * @brief   开始编程一条记录
+ * @param   page  目标页序号
+ * @param   slot  目标槽
+ * @param   entry 参数序号 (CFG_ENTRY_HEADER为页头)
+ */
+static void ModbusCfg_StartRecord(uint8_t page, uint32_t slot, uint8_t entry) {
+    if (entry == CFG_ENTRY_HEADER) {
+        s_record.key = MODBUS_CFG_KEY_HEADER;
+        s_record.value = s_generation + 1U;
+    } else {
+        s_record.key = s_keys[entry];
+        s_record.value = s_values[entry];
+    }
+    s_record.crc = ModbusCfg_Crc(s_record.key, s_record.value);
+    s_record_addr = s_config.page_addr[page] + slot * CFG_RECORD_SIZE;
+    s_record_entry = entry;
+    s_unit = 0;
+    s_state = CFG_STATE_PROGRAM;
+    
+    (void)HAL_FLASH_Unlock();
+    ModbusCfg_ProgramUnit();
+}
+
+/**
+ * @brief   开始擦除备用页
+ */
+static void ModbusCfg_StartErase(void) {
+    s_state = CFG_STATE_ERASE;
+    s_op_result = CFG_OP_BUSY;
+    
+    (void)HAL_FLASH_Unlock();
+    if (HAL_FLASHEx_Erase_IT(&s_config.erase[s_active ^ 1U]) != HAL_OK) {
+        s_op_result = CFG_OP_FAIL;
+    }
+}
+
+/**
+ * @brief   一条记录的编程单元完成
+ * @param   ok  本单元是否成功
+ */
+static void ModbusCfg_ProgramDone(bool ok) {
+    if (ok && ++s_unit < CFG_UNITS) {
+        ModbusCfg_ProgramUnit();
+        return;
+    }
+    s_state = CFG_STATE_IDLE;
+    
+    /* 页头写入成功: 备用页成为当前页; 失败则重新压缩 */
+    if (s_record_entry == CFG_ENTRY_HEADER) {
+        if (ok) {
+            s_active ^= 1U;
+            s_generation++;
+            s_slot = s_copy_slot;
+            s_formatted = true;
+            s_compacting = false;
+        }
+        s_spare_erased = false;
+        return;
+    }
+    
+    /* 失败的槽可能已部分写入，跳过该槽并重试; 写入期间值又被修改时保持待写入 */
+    if (s_compacting) {
+        s_copy_slot++;
+    } else {
+        s_slot++;
+    }
+    if (ok && s_values[s_record_entry] == s_record.value) {
+        s_pending &= ~(1UL << s_record_entry);
+    }
+}
+
+/**
+ * @brief   空闲时启动下一项Flash操作
+ */
+static void ModbusCfg_StartNext(void) {
+    uint32_t slots = s_config.page_size / CFG_RECORD_SIZE;
+    
+    if (s_compacting) {
+        if (!s_spare_erased) {
+            ModbusCfg_StartErase();
+        } else if (s_pending != 0U && s_copy_slot >= slots) {
+            s_spare_erased = false;  /* 失败槽过多导致备用页写满: 重新擦除 */
+            ModbusCfg_StartErase();
+        } else if (s_pending != 0U) {
+            ModbusCfg_StartRecord(s_active ^ 1U, s_copy_slot, ModbusCfg_FirstPending());
+        } else {
+            ModbusCfg_StartRecord(s_active ^ 1U, 0, CFG_ENTRY_HEADER);
+        }
+        return;
+    }
+    
+    if (s_pending == 0U) {
+        (void)HAL_FLASH_Lock();
+        return;
+    }
+    
+    /* 尚未格式化或当前页已满: 压缩到备用页 */
+    if (!s_formatted || s_slot >= slots) {
+        s_compacting = true;
+        s_spare_erased = false;
+        ModbusCfg_StartErase();
+        return;
+    }
+    
+    ModbusCfg_StartRecord(s_active, s_slot, ModbusCfg_FirstPending());
+}
+
+/* ============================================================================
+ *                              API函数实现
+ * ============================================================================ */
+
+/**
+ * @brief   扫描两页并恢复参数
+ */
+bool ModbusCfg_Init(const ModbusCfg_Config_t *config) {
+    if (config == NULL || config->page_size < CFG_RECORD_SIZE * 2U ||
+        (config->page_size % CFG_RECORD_SIZE) != 0U ||
+        config->page_size / CFG_RECORD_SIZE < MODBUS_CFG_MAX_KEYS + 1U ||
+        config->page_addr[0] == config->page_addr[1]) {
+        return false;
+    }
+    
+    s_config = *config;
+    s_count = 0;
+    s_pending = 0;
+    s_compacting = false;
+    s_spare_erased = false;
+    s_state = CFG_STATE_IDLE;
+    s_op_result = CFG_OP_OK;
+    
+    /* 选择有效页头中代数较新的一页 */
+    bool valid[2];
+    uint32_t generation[2];
+    for (uint8_t page = 0; page < 2U; page++) {
+        ModbusCfg_Record_t header;
+        ModbusCfg_ReadSlot(page, 0, &header);
+        valid[page] = (header.key == MODBUS_CFG_KEY_HEADER && header.crc == ModbusCfg_Crc(header.key, header.value));
+        generation[page] = header.value;
+    }
+    
+    if (valid[0] && valid[1]) {
+        s_active = ((int32_t)(generation[1] - generation[0]) > 0) ? 1U : 0U;
+    } else if (valid[0] || valid[1]) {
+        s_active = valid[1] ? 1U : 0U;
+    } else {
+        /* 空存储: 首次写入时格式化页0 */
+        s_active = 1;
+        s_formatted = false;
+        s_generation = 0;
+        s_slot = 1;
+        s_ready = true;
+        return true;
+    }
+    s_formatted = true;
+    s_generation = generation[s_active];
+    
+    /* 回放全部记录; 追加位置位于最后一个非空槽之后 (失败槽之后仍可能有有效记录) */
+    uint32_t slots = s_config.page_size / CFG_RECORD_SIZE;
+    s_slot = 1;
+    for (uint32_t slot = 1; slot < slots; slot++) {
+        ModbusCfg_Record_t record;
+        ModbusCfg_ReadSlot(s_active, slot, &record);
+        if (ModbusCfg_SlotErased(&record)) {
+            continue;
+        }
+        s_slot = slot + 1U;
+        
+        if (record.key >= MODBUS_CFG_KEY_HEADER || record.crc != ModbusCfg_Crc(record.key, record.value)) {
+            continue;  /* 写入中掉电或失败的槽 */
+        }
+        uint32_t entry = ModbusCfg_Find(record.key);
+        if (entry == s_count) {
+            if (s_count >= MODBUS_CFG_MAX_KEYS) {
+                return false;
+            }
+            s_keys[s_count++] = record.key;
+        }
+        s_values[entry] = record.value;
+    }
+    
+    s_ready = true;
+    return true;
+}
+
+/**
+ * @brief   读取参数
+ */
+bool ModbusCfg_Get(uint16_t key, uint32_t *value) {
+    uint32_t entry = ModbusCfg_Find(key);
+    if (!s_ready || value == NULL || entry == s_count) {
+        return false;
+    }
+    
+    *value = s_values[entry];
+    return true;
+}
+
+/**
+ * @brief   修改参数
+ */
+bool ModbusCfg_Set(uint16_t key, uint32_t value) {
+    if (!s_ready || key >= MODBUS_CFG_KEY_HEADER) {
+        return false;
+    }
+    
+    uint32_t entry = ModbusCfg_Find(key);
+    if (entry == s_count) {
+        if (s_count >= MODBUS_CFG_MAX_KEYS) {
+            return false;
+        }
+        s_keys[s_count++] = key;
+    } else if (s_values[entry] == value) {
+        return true;  /* 值未变化 */
+    }
+    
+    s_values[entry] = value;
+    s_pending |= 1UL << entry;
+    return true;
+}
+
+/**
+ * @brief   推进后台写入状态机
+ */
+void ModbusCfg_Poll(void) {
+    if (!s_ready) {
+        return;
+    }
+    
+    if (s_state != CFG_STATE_IDLE) {
+        uint8_t result = s_op_result;
+        if (result == CFG_OP_BUSY) {
+            return;
+        }
+        
+        if (s_state == CFG_STATE_ERASE) {
+            s_state = CFG_STATE_IDLE;
+            if (result == CFG_OP_OK) {
+                /* 备用页已擦除: 写入全部当前值后再写页头 */
+                s_spare_erased = true;
+                s_copy_slot = 1;
+                s_pending = ModbusCfg_AllMask();
+            }
+        } else {
+            ModbusCfg_ProgramDone(result == CFG_OP_OK);
+            if (s_state != CFG_STATE_IDLE) {
+                return;  /* 本记录的下一个编程单元已启动 */
+            }
+        }
+    }
+    
+    ModbusCfg_StartNext();
+}
+
+/**
+ * @brief   Flash操作完成通知
+ */
+void ModbusCfg_FlashCallback(bool ok) {
+    s_op_result = ok ? CFG_OP_OK : CFG_OP_FAIL;
+}
+
+/**
+ * @brief   查询是否仍有未完成的写入
+ */
+bool ModbusCfg_Busy(void) {
+    return s_state != CFG_STATE_IDLE || s_pending != 0U || s_compacting;
+}
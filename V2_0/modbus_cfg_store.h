@@ -0,0 +1,165 @@
+/**
+ * @file    modbus_cfg_store.h
+ * @brief   Modbus从站配置参数的日志式Flash存储 (可选)
+ * @version 2.0.0
+ * @date    2025
+ * 
+ * @details 替代"每次0x64写入都擦除整页"的保存方式:
+ *          1. 参数以 {key, crc, value} 8字节记录追加写入当前页，只有页写满时才压缩到另一页
+ *          2. 擦除与编程均经 HAL_FLASH_xxx_IT() 在后台进行，ModbusCfg_Set() 只更新RAM并立即返回
+ *          3. 两页轮换，页头(代数计数)在压缩完成后最后写入，掉电时旧页始终完整有效
+ *          每页可容纳 页大小/8 条记录，N个参数时每次擦除可承载约 (页大小/8 - N) 次修改
+ * 
+ * @note    需在CubeMX中使能FLASH全局中断，并在HAL Flash回调中转发结果:
+ *          HAL_FLASH_EndOfOperationCallback()  -> ModbusCfg_FlashCallback(true)
+ *          HAL_FLASH_OperationErrorCallback()  -> ModbusCfg_FlashCallback(false)
+ *          单Bank芯片在擦除/编程期间从同一Bank取指仍会等待，请将存储页放在另一Bank，
+ *          或接受页写满时的一次擦除等待; 追加一条记录的编程时间仅为数十微秒
+ */
+
+#ifndef __MODBUS_CFG_STORE_H
+#define __MODBUS_CFG_STORE_H
+
+#include "main.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================
+ *                              存储配置
+ * ============================================================================ */
+
+/**
+ * @brief   可存储的参数个数上限 (RAM缓存表大小, 不超过32)
+ */
+#ifndef MODBUS_CFG_MAX_KEYS
+#define MODBUS_CFG_MAX_KEYS          16
+#endif
+
+/**
+ * @brief   Flash单次编程类型与字节数
+ * @note    F2/F4/F7 的双字编程需外部Vpp，按字编程; F0/F1/G0/G4/L4 等按双字编程
+ *          其他系列(如H7按256位Flash字编程)需自行定义这两个宏
+ */
+#if !defined(MODBUS_CFG_PROGRAM_TYPE)
+#if defined(STM32F2) || defined(STM32F4) || defined(STM32F7)
+#define MODBUS_CFG_PROGRAM_TYPE      FLASH_TYPEPROGRAM_WORD
+#define MODBUS_CFG_PROGRAM_BYTES     4U
+#elif defined(FLASH_TYPEPROGRAM_DOUBLEWORD)
+#define MODBUS_CFG_PROGRAM_TYPE      FLASH_TYPEPROGRAM_DOUBLEWORD
+#define MODBUS_CFG_PROGRAM_BYTES     8U
+#else
+#error "modbus_cfg_store: define MODBUS_CFG_PROGRAM_TYPE and MODBUS_CFG_PROGRAM_BYTES for this device"
+#endif
+#endif
+
+/**
+ * @brief   保留键值: 页头与擦除状态
+ */
+#define MODBUS_CFG_KEY_HEADER        0xFFFEU  /**< 页头记录 (value为页代数) */
+#define MODBUS_CFG_KEY_ERASED        0xFFFFU  /**< 擦除状态 (空槽) */
+
+/**
+ * @brief   存储配置结构体
+ * @note    两页须大小相同、互不重叠且仅供本模块使用;
+ *          erase 按芯片填写 (页擦除: TypeErase/Page或PageAddress/NbPages=1; 扇区擦除: Sector/NbSectors=1)
+ */
+typedef struct {
+    uint32_t               page_addr[2];  /**< 两页(扇区)起始地址 */
+    uint32_t               page_size;     /**< 页(扇区)可用字节数 (8的倍数) */
+    FLASH_EraseInitTypeDef erase[2];      /**< 两页各自的擦除参数 */
+} ModbusCfg_Config_t;
+
+/* ============================================================================
+ *                              API函数声明
+ * ============================================================================ */
+
+/**
+ * @brief   扫描两页并恢复参数
+ * @param   config  存储配置
+ * @retval  true    初始化成功 (两页均无有效页头时视为空存储，首次写入前在后台格式化)
+ * @retval  false   参数无效，或已读出的参数个数超过 MODBUS_CFG_MAX_KEYS
+ * 
+ * @note    在 Modbus_Init() 之前调用，读取的从站地址、波特率即可用于实例配置
+ *          校验失败的记录(写入中掉电)被跳过，同一键以最后一条有效记录为准
+ * 
+ * @code
+ *          ModbusCfg_Config_t store = {
+ *              .page_addr = { 0x0807E000, 0x0807F000 },
+ *              .page_size = 0x1000,
+ *              .erase = {
+ *                  { .TypeErase = FLASH_TYPEERASE_PAGES, .Banks = FLASH_BANK_2, .Page = 126, .NbPages = 1 },
+ *                  { .TypeErase = FLASH_TYPEERASE_PAGES, .Banks = FLASH_BANK_2, .Page = 127, .NbPages = 1 },
+ *              },
+ *          };
+ *          ModbusCfg_Init(&store);
+ *          uint32_t addr = DEFAULT_SLAVE_ADDR;
+ *          ModbusCfg_Get(CFG_KEY_SLAVE_ADDR, &addr);
+ * @endcode
+ */
+bool ModbusCfg_Init(const ModbusCfg_Config_t *config);
+
+/**
+ * @brief   读取参数
+ * @param   key     参数键 (0x0000~0xFFFD)
+ * @param   value   输出: 参数值
+ * @retval  true    已读取
+ * @retval  false   未存储该参数 (value保持不变，便于预置默认值)
+ */
+bool ModbusCfg_Get(uint16_t key, uint32_t *value);
+
+/**
+ * @brief   修改参数 (仅更新RAM并登记待写入，立即返回)
+ * @param   key     参数键 (0x0000~0xFFFD)
+ * @param   value   参数值
+ * @retval  true    已登记 (值未变化时不产生写入)
+ * @retval  false   键无效、参数表已满或未初始化
+ * 
+ * @note    可在 custom_config_cb 中直接调用; 与 ModbusCfg_Poll() 须在同一上下文中调用，不可在中断中调用
+ *          同一参数在写入完成前多次修改时只写入最后的值
+ */
+bool ModbusCfg_Set(uint16_t key, uint32_t value);
+
+/**
+ * @brief   推进后台写入状态机
+ * 
+ * @note    在主循环或低优先级任务中周期调用，每次调用最多启动一次擦除或编程，不等待其完成
+ */
+void ModbusCfg_Poll(void);
+
+/**
+ * @brief   Flash操作完成通知 (在HAL Flash回调中调用)
+ * @param   ok      true=操作成功 (EndOfOperation), false=操作失败 (OperationError)
+ * 
+ * @note    中断上下文; 仅记录结果，由 ModbusCfg_Poll() 继续下一步
+ * 
+ * @code
+ *          void HAL_FLASH_EndOfOperationCallback(uint32_t ReturnValue) {
+ *              (void)ReturnValue;
+ *              ModbusCfg_FlashCallback(true);
+ *          }
+ *          void HAL_FLASH_OperationErrorCallback(uint32_t ReturnValue) {
+ *              (void)ReturnValue;
+ *              ModbusCfg_FlashCallback(false);
+ *          }
+ * @endcode
+ */
+void ModbusCfg_FlashCallback(bool ok);
+
+/**
+ * @brief   查询是否仍有未完成的写入
+ * @retval  true    有参数尚未写入Flash，或擦除/编程正在进行
+ * @retval  false   所有修改均已持久化
+ * 
+ * @note    软复位使新配置生效前应等待其返回false
+ */
+bool ModbusCfg_Busy(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MODBUS_CFG_STORE_H */
@@ -0,0 +1,225 @@
+/**
+ * @file    modbus_port_ll.c
+ * @brief   Modbus从站协议栈 STM32 LL 传输层实现
+ * @version 2.0.0
+ * @date    2025
+ *
+ * @details 本文件实现:
+ *          - 接收: RXNE中断逐字节写入协议栈缓冲区，空闲线或缓冲区收满时结束本次接收
+ *          - 发送: TXE中断逐字节送出，最后一个字节写入后改用TC中断，线路空闲后回调协议栈
+ *          - DE引脚经GPIO BSRR原子切换
+ *          - SysTick推算的微秒时基
+ *          接收/发送状态只在USART中断与 start_rx/send 中修改，start_rx 先停止接收再切换缓冲区
+ */
+
+#include "modbus_port_ll.h"
+
+/* ============================================================================
+ *                              内部函数声明
+ * ============================================================================ */
+
+static bool ModbusLL_StartRx(const ModbusHandle_t *hmodbus, uint8_t *buf, uint16_t size);
+static uint16_t ModbusLL_RxCount(const ModbusHandle_t *hmodbus);
+static bool ModbusLL_Send(const ModbusHandle_t *hmodbus, const uint8_t *data, uint16_t len);
+static void ModbusLL_SetDirection(const ModbusHandle_t *hmodbus, bool tx);
+static uint32_t ModbusLL_NowUs(const ModbusHandle_t *hmodbus);
+
+/* ============================================================================
+ *                              传输层接口表
+ * ============================================================================ */
+
+const Modbus_Transport_t ModbusLL_Transport = {
+    .start_rx      = ModbusLL_StartRx,
+    .rx_count      = ModbusLL_RxCount,
+    .send          = ModbusLL_Send,
+    .set_direction = ModbusLL_SetDirection,
+    .now_us        = ModbusLL_NowUs,
+};
+
+/* ============================================================================
+ *                              API函数实现
+ * ============================================================================ */
+
+/**
+ * @brief   初始化LL传输层端口并使能接收/空闲中断
+ */
+bool ModbusLL_Init(ModbusLL_Port_t *port, USART_TypeDef *uart) {
+    if (port == NULL || uart == NULL) {
+        return false;
+    }
+    
+    port->uart = uart;
+    port->rx_size = 0;
+    port->rx_count = 0;
+    port->rx_buf = NULL;
+    port->tx_data = NULL;
+    port->tx_len = 0;
+    port->tx_pos = 0;
+    port->tx_busy = false;
+    
+    /* 清除上电后残留的空闲/溢出标志，避免使能中断后立即误报帧结束 */
+    LL_USART_ClearFlag_IDLE(uart);
+    LL_USART_ClearFlag_ORE(uart);
+    LL_USART_EnableIT_RXNE(uart);
+    LL_USART_EnableIT_IDLE(uart);
+    return true;
+}
+
+/**
+ * @brief   USART中断处理
+ */
+void ModbusLL_IRQHandler(ModbusHandle_t *hmodbus) {
+    if (hmodbus == NULL) {
+        return;
+    }
+    
+    ModbusLL_Port_t *port = (ModbusLL_Port_t *)Modbus_GetTransportCtx(hmodbus);
+    USART_TypeDef *uart = port->uart;
+    
+    /* 溢出标志须在读数据寄存器之前取样 (USART v1 读DR即清除ORE) */
+    bool overrun = LL_USART_IsActiveFlag_ORE(uart) != 0U;
+    
+    if (LL_USART_IsActiveFlag_RXNE(uart)) {
+        uint8_t byte = LL_USART_ReceiveData8(uart);
+        uint16_t count = port->rx_count;
+        
+        /* 未启动接收时读出并丢弃，不让RXNE保持置位而引发溢出 */
+        if (count < port->rx_size) {
+            port->rx_buf[count++] = byte;
+            port->rx_count = count;
+            if (hmodbus->incremental_crc) {
+                Modbus_UART_IRQHandler(hmodbus);
+            }
+            
+            /* 缓冲区已满: 与HAL相同，立即结束本次接收 */
+            if (count == port->rx_size) {
+                port->rx_size = 0;
+                Modbus_RxCallback(hmodbus, count);
+            }
+        }
+    }
+    
+    if (overrun) {
+        LL_USART_ClearFlag_ORE(uart);
+#if MODBUS_STATS_ENABLED
+        hmodbus->stats.bus_overrun++;
+#endif
+    }
+    
+    /* 空闲线: 帧结束; 协议栈在回调中重新启动接收 */
+    if (LL_USART_IsActiveFlag_IDLE(uart)) {
+        LL_USART_ClearFlag_IDLE(uart);
+        uint16_t count = port->rx_count;
+        if (port->rx_size != 0 && count != 0) {
+            port->rx_size = 0;
+            Modbus_RxCallback(hmodbus, count);
+        }
+    }
+    
+    /* 发送: 最后一个字节写入数据寄存器后改等TC，保证RS485切回接收时线路已空闲 */
+    if (LL_USART_IsEnabledIT_TXE(uart) && LL_USART_IsActiveFlag_TXE(uart)) {
+        uint16_t pos = port->tx_pos;
+        LL_USART_TransmitData8(uart, port->tx_data[pos++]);
+        port->tx_pos = pos;
+        if (pos == port->tx_len) {
+            LL_USART_DisableIT_TXE(uart);
+            LL_USART_EnableIT_TC(uart);
+        }
+    }
+    
+    if (LL_USART_IsEnabledIT_TC(uart) && LL_USART_IsActiveFlag_TC(uart)) {
+        LL_USART_DisableIT_TC(uart);
+        port->tx_busy = false;
+        Modbus_TxCallback(hmodbus);
+    }
+}
+
+/* ============================================================================
+ *                              传输层接口实现
+ * ============================================================================ */
+
+/**
+ * @brief   启动接收
+ * @note    先置 rx_size = 0 停止写入，再切换缓冲区，中断不会写入更换中的缓冲区
+ */
+static bool ModbusLL_StartRx(const ModbusHandle_t *hmodbus, uint8_t *buf, uint16_t size) {
+    ModbusLL_Port_t *port = (ModbusLL_Port_t *)Modbus_GetTransportCtx(hmodbus);
+    
+    port->rx_size = 0;
+    port->rx_buf = buf;
+    port->rx_count = 0;
+    port->rx_size = size;
+    return true;
+}
+
+/**
+ * @brief   本次接收已收到的字节数
+ */
+static uint16_t ModbusLL_RxCount(const ModbusHandle_t *hmodbus) {
+    const ModbusLL_Port_t *port = (const ModbusLL_Port_t *)Modbus_GetTransportCtx(hmodbus);
+    return port->rx_count;
+}
+
+/**
+ * @brief   启动中断发送
+ * @note    写入首字节即清除TC (USART v1需先读SR)，此处显式清除以免沿用上一帧的TC
+ */
+static bool ModbusLL_Send(const ModbusHandle_t *hmodbus, const uint8_t *data, uint16_t len) {
+    ModbusLL_Port_t *port = (ModbusLL_Port_t *)Modbus_GetTransportCtx(hmodbus);
+    
+    if (port->tx_busy || len == 0) {
+        return false;
+    }
+    
+    port->tx_data = data;
+    port->tx_len = len;
+    port->tx_pos = 0;
+    port->tx_busy = true;
+    LL_USART_ClearFlag_TC(port->uart);
+    LL_USART_EnableIT_TXE(port->uart);
+    return true;
+}
+
+/**
+ * @brief   切换RS485收发方向 (按 rs485 配置经BSRR写DE引脚)
+ */
+static void ModbusLL_SetDirection(const ModbusHandle_t *hmodbus, bool tx) {
+    const Modbus_RS485Config_t *rs485 = &hmodbus->rs485;
+    
+    if (rs485->de_port == NULL) {
+        return;
+    }
+    
+    /* BSRR低16位置位、高16位复位 */
+    bool high = (tx == rs485->de_polarity);
+    rs485->de_port->BSRR = high ? (uint32_t)rs485->de_pin : ((uint32_t)rs485->de_pin << 16);
+}
+
+/**
+ * @brief   微秒时基: HAL节拍(ms) + SysTick当前节拍内已计数的部分
+ * @note    读取期间SysTick回绕而节拍中断尚未执行(中断中调用且优先级更高)时补计1ms;
+ *          节拍 x 1000 按32位回绕，差值运算仍然正确
+ */
+static uint32_t ModbusLL_NowUs(const ModbusHandle_t *hmodbus) {
+    (void)hmodbus;
+    
+    uint32_t ms;
+    uint32_t val;
+    do {
+        ms = HAL_GetTick();
+        val = SysTick->VAL;
+    } while (ms != HAL_GetTick());
+    if ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0U) {
+        val = SysTick->VAL;
+        ms++;
+    }
+    
+    uint32_t load = SysTick->LOAD + 1U;
+    uint32_t per_us = load / 1000U;
+    if (per_us == 0) {
+        return ms * 1000U;
+    }
+    
+    uint32_t us = (load - 1U - val) / per_us;
+    return ms * 1000U + ((us < 1000U) ? us : 999U);
+}
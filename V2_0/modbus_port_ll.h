@@ -0,0 +1,100 @@
+/**
+ * @file    modbus_port_ll.h
+ * @brief   Modbus从站协议栈 STM32 LL 传输层 (可选)
+ * @version 2.0.0
+ * @date    2025
+ *
+ * @details 以LL驱动直接读写USART寄存器，替代HAL UART的接收/发送路径 (Modbus_Transport_t):
+ *          1. 每个接收字节在中断中只做一次读数据寄存器与写缓冲区，无HAL锁、状态机与回调间接调用
+ *          2. 空闲线中断即帧结束，直接调用 Modbus_RxCallback()
+ *          3. 发送由TXE中断逐字节送出，TC中断(最后一个字节完全移出)时调用 Modbus_TxCallback()
+ *          4. RS485 DE引脚经BSRR直接切换，微秒时基由SysTick推算 (帧间隔按t3.5精确计时)
+ *
+ * @note    需在CubeMX中将该USART的驱动选为LL (main.h 包含 stm32xxxx_ll_usart.h)，
+ *          波特率/帧格式由 MX_USARTx_UART_Init() 配置，并使能USART全局中断(NVIC)
+ *          仅支持中断乒乓接收与空闲线定界 (见 Modbus_Transport_t)
+ *          SysTick需为HAL时基且节拍为1ms (默认配置)
+ */
+
+#ifndef __MODBUS_PORT_LL_H
+#define __MODBUS_PORT_LL_H
+
+#include "modbus_slave.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if !defined(LL_USART_DIRECTION_TX_RX)
+#error "modbus_port_ll requires the STM32 LL USART driver (stm32xxxx_ll_usart.h included from main.h)"
+#endif
+
+/* ============================================================================
+ *                              数据结构定义
+ * ============================================================================ */
+
+/**
+ * @brief   LL传输层端口状态 (每个USART一个, 作为 Modbus_Config_t.transport_ctx)
+ * @note    由 ModbusLL_Init() 初始化，用户不应直接修改
+ */
+typedef struct {
+    USART_TypeDef      *uart;         /**< USART外设 */
+    
+    uint8_t * volatile  rx_buf;       /**< 当前接收缓冲区 */
+    volatile uint16_t   rx_size;      /**< 本次接收的最大字节数 (0=未启动) */
+    volatile uint16_t   rx_count;     /**< 本次接收已收到的字节数 */
+    
+    const uint8_t * volatile tx_data; /**< 发送数据 */
+    volatile uint16_t   tx_len;       /**< 发送字节数 */
+    volatile uint16_t   tx_pos;       /**< 已写入数据寄存器的字节数 */
+    volatile bool       tx_busy;      /**< 发送进行中 (至TC) */
+} ModbusLL_Port_t;
+
+/**
+ * @brief   LL传输层接口表 (作为 Modbus_Config_t.transport)
+ */
+extern const Modbus_Transport_t ModbusLL_Transport;
+
+/* ============================================================================
+ *                              API函数声明
+ * ============================================================================ */
+
+/**
+ * @brief   初始化LL传输层端口并使能接收/空闲中断
+ * @param   port    端口状态
+ * @param   uart    USART外设 (如USART1, 已由LL初始化并使能)
+ * @retval  true    初始化成功
+ * @retval  false   参数无效
+ *
+ * @note    须在 Modbus_Init() 之前调用; 接收启动前到达的字节被读出并丢弃
+ *
+ * @code
+ *          static ModbusLL_Port_t port1;
+ *          ModbusLL_Init(&port1, USART1);
+ *          config.transport     = &ModbusLL_Transport;
+ *          config.transport_ctx = &port1;
+ *          Modbus_Init(&hModbus1, &config);
+ * @endcode
+ */
+bool ModbusLL_Init(ModbusLL_Port_t *port, USART_TypeDef *uart);
+
+/**
+ * @brief   USART中断处理 (替代 HAL_UART_IRQHandler())
+ * @param   hmodbus 使用LL传输层的Modbus句柄
+ *
+ * @note    完成接收、空闲线帧结束、逐字节发送与发送完成处理，
+ *          启用 incremental_crc 时每个字节到达即计入滚动CRC; 溢出计入 bus_overrun 统计
+ *
+ * @code
+ *          void USART1_IRQHandler(void) {
+ *              ModbusLL_IRQHandler(&hModbus1);
+ *          }
+ * @endcode
+ */
+void ModbusLL_IRQHandler(ModbusHandle_t *hmodbus);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MODBUS_PORT_LL_H */
@@ -0,0 +1,82 @@
+/**
+ * @file    modbus_profile.h
+ * @brief   Modbus从站协议栈编译期配置档 (可选, 以 -DMODBUS_PROFILE=1 启用)
+ * @version 2.0.0
+ * @date    2025
+ * 
+ * @details 面向单实例、Flash较小的芯片，在编译期固定以下配置，API与运行时配置版本相同:
+ *          1. 寄存器布局: 段表以X宏列出，地址范围与段数在编译期确定，data_map 被忽略
+ *          2. 功能码裁剪: MODBUS_FC_xx_ENABLED 等宏，未编入的功能码返回非法功能码异常
+ *          3. CRC后端: 直接调用所选算法，其他算法及其查找表不再编入
+ *          4. 发送方式: 阻塞或异步发送的分支在编译期确定
+ *          已固定的项在 Modbus_Config_t 中对应的字段被忽略，未设置的项保持运行时配置
+ * 
+ * @note    本文件由 modbus_slave.h 在其他宏定义之前包含，按项目需要修改;
+ *          段表引用的数据数组须在此声明，由应用定义
+ */
+
+#ifndef __MODBUS_PROFILE_H
+#define __MODBUS_PROFILE_H
+
+/* ============================================================================
+ *                              数据区 (由应用定义)
+ * ============================================================================ */
+
+extern uint8_t  app_coils[2];             /* 线圈 0~15 (位压缩存储) */
+extern uint16_t app_holding_regs[32];     /* 保持寄存器 0~31 */
+extern uint16_t app_param_regs[8];        /* 保持寄存器 1000~1007 (参数区) */
+extern uint16_t app_input_regs[16];       /* 输入寄存器 0~15 */
+
+/* ============================================================================
+ *                              寄存器布局
+ * ============================================================================ */
+
+/**
+ * @brief   各数据区段表: X(起始地址, 数量, 数据数组, 段属性 MODBUS_SEG_xxx)
+ * @note    同一数据区的段按起始地址升序排列且互不重叠，单次请求须完整落在一个段内;
+ *          不需要的数据区不定义 (或删除该宏)，其功能码返回非法数据地址异常
+ */
+#define MODBUS_PROFILE_COILS(X) \
+    X(0,    16, app_coils,        0)
+
+#define MODBUS_PROFILE_HOLDING(X) \
+    X(0,    32, app_holding_regs, 0) \
+    X(1000,  8, app_param_regs,   0)
+
+#define MODBUS_PROFILE_INPUT(X) \
+    X(0,    16, app_input_regs,   MODBUS_SEG_READONLY)
+
+/* ============================================================================
+ *                              CRC与发送方式
+ * ============================================================================ */
+
+/**
+ * @brief   CRC后端
+ * @arg     MODBUS_PROFILE_CRC_SHIFT:    移位法 (代码最小)
+ * @arg     MODBUS_PROFILE_CRC_TABLE:    256项查表法 (最快, 512B ROM)
+ * @arg     MODBUS_PROFILE_CRC_NIBBLE:   16项半字节查表法 (32B ROM)
+ * @arg     MODBUS_PROFILE_CRC_HARDWARE: 硬件CRC外设 (仍需 hw_crc.hcrc)
+ * @arg     MODBUS_PROFILE_RUNTIME:      由 crc_mode 运行时选择 (含自定义CRC)
+ */
+#define MODBUS_PROFILE_CRC           MODBUS_PROFILE_CRC_TABLE
+
+/**
+ * @brief   发送方式
+ * @arg     MODBUS_PROFILE_TX_BLOCKING: 阻塞发送
+ * @arg     MODBUS_PROFILE_TX_ASYNC:    DMA发送 (或 transport 异步发送)
+ * @arg     MODBUS_PROFILE_RUNTIME:     由 use_dma_tx 运行时选择
+ */
+#define MODBUS_PROFILE_TX            MODBUS_PROFILE_TX_BLOCKING
+
+/* ============================================================================
+ *                              功能码与资源裁剪
+ * ============================================================================ */
+
+#define MODBUS_STATS_ENABLED         0       /* 同时裁剪0x08诊断 */
+#define MODBUS_FC_02_ENABLED         0       /* 无离散输入 */
+#define MODBUS_FC_16_ENABLED         0
+#define MODBUS_FC_17_ENABLED         0
+#define MODBUS_FC_64_ENABLED         0
+#define MODBUS_MAX_INSTANCES         1
+
+#endif /* __MODBUS_PROFILE_H */
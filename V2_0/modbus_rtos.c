@@ -0,0 +1,165 @@
+/**
+ * @file    modbus_rtos.c
+ * @brief   Modbus从站协议栈 CMSIS-RTOS2 端口实现
+ * @version 2.0.0
+ * @date    2025
+ * 
+ * @details 本文件实现:
+ *          - 线程标志驱动的工作任务 (无轮询，无osDelay)
+ *          - 注册表槽位到工作任务的静态分配 (槽位 % 任务数)，同一实例不会被并发处理;
+ *            启动时校验网关上下游实例分配到同一任务，互相访问的实例同样不会被并发处理
+ *          - 排队响应等待帧间隔期间以1节拍超时等待，其余时间永久阻塞
+ *          - 递归互斥锁保护data_map (优先级继承)
+ */
+
+#include "modbus_rtos.h"
+#include <stdint.h>
+
+/* ============================================================================
+ *                              端口状态
+ * ============================================================================ */
+
+static osThreadId_t s_workers[MODBUS_RTOS_MAX_WORKERS];   /**< 工作任务句柄 */
+static volatile uint8_t s_worker_count;                   /**< 已创建的工作任务数 (0=未启动) */
+static osMutexId_t s_data_mutex;                          /**< 数据区互斥锁 */
+
+/* ============================================================================
+ *                              内部函数
+ * ============================================================================ */
+
+/**
+ * @brief   工作任务主体
+ * @param   argument 工作任务序号
+ * 
+ * @note    首次运行不等待，先处理启动前已就绪的实例
+ */
+static void ModbusRTOS_Worker(void *argument) {
+    uint32_t index = (uint32_t)(uintptr_t)argument;
+    uint32_t count = s_worker_count;
+    uint32_t slot_mask = 0;
+    
+    for (uint32_t slot = index; slot < 32U; slot += count) {
+        slot_mask |= 1UL << slot;
+    }
+    
+    uint32_t timeout = 0;
+    for (;;) {
+        (void)osThreadFlagsWait(MODBUS_RTOS_FLAG_READY, osFlagsWaitAny, timeout);
+        
+        /* 有排队响应等待t3.5帧间隔时按节拍复查，否则阻塞至下一次通知 */
+        timeout = Modbus_ProcessReady(slot_mask) ? 1U : osWaitForever;
+    }
+}
+
+/* ============================================================================
+ *                              API函数实现
+ * ============================================================================ */
+
+/**
+ * @brief   创建数据区互斥锁与工作任务
+ */
+bool ModbusRTOS_Start(const ModbusRTOS_Config_t *config) {
+    if (s_worker_count != 0 || s_data_mutex != NULL) {
+        return false;
+    }
+    
+    uint32_t count = 1;
+    uint32_t stack_size = MODBUS_RTOS_STACK_SIZE;
+    osPriority_t priority = osPriorityHigh;
+    
+    if (config != NULL) {
+        if (config->worker_count != 0) {
+            count = config->worker_count;
+        }
+        if (config->stack_size != 0) {
+            stack_size = config->stack_size;
+        }
+        if (config->priority != osPriorityNone) {
+            priority = config->priority;
+        }
+    }
+    if (count > MODBUS_RTOS_MAX_WORKERS) {
+        count = MODBUS_RTOS_MAX_WORKERS;
+    }
+    
+    /* 网关上下游分属不同任务时转发与应答会并发读写对方的发送队列 */
+    if (count > 1 && !Modbus_RoutesGrouped(count)) {
+        return false;
+    }
+    
+    const osMutexAttr_t mutex_attr = {
+        .name = "modbus_data",
+        .attr_bits = osMutexRecursive | osMutexPrioInherit,
+    };
+    s_data_mutex = osMutexNew(&mutex_attr);
+    if (s_data_mutex == NULL) {
+        return false;
+    }
+    
+    /* 先发布任务数再创建任务: 任务内按该值计算所属槽位 */
+    s_worker_count = (uint8_t)count;
+    
+    const osThreadAttr_t thread_attr = {
+        .name = "modbus",
+        .stack_size = stack_size,
+        .priority = priority,
+    };
+    for (uint32_t i = 0; i < count; i++) {
+        s_workers[i] = osThreadNew(ModbusRTOS_Worker, (void *)(uintptr_t)i, &thread_attr);
+        if (s_workers[i] == NULL) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+/**
+ * @brief   帧就绪通知回调
+ */
+void ModbusRTOS_ReadyCallback(ModbusHandle_t *hmodbus) {
+    uint32_t count = s_worker_count;
+    
+    /* 未启动或未登记: 就绪位保留在注册表中，由任务首次运行时处理 */
+    if (count == 0 || hmodbus->registry_slot >= MODBUS_MAX_INSTANCES) {
+        return;
+    }
+    
+    osThreadId_t worker = s_workers[hmodbus->registry_slot % count];
+    if (worker != NULL) {
+        (void)osThreadFlagsSet(worker, MODBUS_RTOS_FLAG_READY);
+    }
+}
+
+/**
+ * @brief   数据区加锁回调
+ */
+void ModbusRTOS_LockCallback(ModbusHandle_t *hmodbus, bool lock) {
+    (void)hmodbus;
+    
+    if (lock) {
+        (void)ModbusRTOS_DataLock(osWaitForever);
+    } else {
+        ModbusRTOS_DataUnlock();
+    }
+}
+
+/**
+ * @brief   应用任务访问data_map前加锁
+ */
+bool ModbusRTOS_DataLock(uint32_t timeout) {
+    if (s_data_mutex == NULL) {
+        return false;
+    }
+    
+    return osMutexAcquire(s_data_mutex, timeout) == osOK;
+}
+
+/**
+ * @brief   应用任务访问data_map后解锁
+ */
+void ModbusRTOS_DataUnlock(void) {
+    if (s_data_mutex != NULL) {
+        (void)osMutexRelease(s_data_mutex);
+    }
+}
@@ -0,0 +1,128 @@
+/**
+ * @file    modbus_rtos.h
+ * @brief   Modbus从站协议栈 CMSIS-RTOS2 端口 (可选)
+ * @version 2.0.0
+ * @date    2025
+ * 
+ * @details 以事件驱动替代主循环轮询 Modbus_Process():
+ *          1. 接收完成中断经 ready_cb 置位工作任务的线程标志，任务阻塞等待、即时唤醒
+ *          2. 可创建1~MODBUS_RTOS_MAX_WORKERS个工作任务，实例按注册表槽位固定分配 (网关上下游须同属一个任务)
+ *          3. 提供递归互斥锁保护data_map，应用任务与协议栈可并发访问同一份数据
+ * 
+ * @note    依赖 cmsis_os2.h (FreeRTOS/RTX5等的CMSIS-RTOS2封装) 及多实例注册表
+ *          工作任务优先级应高于应用任务，空闲线中断返回时即切换到工作任务，
+ *          唤醒延迟仅为一次上下文切换 (Cortex-M4 @ 80MHz 约数微秒)
+ */
+
+#ifndef __MODBUS_RTOS_H
+#define __MODBUS_RTOS_H
+
+#include "modbus_slave.h"
+#include "cmsis_os2.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if MODBUS_MAX_INSTANCES == 0
+#error "modbus_rtos requires MODBUS_MAX_INSTANCES > 0"
+#endif
+
+/* ============================================================================
+ *                              端口配置
+ * ============================================================================ */
+
+/**
+ * @brief   最大工作任务数
+ */
+#ifndef MODBUS_RTOS_MAX_WORKERS
+#define MODBUS_RTOS_MAX_WORKERS      4
+#endif
+
+/**
+ * @brief   工作任务默认栈大小 (字节)
+ */
+#ifndef MODBUS_RTOS_STACK_SIZE
+#define MODBUS_RTOS_STACK_SIZE       1024U
+#endif
+
+/**
+ * @brief   工作任务唤醒线程标志
+ */
+#define MODBUS_RTOS_FLAG_READY       0x0001U
+
+/**
+ * @brief   RTOS端口配置结构体
+ */
+typedef struct {
+    uint8_t      worker_count;    /**< 工作任务数 (0按1处理, 上限MODBUS_RTOS_MAX_WORKERS) */
+    uint32_t     stack_size;      /**< 每个工作任务栈大小 (字节, 0=MODBUS_RTOS_STACK_SIZE) */
+    osPriority_t priority;        /**< 工作任务优先级 (osPriorityNone=osPriorityHigh) */
+} ModbusRTOS_Config_t;
+
+/* ============================================================================
+ *                              API函数声明
+ * ============================================================================ */
+
+/**
+ * @brief   创建数据区互斥锁与工作任务
+ * @param   config  端口配置 (可为NULL, 使用默认配置: 1个任务)
+ * @retval  true    启动成功
+ * @retval  false   已启动，网关上下游实例分属不同任务，或互斥锁/任务创建失败
+ * 
+ * @note    须在 osKernelStart() 之前或在任务上下文中调用，只能调用一次
+ *          实例可在启动前或启动后 Modbus_Init()，启动前已到达的帧在任务首次运行时处理
+ *          worker_count 大于1时，配置 bridge 的实例及其路由目标须在启动前全部 Modbus_Init()，
+ *          且注册表槽位对任务数同余 (见 Modbus_RoutesGrouped())，使每条路由两端由同一任务处理;
+ *          启动后初始化的网关实例不再校验，应用须自行保证同余
+ * 
+ * @code
+ *          config.ready_cb = ModbusRTOS_ReadyCallback;
+ *          config.lock_cb  = ModbusRTOS_LockCallback;
+ *          Modbus_Init(&hModbus1, &config);
+ * 
+ *          ModbusRTOS_Config_t rtos_cfg = { .worker_count = 1, .priority = osPriorityHigh };
+ *          ModbusRTOS_Start(&rtos_cfg);
+ *          osKernelStart();
+ * @endcode
+ */
+bool ModbusRTOS_Start(const ModbusRTOS_Config_t *config);
+
+/**
+ * @brief   帧就绪通知回调 (填入 Modbus_Config_t.ready_cb)
+ * @param   hmodbus Modbus句柄指针
+ * 
+ * @note    在中断上下文中由协议栈调用，置位该实例所属工作任务的线程标志
+ */
+void ModbusRTOS_ReadyCallback(ModbusHandle_t *hmodbus);
+
+/**
+ * @brief   数据区加锁回调 (填入 Modbus_Config_t.lock_cb)
+ * @param   hmodbus Modbus句柄指针
+ * @param   lock    true=加锁, false=解锁
+ * 
+ * @note    所有实例共用同一把互斥锁 (多个串口共享同一份寄存器数据)
+ *          互斥锁为递归锁，write_cb/custom_config_cb 内可再次调用 ModbusRTOS_DataLock()
+ */
+void ModbusRTOS_LockCallback(ModbusHandle_t *hmodbus, bool lock);
+
+/**
+ * @brief   应用任务访问data_map前加锁
+ * @param   timeout 等待时间 (RTOS节拍, osWaitForever=一直等待)
+ * @retval  true    加锁成功
+ * @retval  false   超时或端口未启动
+ * 
+ * @warning 不可在中断中调用; 持锁期间协议栈无法处理请求，应尽快释放
+ */
+bool ModbusRTOS_DataLock(uint32_t timeout);
+
+/**
+ * @brief   应用任务访问data_map后解锁
+ */
+void ModbusRTOS_DataUnlock(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MODBUS_RTOS_H */
@@ -6,22 +6,104 @@
  * 
  * @details 本文件实现Modbus RTU从站核心功能:
  *          - 多实例支持，无全局变量
- *          - 乒乓缓冲接收机制
+ *          - 乒乓缓冲接收机制 / 循环DMA环形接收
+ *          - 空闲线 / 接收超时(RTOR) / 定时器 t1.5/t3.5 帧定界
  *          - 动态超时计算
- *          - 可选CRC查表法/移位法
+ *          - 可插拔CRC后端 (移位法/查表法/半字节查表法/硬件CRC/自定义)
  *          - 可选DMA/阻塞发送
+ *          - 多实例注册表: O(1) UART查表分发与就绪位图 (可裁剪)
  */
 
 #include "modbus_slave.h"
 #include <string.h>
 
+/* ============================================================================
+ *                              编译期配置档
+ * ============================================================================ */
+
+/** @brief 该CRC后端是否编入 (配置档固定后端时只编入该后端及其查找表) */
+#define MODBUS_CRC_BUILTIN(mode)     (MODBUS_PROFILE_CRC == MODBUS_PROFILE_RUNTIME || MODBUS_PROFILE_CRC == (mode))
+
+/** @brief 计算CRC: 配置档固定后端时直接调用 (可内联)，否则经初始化时绑定的函数指针 */
+#if MODBUS_PROFILE_CRC == MODBUS_PROFILE_CRC_SHIFT
+#define MODBUS_PROFILE_CRC_FUNC      Modbus_CRC16_Shift
+#elif MODBUS_PROFILE_CRC == MODBUS_PROFILE_CRC_TABLE
+#define MODBUS_PROFILE_CRC_FUNC      Modbus_CRC16_Table
+#elif MODBUS_PROFILE_CRC == MODBUS_PROFILE_CRC_NIBBLE
+#define MODBUS_PROFILE_CRC_FUNC      Modbus_CRC16_Nibble
+#elif MODBUS_PROFILE_CRC == MODBUS_PROFILE_CRC_HARDWARE
+#define MODBUS_PROFILE_CRC_FUNC      Modbus_CRC16_Hardware
+#endif
+
+#ifdef MODBUS_PROFILE_CRC_FUNC
+#define MODBUS_CRC_CALL(h, crc, buf, len)  MODBUS_PROFILE_CRC_FUNC((h), (crc), (buf), (len))
+#else
+#define MODBUS_CRC_CALL(h, crc, buf, len)  ((h)->crc_func((h), (crc), (buf), (len)))
+#endif
+
+/** @brief 响应异步发送 (DMA或传输层): 配置档固定发送方式时为常量 */
+#if MODBUS_PROFILE_TX == MODBUS_PROFILE_TX_BLOCKING
+#define MODBUS_ASYNC_TX(h)           false
+#elif MODBUS_PROFILE_TX == MODBUS_PROFILE_TX_ASYNC
+#define MODBUS_ASYNC_TX(h)           true
+#else
+#define MODBUS_ASYNC_TX(h)           ((h)->use_dma_tx)
+#endif
+
+#if MODBUS_PROFILE_LAYOUT
+
+/** @brief 段表宏展开: 段表项 / 计数 */
+#define MODBUS_PROFILE_SEG(base_, count_, data_, flags_) \
+    { .base = (base_), .count = (count_), .data = (data_), .flags = (flags_) },
+#define MODBUS_PROFILE_SEG_ONE(base_, count_, data_, flags_)  + 1U
+
+#define MODBUS_PROFILE_N_COILS       (0U MODBUS_PROFILE_COILS(MODBUS_PROFILE_SEG_ONE))
+#define MODBUS_PROFILE_N_DISCRETE    (0U MODBUS_PROFILE_DISCRETE(MODBUS_PROFILE_SEG_ONE))
+#define MODBUS_PROFILE_N_HOLDING     (0U MODBUS_PROFILE_HOLDING(MODBUS_PROFILE_SEG_ONE))
+#define MODBUS_PROFILE_N_INPUT       (0U MODBUS_PROFILE_INPUT(MODBUS_PROFILE_SEG_ONE))
+
+#if MODBUS_PROFILE_N_COILS + MODBUS_PROFILE_N_DISCRETE + MODBUS_PROFILE_N_HOLDING + MODBUS_PROFILE_N_INPUT == 0
+#error "MODBUS_PROFILE layout lists no segments"
+#endif
+
+/** @brief 编译期段表: 按数据区依次排列 */
+static const Modbus_Segment_t s_profile_segs[] = {
+    MODBUS_PROFILE_COILS(MODBUS_PROFILE_SEG)
+    MODBUS_PROFILE_DISCRETE(MODBUS_PROFILE_SEG)
+    MODBUS_PROFILE_HOLDING(MODBUS_PROFILE_SEG)
+    MODBUS_PROFILE_INPUT(MODBUS_PROFILE_SEG)
+};
+
+/** @brief 各数据区在段表中的起始序号与段数 */
+static const uint8_t s_profile_seg_first[MODBUS_AREA_COUNT] = {
+    0U,
+    MODBUS_PROFILE_N_COILS,
+    MODBUS_PROFILE_N_COILS + MODBUS_PROFILE_N_DISCRETE,
+    MODBUS_PROFILE_N_COILS + MODBUS_PROFILE_N_DISCRETE + MODBUS_PROFILE_N_HOLDING
+};
+static const uint8_t s_profile_seg_count[MODBUS_AREA_COUNT] = {
+    MODBUS_PROFILE_N_COILS, MODBUS_PROFILE_N_DISCRETE, MODBUS_PROFILE_N_HOLDING, MODBUS_PROFILE_N_INPUT
+};
+
+/** @brief 数据区段表与段数: 编译期布局时为常量，段数为0的数据区整段处理被消除 */
+#define MODBUS_SEG_TABLE(h, area)    ((void)(h), &s_profile_segs[s_profile_seg_first[area]])
+#define MODBUS_SEG_COUNT(h, area)    ((void)(h), s_profile_seg_count[area])
+
+#else
+
+#define MODBUS_SEG_TABLE(h, area)    ((h)->area_segs[area])
+#define MODBUS_SEG_COUNT(h, area)    ((h)->area_seg_count[area])
+
+#endif
+
 /* ============================================================================
  *                              CRC16查找表
  * ============================================================================ */
 
+#if MODBUS_CRC_BUILTIN(MODBUS_PROFILE_CRC_TABLE)
 /**
  * @brief   CRC16-Modbus查找表 (512字节)
- * @note    仅在 use_crc_table = true 时使用
+ * @note    仅在 crc_mode = MODBUS_CRC_TABLE 时使用
  */
 static const uint16_t CRC16_TABLE[256] = {
     0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241,
@@ -57,16 +139,328 @@ static const uint16_t CRC16_TABLE[256] = {
     0x4400, 0x84C1, 0x8581, 0x4540, 0x8701, 0x47C0, 0x4680, 0x8641,
     0x8201, 0x42C0, 0x4380, 0x8341, 0x4100, 0x81C1, 0x8081, 0x4040
 };
+#endif
+
+#if MODBUS_CRC_BUILTIN(MODBUS_PROFILE_CRC_NIBBLE)
+/**
+ * @brief   CRC16-Modbus半字节查找表 (32字节)
+ * @note    仅在 crc_mode = MODBUS_CRC_NIBBLE 时使用
+ *          每字节查表2次，适用于Flash紧张的芯片
+ */
+static const uint16_t CRC16_NIBBLE_TABLE[16] = {
+    0x0000, 0xCC01, 0xD801, 0x1400, 0xF001, 0x3C00, 0x2800, 0xE401,
+    0xA001, 0x6C00, 0x7800, 0xB401, 0x5000, 0x9C01, 0x8801, 0x4400
+};
+#endif
+
+/* ============================================================================
+ *                              内部常量定义
+ * ============================================================================ */
+
+/** @brief 硬件CRC默认DMA送数阈值 (字节), 短帧使用CPU写入更快 */
+#define MODBUS_HW_CRC_DMA_THRESHOLD  64
+
+/** @brief 硬件CRC DMA送数超时 (ms) */
+#define MODBUS_HW_CRC_DMA_TIMEOUT    10
+
+/** @brief 增量CRC判定结果 */
+#define MODBUS_RX_CRC_UNKNOWN        0   /**< 未计算 (增量CRC未启用) */
+#define MODBUS_RX_CRC_OK             1   /**< 校验正确 */
+#define MODBUS_RX_CRC_FAIL           2   /**< 校验错误 */
+#define MODBUS_RX_FRAME_GAP          3   /**< 帧内字符间隔超过t1.5 (严格定时模式) */
+
+/** @brief 高于此波特率时t1.5/t3.5使用固定值 (Modbus over Serial Line 2.5.1.1) */
+#define MODBUS_FIXED_TIMING_BAUD     19200U
+#define MODBUS_T15_FIXED_US          750U
+#define MODBUS_T35_FIXED_US          1750U
+
+/** @brief 流水线发送阶段 */
+#define MODBUS_TX_PIPE_IDLE          0   /**< 未使用流水线 */
+#define MODBUS_TX_PIPE_HEADER        1   /**< 帧头发送中 */
+#define MODBUS_TX_PIPE_HEADER_DONE   2   /**< 帧头已发完，等待数据部分 */
+
+/** @brief 第 idx 个发送槽的起始地址 */
+#define MODBUS_TX_SLOT(h, idx)       (&(h)->tx_pool[(uint32_t)(idx) * (h)->tx_buf_size])
+
+/** @brief 流水线发送的帧头长度 (从站地址 + 功能码 + 字节数) */
+#define MODBUS_TX_PIPE_HEADER_LEN    3
+
+/** @brief 编入的内置功能码中含数据区写入 (写入辅助函数随之编入) */
+#define MODBUS_FC_ANY_WRITE          (MODBUS_FC_05_ENABLED || MODBUS_FC_06_ENABLED || MODBUS_FC_0F_ENABLED || \
+                                      MODBUS_FC_10_ENABLED || MODBUS_FC_16_ENABLED || MODBUS_FC_17_ENABLED)
+
+/** @brief 编入的内置功能码中含经 Modbus_MapFetch() 的数据区读取 */
+#define MODBUS_FC_ANY_FETCH          (MODBUS_FC_01_ENABLED || MODBUS_FC_02_ENABLED || MODBUS_FC_03_ENABLED || \
+                                      MODBUS_FC_04_ENABLED || MODBUS_FC_16_ENABLED || MODBUS_FC_17_ENABLED)
+
+/** @brief 统计计数器自增 (统计裁剪时为空操作) */
+#if MODBUS_STATS_ENABLED
+#define MODBUS_STAT_INC(h, field)    ((h)->stats.field++)
+#else
+#define MODBUS_STAT_INC(h, field)    ((void)0)
+#endif
+
+/** @brief 数据版本: 数据区经协议栈或应用修改时递增，响应缓存项按此判定失效 */
+static volatile uint32_t s_data_generation;
+
+/* ============================================================================
+ *                              多实例注册表
+ * ============================================================================ */
+
+#if MODBUS_MAX_INSTANCES > 0
+
+/** @brief 散列表大小 (2的幂, 不少于实例数的2倍) */
+#define MODBUS_REGISTRY_HASH_SIZE    32U
+
+/**
+ * @brief   由USART外设地址计算散列键
+ * @note    STM32的USART/UART外设地址按1KB对齐，取地址[14:10]位即可区分同一总线上的外设
+ */
+#define MODBUS_REGISTRY_HASH(inst)   ((uint32_t)(((uintptr_t)(inst) >> 10) & (MODBUS_REGISTRY_HASH_SIZE - 1U)))
+
+/**
+ * @brief   注册表槽
+ */
+typedef struct {
+    const void          *instance; /**< USART外设或传输层上下文 (查表键) */
+    ModbusHandle_t      *handle;   /**< 对应的Modbus实例 */
+} Modbus_RegistrySlot_t;
+
+static Modbus_RegistrySlot_t s_registry_slots[MODBUS_MAX_INSTANCES];          /**< 稠密实例槽 */
+static uint8_t               s_registry_count;                                /**< 已登记实例数 */
+static uint8_t               s_registry_hash[MODBUS_REGISTRY_HASH_SIZE];      /**< 散列表: 槽序号+1 (0=空) */
+static volatile uint32_t     s_registry_ready;                                /**< 就绪位图: 第n位对应第n槽 */
+
+#endif
 
 /* ============================================================================
  *                              内部函数声明
  * ============================================================================ */
 
 static uint16_t Modbus_CRC16(const ModbusHandle_t *hmodbus, const uint8_t *buffer, uint16_t length);
+static uint16_t Modbus_FrameCRC16(const ModbusHandle_t *hmodbus, const Modbus_Frame_t *frame, uint16_t length);
+#if MODBUS_CRC_BUILTIN(MODBUS_PROFILE_CRC_SHIFT)
+static uint16_t Modbus_CRC16_Shift(const ModbusHandle_t *hmodbus, uint16_t crc, const uint8_t *buffer, uint16_t length);
+#endif
+#if MODBUS_CRC_BUILTIN(MODBUS_PROFILE_CRC_TABLE)
+static uint16_t Modbus_CRC16_Table(const ModbusHandle_t *hmodbus, uint16_t crc, const uint8_t *buffer, uint16_t length);
+#endif
+#if MODBUS_CRC_BUILTIN(MODBUS_PROFILE_CRC_NIBBLE)
+static uint16_t Modbus_CRC16_Nibble(const ModbusHandle_t *hmodbus, uint16_t crc, const uint8_t *buffer, uint16_t length);
+#endif
+#if MODBUS_HW_CRC_SUPPORTED && MODBUS_CRC_BUILTIN(MODBUS_PROFILE_CRC_HARDWARE)
+static uint16_t Modbus_CRC16_Hardware(const ModbusHandle_t *hmodbus, uint16_t crc, const uint8_t *buffer, uint16_t length);
+#endif
+static void Modbus_RxCrcUpdate(ModbusHandle_t *hmodbus, const uint8_t *buffer, uint16_t received);
+static void Modbus_RxRingCrcUpdate(ModbusHandle_t *hmodbus, uint16_t pos);
+static void Modbus_RxRingEvent(ModbusHandle_t *hmodbus, uint16_t size);
+static void Modbus_RxRingFrameEnd(ModbusHandle_t *hmodbus, uint16_t pos);
+static void Modbus_RxFrameComplete(ModbusHandle_t *hmodbus, uint16_t size);
+static void Modbus_RxFrameGet(const ModbusHandle_t *hmodbus, Modbus_Frame_t *frame);
+static bool Modbus_RxAddrMatch(const ModbusHandle_t *hmodbus, uint8_t addr);
+static bool Modbus_RxAddrLocal(const ModbusHandle_t *hmodbus, uint8_t addr);
+#if MODBUS_MUTE_SUPPORTED
+static void Modbus_RxMute(ModbusHandle_t *hmodbus);
+#endif
+static void Modbus_RxPublish(ModbusHandle_t *hmodbus);
+static bool Modbus_FastPath(ModbusHandle_t *hmodbus);
+static void Modbus_ProcessFrame(ModbusHandle_t *hmodbus);
+static uint16_t Modbus_Dispatch(ModbusHandle_t *hmodbus, const Modbus_Frame_t *frame, uint16_t rx_len,
+                                uint8_t *tx, uint16_t tx_size);
+static bool Modbus_CrcSetup(ModbusHandle_t *hmodbus, const Modbus_Config_t *config);
+static void Modbus_CommonSetup(ModbusHandle_t *hmodbus, const Modbus_Config_t *config);
+static bool Modbus_BridgeSetup(ModbusHandle_t *hmodbus, const Modbus_BridgeConfig_t *bridge);
+static ModbusHandle_t *Modbus_BridgeTarget(const ModbusHandle_t *hmodbus, uint8_t addr);
+static bool Modbus_BridgeBusy(const ModbusHandle_t *hmodbus);
+static void Modbus_BridgeForward(ModbusHandle_t *hmodbus, const Modbus_Frame_t *frame, uint16_t rx_len);
+static void Modbus_BridgeReply(ModbusHandle_t *hmodbus, const Modbus_Frame_t *frame, uint16_t rx_len);
+static void Modbus_BridgePoll(ModbusHandle_t *hmodbus);
+static uint8_t *Modbus_BridgeSlot(ModbusHandle_t *hmodbus);
+static bool Modbus_CacheSetup(ModbusHandle_t *hmodbus, const Modbus_RespCacheConfig_t *cache);
+static bool Modbus_CacheCacheable(uint8_t func_code, uint16_t rx_len);
+static Modbus_RespCacheEntry_t *Modbus_CacheFind(ModbusHandle_t *hmodbus, uint8_t func_code,
+                                                 uint16_t start, uint16_t quantity);
+static bool Modbus_CacheReplay(ModbusHandle_t *hmodbus, const Modbus_Frame_t *frame, uint32_t generation);
+static void Modbus_CacheStore(ModbusHandle_t *hmodbus, const Modbus_Frame_t *frame, uint32_t generation);
+static void Modbus_BridgeException(ModbusHandle_t *origin, uint8_t addr, uint8_t func_code, uint8_t exception_code);
+static uint16_t Modbus_RxPosition(const ModbusHandle_t *hmodbus);
+static void Modbus_RxFrameTimeout(ModbusHandle_t *hmodbus);
+static void Modbus_FramingSetup(ModbusHandle_t *hmodbus);
+static void Modbus_FramingIdle(ModbusHandle_t *hmodbus, uint16_t pos);
+#if defined(HAL_TIM_MODULE_ENABLED)
+static void Modbus_FramingTimerStart(const ModbusHandle_t *hmodbus, uint32_t us);
+#endif
 static void Modbus_SendResponse(ModbusHandle_t *hmodbus, uint16_t len);
+static void Modbus_SendFrame(ModbusHandle_t *hmodbus, uint16_t total_len);
+#if MODBUS_FC_10_ENABLED || MODBUS_FC_17_ENABLED
+static void Modbus_FrameToRegs(const Modbus_Frame_t *frame, uint16_t idx, uint16_t *dst, uint16_t count);
+#endif
+static bool Modbus_MapSetup(ModbusHandle_t *hmodbus);
+static const Modbus_Segment_t *Modbus_MapLookup(const ModbusHandle_t *hmodbus, Modbus_Area_t area,
+                                                uint16_t start, uint16_t quantity, bool write);
+#if MODBUS_FC_ANY_FETCH
+static bool Modbus_MapFetch(ModbusHandle_t *hmodbus, const Modbus_Segment_t *seg, uint16_t start, uint16_t quantity);
+#endif
+static bool Modbus_MapRead(const Modbus_Segment_t *seg, uint8_t *dst, uint16_t start, uint16_t quantity,
+                           bool is_bits, uint32_t attempts);
+#if MODBUS_FC_ANY_WRITE
+static void Modbus_MapWriteBegin(const Modbus_Segment_t *seg);
+static void Modbus_MapWriteEnd(ModbusHandle_t *hmodbus, const Modbus_Segment_t *seg, Modbus_Area_t area,
+                               uint16_t start, uint16_t quantity);
+static void Modbus_CommitRecord(ModbusHandle_t *hmodbus, Modbus_Area_t area, uint16_t start, uint16_t quantity);
+#endif
+static void Modbus_CommitFlush(ModbusHandle_t *hmodbus);
+static void Modbus_CommitPoll(ModbusHandle_t *hmodbus);
+static bool Modbus_EventSetup(ModbusHandle_t *hmodbus, const Modbus_EventQueueConfig_t *queue);
+#if MODBUS_FC_ANY_WRITE || MODBUS_FC_64_ENABLED
+static uint16_t Modbus_WriteCheck(ModbusHandle_t *hmodbus, uint8_t func_code, uint16_t start_addr, uint16_t quantity);
+static void Modbus_EventPublish(ModbusHandle_t *hmodbus);
+#endif
+#if MODBUS_FC_0F_ENABLED
+static void Modbus_FrameToBits(const Modbus_Frame_t *frame, uint16_t idx, uint8_t *dst, uint16_t start, uint16_t count);
+#endif
+static void Modbus_SignalReady(ModbusHandle_t *hmodbus);
+static void Modbus_MarkReady(ModbusHandle_t *hmodbus);
+static void Modbus_DataLock(ModbusHandle_t *hmodbus);
+static void Modbus_DataUnlock(ModbusHandle_t *hmodbus);
+#if MODBUS_MAX_INSTANCES > 0
+static bool Modbus_Register(ModbusHandle_t *hmodbus);
+#endif
+static void Modbus_TxStart(ModbusHandle_t *hmodbus);
+static void Modbus_TxComplete(ModbusHandle_t *hmodbus);
+static void Modbus_TxPoll(ModbusHandle_t *hmodbus);
+#if MODBUS_FC_03_ENABLED || MODBUS_FC_04_ENABLED
+static void Modbus_SendPipelinedHeader(ModbusHandle_t *hmodbus, uint16_t len);
+static void Modbus_SendPipelinedBody(ModbusHandle_t *hmodbus, uint16_t len);
+#endif
 static void Modbus_SendException(ModbusHandle_t *hmodbus, uint8_t func_code, uint8_t exception_code);
+static uint16_t Modbus_ExceptionReply(ModbusHandle_t *hmodbus, uint8_t *tx, uint8_t func_code, uint8_t exception_code);
+static void Modbus_PortStartRx(const ModbusHandle_t *hmodbus, uint8_t *buf, uint16_t size);
+static bool Modbus_PortSend(const ModbusHandle_t *hmodbus, const uint8_t *data, uint16_t len);
+static void Modbus_TimingParseEnd(ModbusHandle_t *hmodbus);
+static void Modbus_TimingTxBegin(ModbusHandle_t *hmodbus);
+static void Modbus_TimingTxEnd(ModbusHandle_t *hmodbus, uint8_t func_code);
+#if MODBUS_STATS_TIMING
+static void Modbus_TimingRecord(ModbusHandle_t *hmodbus, Modbus_Timing_t stage, uint32_t start, uint8_t func_code);
+#endif
 static void Modbus_RS485_SetTxMode(const ModbusHandle_t *hmodbus);
 static void Modbus_RS485_SetRxMode(const ModbusHandle_t *hmodbus);
+#if MODBUS_HW_DE_SUPPORTED
+static void Modbus_RS485_HwDeSetup(const ModbusHandle_t *hmodbus);
+#endif
+#if MODBUS_STOP_WAKE_SUPPORTED
+static void Modbus_StopWakeSetup(const ModbusHandle_t *hmodbus);
+#endif
+#if MODBUS_FC_01_ENABLED || MODBUS_FC_02_ENABLED
+static uint16_t Modbus_FC_ReadBits(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx,
+                                   Modbus_Area_t area);
+#endif
+#if MODBUS_FC_03_ENABLED || MODBUS_FC_04_ENABLED
+static uint16_t Modbus_FC_ReadRegs(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx,
+                                   Modbus_Area_t area);
+#endif
+#if MODBUS_FC_01_ENABLED
+static uint16_t Modbus_FC01_ReadCoils(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx);
+#endif
+#if MODBUS_FC_02_ENABLED
+static uint16_t Modbus_FC02_ReadDiscrete(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx);
+#endif
+#if MODBUS_FC_03_ENABLED
+static uint16_t Modbus_FC03_ReadHolding(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx);
+#endif
+#if MODBUS_FC_04_ENABLED
+static uint16_t Modbus_FC04_ReadInput(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx);
+#endif
+#if MODBUS_FC_05_ENABLED
+static uint16_t Modbus_FC05_WriteCoil(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx);
+#endif
+#if MODBUS_FC_06_ENABLED
+static uint16_t Modbus_FC06_WriteReg(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx);
+#endif
+#if MODBUS_FC_08_ENABLED
+static uint16_t Modbus_FC08_Diagnostics(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx);
+#endif
+#if MODBUS_FC_0F_ENABLED
+static uint16_t Modbus_FC0F_WriteCoils(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx);
+#endif
+#if MODBUS_FC_10_ENABLED
+static uint16_t Modbus_FC10_WriteRegs(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx);
+#endif
+#if MODBUS_FC_16_ENABLED
+static uint16_t Modbus_FC16_MaskWriteReg(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx);
+#endif
+#if MODBUS_FC_17_ENABLED
+static uint16_t Modbus_FC17_ReadWriteRegs(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx);
+#endif
+#if MODBUS_FC_64_ENABLED
+static uint16_t Modbus_FC64_CustomConfig(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx);
+#endif
+
+/* ============================================================================
+ *                              功能码分发表
+ * ============================================================================ */
+
+/**
+ * @brief   功能码分发表: 按功能码直接索引处理函数 (NULL=不支持)
+ * @note    内置功能码按编译开关静态填入，应用层经 Modbus_RegisterFunction() 扩展或覆盖
+ */
+static Modbus_FuncHandler_t s_func_table[MODBUS_FUNC_TABLE_SIZE] = {
+#if MODBUS_FC_01_ENABLED
+    [MB_FUNC_READ_COILS]        = Modbus_FC01_ReadCoils,
+#endif
+#if MODBUS_FC_02_ENABLED
+    [MB_FUNC_READ_DISCRETE]     = Modbus_FC02_ReadDiscrete,
+#endif
+#if MODBUS_FC_03_ENABLED
+    [MB_FUNC_READ_HOLDING]      = Modbus_FC03_ReadHolding,
+#endif
+#if MODBUS_FC_04_ENABLED
+    [MB_FUNC_READ_INPUT]        = Modbus_FC04_ReadInput,
+#endif
+#if MODBUS_FC_05_ENABLED
+    [MB_FUNC_WRITE_SINGLE_COIL] = Modbus_FC05_WriteCoil,
+#endif
+#if MODBUS_FC_06_ENABLED
+    [MB_FUNC_WRITE_SINGLE_REG]  = Modbus_FC06_WriteReg,
+#endif
+#if MODBUS_FC_08_ENABLED
+    [MB_FUNC_DIAGNOSTICS]       = Modbus_FC08_Diagnostics,
+#endif
+#if MODBUS_FC_0F_ENABLED
+    [MB_FUNC_WRITE_MULTI_COILS] = Modbus_FC0F_WriteCoils,
+#endif
+#if MODBUS_FC_10_ENABLED
+    [MB_FUNC_WRITE_MULTI_REGS]  = Modbus_FC10_WriteRegs,
+#endif
+#if MODBUS_FC_16_ENABLED
+    [MB_FUNC_MASK_WRITE_REG]    = Modbus_FC16_MaskWriteReg,
+#endif
+#if MODBUS_FC_17_ENABLED
+    [MB_FUNC_READ_WRITE_REGS]   = Modbus_FC17_ReadWriteRegs,
+#endif
+#if MODBUS_FC_64_ENABLED
+    [MB_FUNC_CUSTOM_CONFIG]     = Modbus_FC64_CustomConfig,
+#endif
+};
+
+/**
+ * @brief   中断快速路径可代答的内置读处理函数 (按功能码0x01~0x04, NULL=已裁剪)
+ * @note    分发表中对应项被应用覆盖时，快速路径不得绕过应用处理函数
+ */
+static const Modbus_FuncHandler_t s_fast_path_handlers[4] = {
+#if MODBUS_FC_01_ENABLED
+    [0] = Modbus_FC01_ReadCoils,
+#endif
+#if MODBUS_FC_02_ENABLED
+    [1] = Modbus_FC02_ReadDiscrete,
+#endif
+#if MODBUS_FC_03_ENABLED
+    [2] = Modbus_FC03_ReadHolding,
+#endif
+#if MODBUS_FC_04_ENABLED
+    [3] = Modbus_FC04_ReadInput,
+#endif
+};
 
 /* ============================================================================
  *                              初始化函数
@@ -81,28 +475,148 @@ bool Modbus_Init(ModbusHandle_t *hmodbus, const Modbus_Config_t *config) {
         return false;
     }
     
-    if (config->huart == NULL) {
+    /* 传输层: 须提供收发函数，HAL专有功能 (环形DMA接收、定时帧定界、硬件静默与硬件DE) 不可用 */
+    if (config->transport != NULL) {
+        if (config->transport->start_rx == NULL || config->transport->send == NULL) {
+            return false;
+        }
+        if (config->rx_mode != MODBUS_RX_IT_PINGPONG || config->framing.mode != MODBUS_FRAMING_IDLE ||
+            config->mute_foreign || config->stop_wake || (config->rs485.enabled && config->rs485.hw_de)) {
+            return false;
+        }
+        if (config->incremental_crc && config->transport->rx_count == NULL) {
+            return false;  /* 增量CRC需由驱动报告接收位置 */
+        }
+    } else if (config->huart == NULL) {
+        return false;
+    }
+    
+    /* 传输层发送恒为异步，按DMA发送处理; 配置档固定发送方式时忽略 use_dma_tx */
+#if MODBUS_PROFILE_TX == MODBUS_PROFILE_TX_BLOCKING
+    if (config->transport != NULL) {
+        return false;
+    }
+    bool async_tx = false;
+#elif MODBUS_PROFILE_TX == MODBUS_PROFILE_TX_ASYNC
+    bool async_tx = true;
+#else
+    bool async_tx = config->use_dma_tx || config->transport != NULL;
+#endif
+    
+    /* 缓冲区有效性检查 (环形模式不需要rx_buf_b) */
+    if (config->buffer.rx_buf_a == NULL || config->buffer.tx_buf == NULL) {
+        return false;
+    }
+    if (config->rx_mode != MODBUS_RX_DMA_RING && config->buffer.rx_buf_b == NULL) {
+        return false;
+    }
+    
+    /* 环形接收模式: 需要已配置为循环模式的RX DMA */
+    if (config->rx_mode == MODBUS_RX_DMA_RING) {
+        if (config->huart->hdmarx == NULL || config->huart->hdmarx->Init.Mode != DMA_CIRCULAR) {
+            return false;
+        }
+    } else if (config->rx_mode != MODBUS_RX_IT_PINGPONG) {
+        return false;
+    }
+    
+    /* 帧定界方式检查 */
+    switch (config->framing.mode) {
+        case MODBUS_FRAMING_IDLE:
+            break;
+#if MODBUS_RTO_SUPPORTED
+        case MODBUS_FRAMING_RTO:
+#if defined(IS_LPUART_INSTANCE)
+            if (IS_LPUART_INSTANCE(config->huart->Instance)) {
+                return false;  /* LPUART无接收超时功能 */
+            }
+#endif
+            break;
+#endif
+#if defined(HAL_TIM_MODULE_ENABLED)
+        case MODBUS_FRAMING_TIMER:
+            if (config->framing.htim == NULL || config->framing.htim->Instance == NULL) {
+                return false;  /* 未提供帧定时器 */
+            }
+            break;
+#endif
+        default:
+            return false;  /* 不支持的帧定界方式 */
+    }
+    if (config->framing.mode != MODBUS_FRAMING_IDLE && config->baud_rate == 0) {
+        return false;  /* t1.5/t3.5需由波特率计算 */
+    }
+    
+    /* 他站帧硬件静默: 需芯片支持; 静默在空闲线解除，仅与中断乒乓接收+空闲线定界配合 */
+    if (config->mute_foreign) {
+#if MODBUS_MUTE_SUPPORTED
+        if (config->rx_mode != MODBUS_RX_IT_PINGPONG || config->framing.mode != MODBUS_FRAMING_IDLE) {
+            return false;
+        }
+#else
         return false;
+#endif
+    }
+    
+#if !MODBUS_STOP_WAKE_SUPPORTED
+    if (config->stop_wake) {
+        return false;  /* 芯片USART无法在STOP模式下唤醒 */
+    }
+#endif
+    
+    /* RS485硬件DE: 需芯片支持，时间参数为5位字段 */
+    if (config->rs485.enabled && config->rs485.hw_de) {
+#if MODBUS_HW_DE_SUPPORTED
+#if defined(IS_UART_DRIVER_ENABLE_INSTANCE)
+        if (!IS_UART_DRIVER_ENABLE_INSTANCE(config->huart->Instance)) {
+            return false;
+        }
+#endif
+        if (config->rs485.de_assert_time > 31 || config->rs485.de_deassert_time > 31) {
+            return false;
+        }
+#else
+        return false;  /* 芯片USART无硬件DE功能 */
+#endif
     }
     
-    /* 缓冲区有效性检查 */
-    if (config->buffer.rx_buf_a == NULL || 
-        config->buffer.rx_buf_b == NULL || 
-        config->buffer.tx_buf == NULL) {
+    /* 流水线发送依赖DMA发送完成回调接续数据部分 */
+    if (config->pipelined_tx && !async_tx) {
         return false;
     }
     
     if (config->buffer.rx_buf_size < 8 || config->buffer.tx_buf_size < 8) {
         return false;  /* 缓冲区过小 */
     }
+    if (config->buffer.tx_slots > MODBUS_TX_QUEUE_MAX) {
+        return false;  /* 发送槽过多 */
+    }
     
     /* 从站地址有效性检查 */
     if (config->slave_addr < 1 || config->slave_addr > 247) {
         return false;
     }
     
+    /* CRC后端绑定 */
+    if (!Modbus_CrcSetup(hmodbus, config)) {
+        return false;
+    }
+    Modbus_CrcMode_t crc_mode = hmodbus->crc_mode;
+    
+    /* 增量CRC在中断中计算，不能与主循环共享硬件CRC外设 */
+    if (config->incremental_crc && crc_mode == MODBUS_CRC_HARDWARE) {
+        return false;
+    }
+    hmodbus->incremental_crc = config->incremental_crc;
+    hmodbus->rx_crc = 0xFFFF;
+    hmodbus->rx_crc_pos = 0;
+    hmodbus->rx_crc_count = 0;
+    hmodbus->rx_crc_result = MODBUS_RX_CRC_UNKNOWN;
+    
     /* 复制UART配置 */
     hmodbus->huart = config->huart;
+    hmodbus->transport = config->transport;
+    hmodbus->transport_ctx = config->transport_ctx;
     hmodbus->slave_addr = config->slave_addr;
     hmodbus->baud_rate = config->baud_rate;
     
@@ -113,40 +627,281 @@ bool Modbus_Init(ModbusHandle_t *hmodbus, const Modbus_Config_t *config) {
     hmodbus->rx_buf_size = config->buffer.rx_buf_size;
     hmodbus->tx_buf_size = config->buffer.tx_buf_size;
     
+    /* 初始化发送队列: 阻塞发送时无需排队，固定为单槽 */
+    hmodbus->tx_pool = config->buffer.tx_buf;
+    hmodbus->tx_slots = (async_tx && config->buffer.tx_slots > 1) ? config->buffer.tx_slots : 1;
+    hmodbus->tx_head = 0;
+    hmodbus->tx_count = 0;
+    hmodbus->tx_state = MODBUS_TX_IDLE;
+    hmodbus->tx_done_tick = 0;
+    
     /* 初始化乒乓缓冲状态 */
     hmodbus->rx_active_buf = hmodbus->rx_buf_a;
     hmodbus->rx_process_buf = hmodbus->rx_buf_b;
     hmodbus->rx_len = 0;
     hmodbus->rx_ready = 0;
     
-    /* 复制数据映射 */
+    /* 初始化环形接收状态 */
+    hmodbus->rx_mode = config->rx_mode;
+    hmodbus->rx_ring_tail = 0;
+    hmodbus->rx_frame_offset = 0;
+    
+    /* 初始化帧定界状态 */
+    hmodbus->framing = config->framing;
+    hmodbus->rx_arm_offset = 0;
+    hmodbus->rx_timer_mark = 0;
+    hmodbus->rx_timer_stage = 0;
+    hmodbus->rx_gap_error = 0;
+    
+    /* 中断快速路径: 发送在中断中启动，且CRC计算不能与主循环共享硬件外设 */
+    hmodbus->fast_path = config->fast_path;
+    if (hmodbus->fast_path.enabled) {
+        if (!async_tx || crc_mode == MODBUS_CRC_HARDWARE) {
+            return false;
+        }
+        if (hmodbus->fast_path.max_regs == 0) {
+            hmodbus->fast_path.max_regs = MODBUS_FAST_PATH_MAX_REGS;
+        }
+        
+        /* 上限不超过协议规定的125个寄存器 (位为2000个)，且响应须能装入发送槽 */
+        uint32_t limit = (hmodbus->tx_buf_size > 5U) ? (hmodbus->tx_buf_size - 5U) / 2U : 0U;
+        if (limit > 125U) {
+            limit = 125U;
+        }
+        if (hmodbus->fast_path.max_regs > limit) {
+            hmodbus->fast_path.max_regs = (uint8_t)limit;
+        }
+    }
+    hmodbus->process_busy = 0;
+    
+    /* 复制数据映射并建立各数据区段表 */
     hmodbus->data_map = config->data_map;
+    if (!Modbus_MapSetup(hmodbus)) {
+        return false;  /* 段表未排序、重叠或数据指针为空 */
+    }
+    
+    /* 建立网关路由的地址位图 */
+    if (!Modbus_BridgeSetup(hmodbus, &config->bridge)) {
+        return false;  /* 路由地址范围无效或目标为空 */
+    }
+    
+    /* 清空响应缓存 */
+    if (!Modbus_CacheSetup(hmodbus, &config->resp_cache)) {
+        return false;
+    }
+    
+    /* 清空写入事件队列 */
+    if (!Modbus_EventSetup(hmodbus, &config->event_queue)) {
+        return false;  /* 队列长度不是2的幂或事件数组为空 */
+    }
     
     /* 复制RS485配置 */
     hmodbus->rs485 = config->rs485;
     
     /* 复制运行时选项 */
-    hmodbus->use_dma_tx = config->use_dma_tx;
-    hmodbus->use_crc_table = config->use_crc_table;
-    
-    /* 复制回调函数 */
-    hmodbus->custom_config_cb = config->custom_config_cb;
-    hmodbus->write_cb = config->write_cb;
+    hmodbus->use_dma_tx = async_tx;
+    hmodbus->pipelined_tx = config->pipelined_tx;
+    hmodbus->tx_pipe_state = MODBUS_TX_PIPE_IDLE;
+    hmodbus->tx_pipe_len = 0;
     
-    /* 初始化用户数据指针 */
-    hmodbus->user_data = NULL;
+    /* 复制回调函数、清零统计 */
+    Modbus_CommonSetup(hmodbus, config);
     
-    /* RS485初始化: 默认为接收模式 */
+    /* RS485初始化: 默认为接收模式; 硬件DE由USART在发送期间自动驱动 */
     if (hmodbus->rs485.enabled) {
+#if MODBUS_HW_DE_SUPPORTED
+        if (hmodbus->rs485.hw_de) {
+            Modbus_RS485_HwDeSetup(hmodbus);
+        }
+#endif
         Modbus_RS485_SetRxMode(hmodbus);
     }
     
+    /* 计算t1.5/t3.5并配置接收超时或帧定时器 */
+    Modbus_FramingSetup(hmodbus);
+    
+    /* 使能静默模式 (唤醒方式沿用复位值: 空闲线唤醒)，由接收中断按需请求进入 */
+    hmodbus->mute_foreign = config->mute_foreign;
+#if MODBUS_MUTE_SUPPORTED
+    if (hmodbus->mute_foreign) {
+        SET_BIT(hmodbus->huart->Instance->CR1, USART_CR1_MME);
+    }
+#endif
+    
+    /* STOP模式唤醒: 唤醒源在初始化时选定，进入STOP前由 Modbus_EnterStop() 使能 */
+    hmodbus->stop_wake = config->stop_wake;
+#if MODBUS_STOP_WAKE_SUPPORTED
+    if (hmodbus->stop_wake) {
+        Modbus_StopWakeSetup(hmodbus);
+    }
+#endif
+    
+    /* 登记到多实例注册表 */
+#if MODBUS_MAX_INSTANCES > 0
+    if (!Modbus_Register(hmodbus)) {
+        return false;  /* 注册表已满 */
+    }
+#else
+    hmodbus->registry_slot = 0xFF;
+#endif
+    
     /* 启动UART空闲中断接收 */
     Modbus_StartReceive(hmodbus);
     
     return true;
 }
 
+/**
+ * @brief   初始化无串口的协议引擎实例
+ */
+bool Modbus_InitEngine(ModbusHandle_t *hmodbus, const Modbus_Config_t *config) {
+    if (hmodbus == NULL || config == NULL) {
+        return false;
+    }
+    if (config->slave_addr < 1 || config->slave_addr > 247 || config->bridge.route_count != 0) {
+        return false;
+    }
+    if (!Modbus_CrcSetup(hmodbus, config)) {
+        return false;
+    }
+    
+    /* 无串口: 接收、发送队列与帧定界保持空闲，Modbus_Process() 只提交写入变更 */
+    hmodbus->huart = NULL;
+    hmodbus->transport = NULL;
+    hmodbus->transport_ctx = NULL;
+    hmodbus->slave_addr = config->slave_addr;
+    hmodbus->baud_rate = 0;
+    hmodbus->incremental_crc = false;
+    hmodbus->rx_crc_result = MODBUS_RX_CRC_UNKNOWN;
+    hmodbus->rx_buf_a = NULL;
+    hmodbus->rx_buf_b = NULL;
+    hmodbus->rx_active_buf = NULL;
+    hmodbus->rx_process_buf = NULL;
+    hmodbus->rx_buf_size = 0;
+    hmodbus->rx_len = 0;
+    hmodbus->rx_ready = 0;
+    hmodbus->rx_mode = MODBUS_RX_IT_PINGPONG;
+    hmodbus->framing.mode = MODBUS_FRAMING_IDLE;
+    hmodbus->tx_buf = NULL;
+    hmodbus->tx_pool = NULL;
+    hmodbus->tx_buf_size = 0;
+    hmodbus->tx_slots = 1;
+    hmodbus->tx_head = 0;
+    hmodbus->tx_count = 0;
+    hmodbus->tx_state = MODBUS_TX_IDLE;
+    hmodbus->use_dma_tx = false;
+    hmodbus->pipelined_tx = false;
+    hmodbus->tx_pipe_state = MODBUS_TX_PIPE_IDLE;
+    hmodbus->mute_foreign = false;
+    hmodbus->stop_wake = false;
+    hmodbus->process_busy = 0;
+    memset(&hmodbus->fast_path, 0, sizeof(hmodbus->fast_path));
+    memset(&hmodbus->rs485, 0, sizeof(hmodbus->rs485));
+    (void)Modbus_BridgeSetup(hmodbus, &config->bridge);
+    memset(&hmodbus->resp_cache, 0, sizeof(hmodbus->resp_cache));
+    
+    hmodbus->data_map = config->data_map;
+    if (!Modbus_MapSetup(hmodbus)) {
+        return false;
+    }
+    if (!Modbus_EventSetup(hmodbus, &config->event_queue)) {
+        return false;
+    }
+    
+    Modbus_CommonSetup(hmodbus, config);
+    hmodbus->registry_slot = 0xFF;
+    return true;
+}
+
+/**
+ * @brief   绑定CRC后端
+ * @param   hmodbus Modbus句柄指针
+ * @param   config  初始化配置结构体指针
+ * @retval  true    绑定成功
+ * @retval  false   CRC后端不受支持或缺少外设句柄/自定义函数
+ */
+static bool Modbus_CrcSetup(ModbusHandle_t *hmodbus, const Modbus_Config_t *config) {
+#ifdef MODBUS_PROFILE_CRC_FUNC
+    /* 配置档固定后端: 忽略 crc_mode / use_crc_table / crc_func */
+#if MODBUS_PROFILE_CRC == MODBUS_PROFILE_CRC_HARDWARE
+    if (config->hw_crc.hcrc == NULL || config->hw_crc.hcrc->Instance == NULL) {
+        return false;  /* 未提供CRC外设句柄 */
+    }
+#endif
+    hmodbus->crc_func = MODBUS_PROFILE_CRC_FUNC;
+    hmodbus->crc_mode = (Modbus_CrcMode_t)MODBUS_PROFILE_CRC;
+    hmodbus->hw_crc = config->hw_crc;
+    return true;
+#else
+    /* 兼容模式下由 use_crc_table 决定 */
+    Modbus_CrcMode_t crc_mode = config->crc_mode;
+    if (crc_mode == MODBUS_CRC_DEFAULT) {
+        crc_mode = config->use_crc_table ? MODBUS_CRC_TABLE : MODBUS_CRC_SHIFT;
+    }
+    
+    switch (crc_mode) {
+        case MODBUS_CRC_SHIFT:
+            hmodbus->crc_func = Modbus_CRC16_Shift;
+            break;
+        case MODBUS_CRC_TABLE:
+            hmodbus->crc_func = Modbus_CRC16_Table;
+            break;
+        case MODBUS_CRC_NIBBLE:
+            hmodbus->crc_func = Modbus_CRC16_Nibble;
+            break;
+#if MODBUS_HW_CRC_SUPPORTED
+        case MODBUS_CRC_HARDWARE:
+            if (config->hw_crc.hcrc == NULL || config->hw_crc.hcrc->Instance == NULL) {
+                return false;  /* 未提供CRC外设句柄 */
+            }
+            hmodbus->crc_func = Modbus_CRC16_Hardware;
+            break;
+#endif
+        case MODBUS_CRC_CUSTOM:
+            if (config->crc_func == NULL) {
+                return false;  /* 未提供自定义CRC函数 */
+            }
+            hmodbus->crc_func = config->crc_func;
+            break;
+        default:
+            return false;  /* 不支持的CRC后端 (如芯片无可编程CRC外设) */
+    }
+    hmodbus->crc_mode = crc_mode;
+    hmodbus->hw_crc = config->hw_crc;
+    return true;
+#endif
+}
+
+/**
+ * @brief   复制回调函数、清零统计 (Modbus_Init() 与 Modbus_InitEngine() 共用)
+ * @param   hmodbus Modbus句柄指针
+ * @param   config  初始化配置结构体指针
+ */
+static void Modbus_CommonSetup(ModbusHandle_t *hmodbus, const Modbus_Config_t *config) {
+    hmodbus->custom_config_cb = config->custom_config_cb;
+    hmodbus->write_cb = config->write_cb;
+    hmodbus->ready_cb = config->ready_cb;
+    hmodbus->lock_cb = config->lock_cb;
+    hmodbus->data_locked = false;
+    hmodbus->commit_cb = config->commit_cb;
+    hmodbus->commit_window_ms = config->commit_window_ms;
+    hmodbus->commit_count = 0;
+    
+    /* 清零统计并启动周期计数器 (调试器已启动时保持不变) */
+#if MODBUS_STATS_ENABLED
+    Modbus_StatsReset(hmodbus);
+#endif
+#if MODBUS_STATS_TIMING
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    hmodbus->rx_stamp = DWT->CYCCNT;
+    hmodbus->parse_timing = false;
+#endif
+    
+    /* 初始化用户数据指针 */
+    hmodbus->user_data = NULL;
+}
+
 /* ============================================================================
  *                              中断回调接口
  * ============================================================================ */
@@ -159,24 +914,113 @@ void Modbus_RxCallback(ModbusHandle_t *hmodbus, uint16_t size) {
         return;
     }
     
-    /* 乒乓缓冲切换:
-     * 1. 将当前接收缓冲区设为处理缓冲区
-     * 2. 记录接收数据长度
-     * 3. 切换中断接收目标到另一个缓冲区
-     * 4. 立即重新启动接收，减少数据丢失窗口 */
+    if (hmodbus->rx_mode == MODBUS_RX_DMA_RING) {
+        Modbus_RxRingEvent(hmodbus, size);
+        return;
+    }
     
-    /* 交换缓冲区指针 */
-    uint8_t *completed_buf = hmodbus->rx_active_buf;
-    hmodbus->rx_active_buf = (completed_buf == hmodbus->rx_buf_a) 
-                            ? hmodbus->rx_buf_b : hmodbus->rx_buf_a;
+    uint16_t total = hmodbus->rx_arm_offset + size;
     
-    /* 设置处理缓冲区和数据长度 */
-    hmodbus->rx_process_buf = completed_buf;
-    hmodbus->rx_len = size;
-    hmodbus->rx_ready = 1;
+    /* 定时帧定界: 空闲事件仅为候选帧尾，在同一缓冲区的当前位置继续接收，
+     * 帧结束由接收超时或帧定时器判定; 缓冲区已满时直接结束 */
+    if (hmodbus->framing.mode != MODBUS_FRAMING_IDLE && total < hmodbus->rx_buf_size) {
+        if (hmodbus->incremental_crc) {
+            Modbus_RxCrcUpdate(hmodbus, hmodbus->rx_active_buf, total);
+        }
+        hmodbus->rx_arm_offset = total;
+        Modbus_FramingIdle(hmodbus, total);
+        Modbus_PortStartRx(hmodbus, hmodbus->rx_active_buf + total, hmodbus->rx_buf_size - total);
+        return;
+    }
     
-    /* 立即重新启动接收，指向新的缓冲区 */
-    HAL_UARTEx_ReceiveToIdle_IT(hmodbus->huart, hmodbus->rx_active_buf, hmodbus->rx_buf_size);
+    Modbus_RxFrameComplete(hmodbus, total);
+}
+
+/**
+ * @brief   UART中断钩子
+ */
+void Modbus_UART_IRQHandler(ModbusHandle_t *hmodbus) {
+    if (hmodbus == NULL) {
+        return;
+    }
+    
+    /* 溢出标志由随后的 HAL_UART_IRQHandler() 清除，每次溢出计数一次 (传输层由驱动计数) */
+    if (hmodbus->transport == NULL && __HAL_UART_GET_FLAG(hmodbus->huart, UART_FLAG_ORE)) {
+        MODBUS_STAT_INC(hmodbus, bus_overrun);
+    }
+    
+#if MODBUS_STOP_WAKE_SUPPORTED
+    /* 自STOP唤醒: 唤醒中断只需一次，其后的字节照常由接收中断处理 */
+    if (hmodbus->stop_wake && (hmodbus->huart->Instance->CR3 & USART_CR3_WUFIE) != 0U &&
+        (hmodbus->huart->Instance->ISR & USART_ISR_WUF) != 0U) {
+        CLEAR_BIT(hmodbus->huart->Instance->CR3, USART_CR3_WUFIE);
+        hmodbus->huart->Instance->ICR = USART_ICR_WUCF;
+    }
+#endif
+    
+#if MODBUS_RTO_SUPPORTED
+    /* 接收超时(t3.5)即帧结束; 先于HAL清除RTOF，避免HAL将其作为阻塞错误中止接收 */
+    if (hmodbus->framing.mode == MODBUS_FRAMING_RTO &&
+        (hmodbus->huart->Instance->ISR & USART_ISR_RTOF) != 0U) {
+        hmodbus->huart->Instance->ICR = USART_ICR_RTOCF;
+        Modbus_RxFrameTimeout(hmodbus);
+    }
+#endif
+    
+#if MODBUS_MUTE_SUPPORTED
+    /* 首字节到达即判定地址: 他站帧静默至帧尾，其余字节不再进入中断 */
+    if (hmodbus->mute_foreign && Modbus_RxPosition(hmodbus) != 0 &&
+        !Modbus_RxAddrMatch(hmodbus, hmodbus->rx_active_buf[0])) {
+        MODBUS_STAT_INC(hmodbus, bus_msg);
+        Modbus_RxMute(hmodbus);
+        return;
+    }
+#endif
+    
+    if (!hmodbus->incremental_crc) {
+        return;
+    }
+    
+    if (hmodbus->rx_mode == MODBUS_RX_DMA_RING) {
+        Modbus_RxRingCrcUpdate(hmodbus, Modbus_RxPosition(hmodbus));
+    } else {
+        Modbus_RxCrcUpdate(hmodbus, hmodbus->rx_active_buf, Modbus_RxPosition(hmodbus));
+    }
+}
+
+/**
+ * @brief   帧定时器到期回调
+ */
+void Modbus_TimerCallback(ModbusHandle_t *hmodbus) {
+    if (hmodbus == NULL || hmodbus->framing.mode != MODBUS_FRAMING_TIMER) {
+        return;
+    }
+    
+#if defined(HAL_TIM_MODULE_ENABLED)
+    uint8_t stage = hmodbus->rx_timer_stage;
+    if (stage == 0) {
+        return;
+    }
+    
+    /* 计时期间收到新字节: 帧未结束，由下一次空闲事件重新计时
+     * t1.5到期前收到属正常字符间隔; t1.5之后收到则保留阶段2，由空闲事件判定间隔错误 */
+    if (Modbus_RxPosition(hmodbus) != hmodbus->rx_timer_mark) {
+        if (stage == 1) {
+            hmodbus->rx_timer_stage = 0;
+        }
+        return;
+    }
+    
+    /* t1.5到期且无新字节: 继续计时至t3.5 */
+    if (stage == 1) {
+        hmodbus->rx_timer_stage = 2;
+        Modbus_FramingTimerStart(hmodbus, hmodbus->t35_us - hmodbus->t15_us);
+        return;
+    }
+    
+    hmodbus->rx_timer_stage = 0;
+    Modbus_RxFrameTimeout(hmodbus);
+#endif
 }
 
 /**
@@ -187,13 +1031,38 @@ void Modbus_TxCallback(ModbusHandle_t *hmodbus) {
         return;
     }
     
-    if (hmodbus->use_dma_tx && hmodbus->rs485.enabled) {
-        /* DMA发送完成，等待TC标志后切换RS485为接收模式
-         * 注意: DMA完成中断时数据已全部移入发送缓冲，
-         * 但需等待TC标志确保最后一个字节完全发出 */
-        while (__HAL_UART_GET_FLAG(hmodbus->huart, UART_FLAG_TC) == RESET);
+    /* 流水线发送: 帧头发送完成，数据部分已就绪则立即接续，否则由主循环接续 */
+    if (hmodbus->tx_pipe_state == MODBUS_TX_PIPE_HEADER) {
+        uint16_t total_len = hmodbus->tx_pipe_len;
+        if (total_len != 0) {
+            hmodbus->tx_pipe_state = MODBUS_TX_PIPE_IDLE;
+            hmodbus->tx_pipe_len = 0;
+            (void)Modbus_PortSend(hmodbus, MODBUS_TX_SLOT(hmodbus, hmodbus->tx_head) + MODBUS_TX_PIPE_HEADER_LEN,
+                                  total_len - MODBUS_TX_PIPE_HEADER_LEN);
+        } else {
+            hmodbus->tx_pipe_state = MODBUS_TX_PIPE_HEADER_DONE;
+        }
+        return;
+    }
+    
+    if (hmodbus->transport != NULL) {
+        /* 传输层在最后一个字节完全移出后才回调 */
+        Modbus_RS485_SetRxMode(hmodbus);
+    } else if (MODBUS_ASYNC_TX(hmodbus) && hmodbus->rs485.enabled && !hmodbus->rs485.hw_de) {
+        /* DMA发送完成，TC标志置位后切换RS485为接收模式
+         * 注意: DMA完成时数据可能仅移入发送缓冲，最后一个字节尚未完全发出;
+         * 此时使能TC中断后返回，HAL在TC中断中关闭TCIE并再次回调本函数 */
+        if (__HAL_UART_GET_FLAG(hmodbus->huart, UART_FLAG_TC) == RESET) {
+            hmodbus->tx_state = MODBUS_TX_DRAINING;
+            __HAL_UART_ENABLE_IT(hmodbus->huart, UART_IT_TC);
+            return;
+        }
         Modbus_RS485_SetRxMode(hmodbus);
     }
+    
+    if (MODBUS_ASYNC_TX(hmodbus)) {
+        Modbus_TxComplete(hmodbus);
+    }
 }
 
 /* ============================================================================
@@ -208,465 +1077,3024 @@ void Modbus_Process(ModbusHandle_t *hmodbus) {
         return;
     }
     
-    if (!hmodbus->rx_ready) {
+    /* 推进发送队列: 启动已满足帧间隔的排队响应 */
+    Modbus_TxPoll(hmodbus);
+    
+    /* 处理期间屏蔽中断快速路径: 二者共用发送构建槽 */
+    hmodbus->process_busy = 1;
+    Modbus_ProcessFrame(hmodbus);
+    hmodbus->process_busy = 0;
+    
+    /* 作为网关下游: 检查转发请求的应答超时 */
+    Modbus_BridgePoll(hmodbus);
+    
+    /* 响应已启动发送: 提交到期的写入变更 */
+    Modbus_CommitPoll(hmodbus);
+}
+
+/**
+ * @brief   解析待处理帧并生成响应
+ * @param   hmodbus Modbus句柄指针
+ */
+static void Modbus_ProcessFrame(ModbusHandle_t *hmodbus) {
+    if (!hmodbus->rx_ready) {
         return;  /* 无数据待处理 */
     }
     
-    /* 获取待处理数据的本地副本 */
-    uint8_t *rx_buf = hmodbus->rx_process_buf;
+    /* 发送槽全部占用: 请求保持待处理，待发送完成后再解析 */
+    if (hmodbus->tx_count >= hmodbus->tx_slots) {
+        return;
+    }
+    
+    /* 转发目标总线仍在等待上一请求的应答: 请求保持待处理，应答或超时后再转发 */
+    if (hmodbus->bridge_route_count != 0 && Modbus_BridgeBusy(hmodbus)) {
+        return;
+    }
+    hmodbus->tx_buf = MODBUS_TX_SLOT(hmodbus, (hmodbus->tx_head + hmodbus->tx_count) % hmodbus->tx_slots);
+    
+    /* 开始解析: 帧结束到此为排队等待时间 */
+#if MODBUS_STATS_TIMING
+    uint32_t parse_start = DWT->CYCCNT;
+#endif
+    
+    /* 获取待处理帧描述的本地副本 */
+    Modbus_Frame_t frame;
     uint16_t rx_len = hmodbus->rx_len;
+    uint8_t crc_result = hmodbus->rx_crc_result;
+    Modbus_RxFrameGet(hmodbus, &frame);
     
     /* 清除接收标志，允许中断更新新数据 */
     hmodbus->rx_ready = 0;
     hmodbus->rx_len = 0;
     
-    /* 步骤1: 检查帧最小长度 */
+    /* 步骤1: 检查帧长度 */
     if (rx_len < 4) {
+        MODBUS_STAT_INC(hmodbus, bus_comm_err);
         return;  /* 帧长度不足 */
     }
+    if (rx_len > MODBUS_RTU_ADU_MAX) {
+        MODBUS_STAT_INC(hmodbus, bus_overrun);
+        return;  /* 帧超长 */
+    }
     
     /* 步骤2: 校验从站地址
      * 支持本机地址咀xFF广播地址(带返回) */
-    uint8_t req_addr = rx_buf[0];
-    if (req_addr != hmodbus->slave_addr && req_addr != 0xFF) {
+    uint8_t req_addr = Modbus_FrameByte(&frame, 0);
+    if (!Modbus_RxAddrMatch(hmodbus, req_addr)) {
         return;  /* 地址不匹配 */
     }
     
-    /* 步骤3: CRC校验 */
-    uint16_t received_crc = (rx_buf[rx_len - 1] << 8) | rx_buf[rx_len - 2];
-    uint16_t calculated_crc = Modbus_CRC16(hmodbus, rx_buf, rx_len - 2);
+    /* 步骤3: CRC校验
+     * 增量CRC模式下校验结果已在接收中断中得出，无需再次遍历整帧 */
+    if (crc_result != MODBUS_RX_CRC_UNKNOWN) {
+        if (crc_result != MODBUS_RX_CRC_OK) {
+            MODBUS_STAT_INC(hmodbus, bus_comm_err);
+            return;  /* CRC错误 */
+        }
+    } else {
+        uint16_t received_crc = (Modbus_FrameByte(&frame, rx_len - 1) << 8) | Modbus_FrameByte(&frame, rx_len - 2);
+        uint16_t calculated_crc = Modbus_FrameCRC16(hmodbus, &frame, rx_len - 2);
+        
+        if (received_crc != calculated_crc) {
+            MODBUS_STAT_INC(hmodbus, bus_comm_err);
+            return;  /* CRC错误 */
+        }
+    }
     
-    if (received_crc != calculated_crc) {
-        return;  /* CRC错误 */
+    /* 网关: 等待中的下游应答发回来源实例，路由地址的请求转发到下游实例 */
+    if (hmodbus->bridge_origin != NULL && req_addr == hmodbus->bridge_addr) {
+        Modbus_BridgeReply(hmodbus, &frame, rx_len);
+        return;
+    }
+    if (!Modbus_RxAddrLocal(hmodbus, req_addr)) {
+        Modbus_BridgeForward(hmodbus, &frame, rx_len);
+        return;
     }
     
     /* 步骤4: 解析功能码 */
-    uint8_t func_code = rx_buf[1];
+    uint8_t func_code = Modbus_FrameByte(&frame, 1);
+    MODBUS_STAT_INC(hmodbus, slave_msg);
+#if MODBUS_STATS_TIMING
+    Modbus_TimingRecord(hmodbus, MODBUS_TIMING_RX_TO_PARSE, hmodbus->rx_stamp, func_code);
+    hmodbus->parse_stamp = parse_start;
+    hmodbus->parse_func_code = func_code;
+    hmodbus->parse_timing = true;
+#endif
     
-    /* 准备响应帧头部: 从站地址 + 功能码
-     * 无论请求地址是0xFF还是本机地址，响应始终使用本机真实地址 */
-    hmodbus->tx_buf[0] = hmodbus->slave_addr;
-    hmodbus->tx_buf[1] = func_code;
+#if MODBUS_STATS_ENABLED
+    uint32_t tx_frames = hmodbus->stats.tx_frames;
+#endif
     
-    /* 功能码处理 */
-    uint16_t start_addr, quantity;
-    uint8_t byte_count;
-    uint16_t i;
-    
-    switch (func_code) {
-        /* ================================================================
-         *                      线圈处理 (Coils)
-         *                  功能码: 0x01, 0x05, 0x0F
-         * ================================================================ */
-        case MB_FUNC_READ_COILS:  /* 0x01: 读线圈状态 */
-        {
-            /* 检查是否支持此功能 */
-            if (hmodbus->data_map.coils == NULL || hmodbus->data_map.coil_count == 0) {
-                Modbus_SendException(hmodbus, func_code, MB_EX_ILLEGAL_FUNCTION);
-                break;
-            }
-            
-            start_addr = (rx_buf[2] << 8) | rx_buf[3];
-            quantity = (rx_buf[4] << 8) | rx_buf[5];
-            
-            /* 参数校验 */
-            if (quantity < 1 || quantity > 2000) {
-                Modbus_SendException(hmodbus, func_code, MB_EX_ILLEGAL_DATA_VALUE);
-                break;
-            }
-            if (start_addr + quantity > hmodbus->data_map.coil_count) {
-                Modbus_SendException(hmodbus, func_code, MB_EX_ILLEGAL_DATA_ADDRESS);
-                break;
-            }
-            
-            byte_count = (quantity + 7) / 8;
-            hmodbus->tx_buf[2] = byte_count;
-            memset(&hmodbus->tx_buf[3], 0, byte_count);
-            
-            /* 读取线圈状态并打包响应
-             * 注意: 访问共享数据时，在高安全要求场景应使用临界区保护 */
-            for (i = 0; i < quantity; i++) {
-                uint16_t bit_idx = start_addr + i;
-                if (hmodbus->data_map.coils[bit_idx / 8] & (1 << (bit_idx % 8))) {
-                    hmodbus->tx_buf[3 + i / 8] |= (1 << (i % 8));
-                }
-            }
-            Modbus_SendResponse(hmodbus, 3 + byte_count);
-            break;
+    /* 响应缓存: 数据版本在读取数据区之前取样，组帧期间数据被修改的响应不会命中 */
+    uint32_t generation = s_data_generation;
+    bool cacheable = hmodbus->resp_cache.count != 0 && Modbus_CacheCacheable(func_code, rx_len);
+    if (cacheable && Modbus_CacheReplay(hmodbus, &frame, generation)) {
+        return;
+    }
+    
+    /* 功能码处理: 访问data_map期间加锁，组帧完成后在发送前解锁 */
+    uint16_t reply = Modbus_Dispatch(hmodbus, &frame, rx_len, hmodbus->tx_buf, hmodbus->tx_buf_size - 2);
+    if (reply & MODBUS_REPLY_EXCEPTION(0)) {
+        Modbus_SendException(hmodbus, func_code, (uint8_t)reply);
+    } else {
+        if (reply != MODBUS_REPLY_NONE) {
+            Modbus_SendResponse(hmodbus, reply);
         }
-        
-        case MB_FUNC_WRITE_SINGLE_COIL:  /* 0x05: 写单个线圈 */
-        {
-            if (hmodbus->data_map.coils == NULL || hmodbus->data_map.coil_count == 0) {
-                Modbus_SendException(hmodbus, func_code, MB_EX_ILLEGAL_FUNCTION);
-                break;
-            }
-            
-            start_addr = (rx_buf[2] << 8) | rx_buf[3];
-            uint16_t val = (rx_buf[4] << 8) | rx_buf[5];
-            
-            if (start_addr >= hmodbus->data_map.coil_count) {
-                Modbus_SendException(hmodbus, func_code, MB_EX_ILLEGAL_DATA_ADDRESS);
-                break;
-            }
-            
-            /* 写入前回调检查 */
-            if (hmodbus->write_cb != NULL) {
-                if (!hmodbus->write_cb(hmodbus, func_code, start_addr, 1)) {
-                    Modbus_SendException(hmodbus, func_code, MB_EX_SLAVE_DEVICE_FAILURE);
-                    break;
-                }
-            }
-            
-            /* 0xFF00=置位, 0x0000=复位
-             * 注意: 写入共享数据时，在高安全要求场景应使用原子操作 */
-            if (val == 0xFF00) {
-                hmodbus->data_map.coils[start_addr / 8] |= (1 << (start_addr % 8));
-            } else if (val == 0x0000) {
-                hmodbus->data_map.coils[start_addr / 8] &= ~(1 << (start_addr % 8));
-            }
-            
-            /* 原样返回请求帧 */
-            memcpy(hmodbus->tx_buf, rx_buf, 6);
-            hmodbus->tx_buf[0] = hmodbus->slave_addr;
-            Modbus_SendResponse(hmodbus, 6);
-            break;
+        if (cacheable) {
+            Modbus_CacheStore(hmodbus, &frame, generation);
         }
-        
-        case MB_FUNC_WRITE_MULTI_COILS:  /* 0x0F: 写多个线圈 */
-        {
-            if (hmodbus->data_map.coils == NULL || hmodbus->data_map.coil_count == 0) {
-                Modbus_SendException(hmodbus, func_code, MB_EX_ILLEGAL_FUNCTION);
-                break;
-            }
-            
-            start_addr = (rx_buf[2] << 8) | rx_buf[3];
-            quantity = (rx_buf[4] << 8) | rx_buf[5];
-            byte_count = rx_buf[6];
-            
-            if (start_addr + quantity > hmodbus->data_map.coil_count) {
-                Modbus_SendException(hmodbus, func_code, MB_EX_ILLEGAL_DATA_ADDRESS);
-                break;
-            }
-            
-            /* 写入前回调检查 */
-            if (hmodbus->write_cb != NULL) {
-                if (!hmodbus->write_cb(hmodbus, func_code, start_addr, quantity)) {
-                    Modbus_SendException(hmodbus, func_code, MB_EX_SLAVE_DEVICE_FAILURE);
-                    break;
-                }
-            }
-            
-            /* 写入线圈状态
-             * 注意: 批量写入共享数据时，建议使用临界区保护 */
-            for (i = 0; i < quantity; i++) {
-                uint8_t val = (rx_buf[7 + i / 8] >> (i % 8)) & 0x01;
-                if (val) {
-                    hmodbus->data_map.coils[(start_addr + i) / 8] |= (1 << ((start_addr + i) % 8));
-                } else {
-                    hmodbus->data_map.coils[(start_addr + i) / 8] &= ~(1 << ((start_addr + i) % 8));
-                }
-            }
-            
-            memcpy(&hmodbus->tx_buf[2], &rx_buf[2], 4);
-            Modbus_SendResponse(hmodbus, 6);
-            break;
+    }
+    
+    /* 未产生响应的分支 (如缓冲区不足) 在此解锁 */
+    Modbus_DataUnlock(hmodbus);
+    
+#if MODBUS_STATS_ENABLED
+    if (hmodbus->stats.tx_frames == tx_frames) {
+        hmodbus->stats.slave_no_resp++;
+    }
+#endif
+    Modbus_TimingParseEnd(hmodbus);
+}
+
+/**
+ * @brief   经分发表调用功能码处理函数
+ * @param   hmodbus Modbus句柄指针
+ * @param   frame   请求帧 (地址与CRC已校验)
+ * @param   rx_len  请求帧长度 (含CRC)
+ * @param   tx      响应缓冲区
+ * @param   tx_size 响应可用长度 (不含CRC)
+ * @return  处理函数返回值; 功能码未注册时为 MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_FUNCTION)
+ * 
+ * @note    调用处理函数前对数据区加锁，由调用者在组帧完成后解锁
+ */
+static uint16_t Modbus_Dispatch(ModbusHandle_t *hmodbus, const Modbus_Frame_t *frame, uint16_t rx_len,
+                                uint8_t *tx, uint16_t tx_size) {
+    uint8_t func_code = Modbus_FrameByte(frame, 1);
+    
+    /* 准备响应帧头部: 从站地址 + 功能码
+     * 无论请求地址是0xFF还是本机地址，响应始终使用本机真实地址 */
+    tx[0] = hmodbus->slave_addr;
+    tx[1] = func_code;
+    
+    /* 预解析请求字段 */
+    Modbus_Request_t req;
+    req.frame = *frame;
+    req.length = rx_len;
+    req.func_code = func_code;
+    req.addr = Modbus_FrameU16(frame, 2);
+    req.value = Modbus_FrameU16(frame, 4);
+    req.byte_count = Modbus_FrameByte(frame, 6);
+    req.tx_size = tx_size;
+    
+    Modbus_FuncHandler_t handler = (func_code < MODBUS_FUNC_TABLE_SIZE) ? s_func_table[func_code] : NULL;
+    if (handler == NULL) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_FUNCTION);
+    }
+    
+    Modbus_DataLock(hmodbus);
+    return handler(hmodbus, &req, tx);
+}
+
+/**
+ * @brief   同步处理一帧请求
+ */
+uint16_t Modbus_Execute(ModbusHandle_t *hmodbus, const uint8_t *req, uint16_t len,
+                        uint8_t *tx, uint16_t tx_size, bool with_crc) {
+    if (hmodbus == NULL || req == NULL || tx == NULL) {
+        return 0;
+    }
+    
+    /* 处理函数按RTU帧长度(含CRC)检查请求，无CRC的请求按补足2字节计 */
+    uint16_t crc_len = with_crc ? 2U : 0U;
+    uint16_t rx_len = len + 2U - crc_len;
+    
+    MODBUS_STAT_INC(hmodbus, bus_msg);
+    if (len < 2U + crc_len) {
+        MODBUS_STAT_INC(hmodbus, bus_comm_err);
+        return 0;
+    }
+    if (rx_len > MODBUS_RTU_ADU_MAX) {
+        MODBUS_STAT_INC(hmodbus, bus_overrun);
+        return 0;
+    }
+    /* 无CRC的请求 (Modbus TCP): 单元号0与0xFF同样指本机 */
+    if (!Modbus_RxAddrLocal(hmodbus, req[0]) && (with_crc || req[0] != 0)) {
+        return 0;
+    }
+    if (with_crc && Modbus_CRC16(hmodbus, req, len - 2U) != (uint16_t)(req[len - 2U] | (req[len - 1U] << 8))) {
+        MODBUS_STAT_INC(hmodbus, bus_comm_err);
+        return 0;
+    }
+    MODBUS_STAT_INC(hmodbus, slave_msg);
+    if (tx_size < 3U + crc_len) {
+        MODBUS_STAT_INC(hmodbus, tx_dropped);
+        return 0;  /* 连异常响应也放不下 */
+    }
+    
+    /* 预解析读取第2~6字节: 短请求复制到补零的本地缓冲区，不越过调用者缓冲区 */
+    uint8_t short_req[8] = { 0 };
+    if (len < sizeof(short_req)) {
+        memcpy(short_req, req, len);
+        req = short_req;
+    }
+    
+    /* 回绕点置于帧尾: 越过请求末尾的读取回到缓冲区起始，不会越界 */
+    Modbus_Frame_t frame = { .base = req, .size = len, .offset = 0, .length = rx_len, .wrap = len };
+    uint16_t reply = Modbus_Dispatch(hmodbus, &frame, rx_len, tx, tx_size - crc_len);
+    if (reply & MODBUS_REPLY_EXCEPTION(0)) {
+        reply = Modbus_ExceptionReply(hmodbus, tx, req[1], (uint8_t)reply);
+    }
+    Modbus_DataUnlock(hmodbus);
+    
+    if (reply == MODBUS_REPLY_NONE) {
+        MODBUS_STAT_INC(hmodbus, slave_no_resp);
+        return 0;
+    }
+    if (with_crc) {
+        uint16_t crc = Modbus_CRC16(hmodbus, tx, reply);
+        tx[reply++] = crc & 0xFF;
+        tx[reply++] = (crc >> 8) & 0xFF;
+    }
+    MODBUS_STAT_INC(hmodbus, tx_frames);
+    return reply;
+}
+
+/* ============================================================================
+ *                              网关转发
+ * ============================================================================ */
+
+/**
+ * @brief   校验路由表并建立需转发的地址位图
+ * @param   hmodbus Modbus句柄指针
+ * @param   bridge  网关转发配置
+ * @retval  true    配置有效 (route_count 为0时不转发)
+ * @retval  false   路由表为空、地址范围无效或目标为空/本实例
+ */
+static bool Modbus_BridgeSetup(ModbusHandle_t *hmodbus, const Modbus_BridgeConfig_t *bridge) {
+    memset(hmodbus->bridge_map, 0, sizeof(hmodbus->bridge_map));
+    hmodbus->bridge_routes = NULL;
+    hmodbus->bridge_route_count = 0;
+    hmodbus->bridge_timeout_ms = (bridge->timeout_ms != 0) ? bridge->timeout_ms : MODBUS_BRIDGE_TIMEOUT_MS;
+    hmodbus->bridge_origin = NULL;
+    
+    if (bridge->route_count == 0) {
+        return true;
+    }
+    if (bridge->routes == NULL) {
+        return false;
+    }
+    
+    for (uint32_t i = 0; i < bridge->route_count; i++) {
+        const Modbus_Route_t *route = &bridge->routes[i];
+        if (route->target == NULL || route->target == hmodbus || route->addr_first < 1 ||
+            route->addr_first > route->addr_last || route->addr_last > 247) {
+            return false;
         }
-        
-        /* ================================================================
-         *                    离散输入处理 (Discrete Inputs)
-         *                        功能码: 0x02
-         * ================================================================ */
-        case MB_FUNC_READ_DISCRETE:  /* 0x02: 读离散输入 */
-        {
-            if (hmodbus->data_map.discrete_inputs == NULL || hmodbus->data_map.discrete_count == 0) {
-                Modbus_SendException(hmodbus, func_code, MB_EX_ILLEGAL_FUNCTION);
-                break;
-            }
-            
-            start_addr = (rx_buf[2] << 8) | rx_buf[3];
-            quantity = (rx_buf[4] << 8) | rx_buf[5];
-            
-            if (quantity < 1 || quantity > 2000) {
-                Modbus_SendException(hmodbus, func_code, MB_EX_ILLEGAL_DATA_VALUE);
-                break;
-            }
-            if (start_addr + quantity > hmodbus->data_map.discrete_count) {
-                Modbus_SendException(hmodbus, func_code, MB_EX_ILLEGAL_DATA_ADDRESS);
-                break;
-            }
-            
-            byte_count = (quantity + 7) / 8;
-            hmodbus->tx_buf[2] = byte_count;
-            memset(&hmodbus->tx_buf[3], 0, byte_count);
-            
-            /* 读取离散输入状态 */
-            for (i = 0; i < quantity; i++) {
-                uint16_t bit_idx = start_addr + i;
-                if (hmodbus->data_map.discrete_inputs[bit_idx / 8] & (1 << (bit_idx % 8))) {
-                    hmodbus->tx_buf[3 + i / 8] |= (1 << (i % 8));
-                }
-            }
-            Modbus_SendResponse(hmodbus, 3 + byte_count);
-            break;
+        for (uint32_t addr = route->addr_first; addr <= route->addr_last; addr++) {
+            hmodbus->bridge_map[addr >> 5] |= 1UL << (addr & 31U);
         }
-        
-        /* ================================================================
-         *                   保持寄存器处理 (Holding Registers)
-         *                   功能码: 0x03, 0x06, 0x10
-         * ================================================================ */
-        case MB_FUNC_READ_HOLDING:  /* 0x03: 读保持寄存器 */
-        {
-            if (hmodbus->data_map.holding_regs == NULL || hmodbus->data_map.holding_reg_count == 0) {
-                Modbus_SendException(hmodbus, func_code, MB_EX_ILLEGAL_FUNCTION);
-                break;
-            }
-            
-            start_addr = (rx_buf[2] << 8) | rx_buf[3];
-            quantity = (rx_buf[4] << 8) | rx_buf[5];
-            
-            if (quantity < 1 || quantity > 125) {
-                Modbus_SendException(hmodbus, func_code, MB_EX_ILLEGAL_DATA_VALUE);
-                break;
-            }
-            if (start_addr + quantity > hmodbus->data_map.holding_reg_count) {
-                Modbus_SendException(hmodbus, func_code, MB_EX_ILLEGAL_DATA_ADDRESS);
-                break;
-            }
-            
-            hmodbus->tx_buf[2] = quantity * 2;
-            
-            /* 读取保持寄存器数据
-             * 注意: 对于16位寄存器，Cortex-M内核可保证单次读取的原子性 */
-            for (i = 0; i < quantity; i++) {
-                hmodbus->tx_buf[3 + i * 2] = (hmodbus->data_map.holding_regs[start_addr + i] >> 8) & 0xFF;
-                hmodbus->tx_buf[4 + i * 2] = hmodbus->data_map.holding_regs[start_addr + i] & 0xFF;
-            }
-            Modbus_SendResponse(hmodbus, 3 + quantity * 2);
-            break;
+    }
+    
+    hmodbus->bridge_routes = bridge->routes;
+    hmodbus->bridge_route_count = bridge->route_count;
+    return true;
+}
+
+/**
+ * @brief   查找从站地址对应的下游实例
+ * @param   hmodbus 来源实例
+ * @param   addr    从站地址
+ * @return  下游实例; 本机地址、0xFF或未配置路由的地址返回NULL
+ */
+static ModbusHandle_t *Modbus_BridgeTarget(const ModbusHandle_t *hmodbus, uint8_t addr) {
+    if (Modbus_RxAddrLocal(hmodbus, addr)) {
+        return NULL;
+    }
+    
+    for (uint32_t i = 0; i < hmodbus->bridge_route_count; i++) {
+        const Modbus_Route_t *route = &hmodbus->bridge_routes[i];
+        if (addr >= route->addr_first && addr <= route->addr_last) {
+            return route->target;
         }
-        
-        case MB_FUNC_WRITE_SINGLE_REG:  /* 0x06: 写单个寄存器 */
-        {
-            if (hmodbus->data_map.holding_regs == NULL || hmodbus->data_map.holding_reg_count == 0) {
-                Modbus_SendException(hmodbus, func_code, MB_EX_ILLEGAL_FUNCTION);
-                break;
-            }
-            
-            start_addr = (rx_buf[2] << 8) | rx_buf[3];
-            uint16_t val = (rx_buf[4] << 8) | rx_buf[5];
-            
-            if (start_addr >= hmodbus->data_map.holding_reg_count) {
-                Modbus_SendException(hmodbus, func_code, MB_EX_ILLEGAL_DATA_ADDRESS);
-                break;
-            }
-            
-            /* 写入前回调检查 */
-            if (hmodbus->write_cb != NULL) {
-                if (!hmodbus->write_cb(hmodbus, func_code, start_addr, 1)) {
-                    Modbus_SendException(hmodbus, func_code, MB_EX_SLAVE_DEVICE_FAILURE);
-                    break;
-                }
-            }
-            
-            /* 写入寄存器
-             * 注意: 寴于16位寄存器，Cortex-M内核可保证单次写入的原子性 */
-            hmodbus->data_map.holding_regs[start_addr] = val;
-            
-            /* 原样返回请求帧 */
-            memcpy(hmodbus->tx_buf, rx_buf, 6);
-            hmodbus->tx_buf[0] = hmodbus->slave_addr;
-            Modbus_SendResponse(hmodbus, 6);
-            break;
+    }
+    return NULL;
+}
+
+/**
+ * @brief   判断待处理帧的转发目标是否仍被占用
+ * @param   hmodbus 来源实例 (rx_ready 已置位)
+ * @retval  true    目标正在等待上一请求的应答或发送槽已满，请求应保持待处理
+ * @retval  false   非转发帧，或目标可立即发送
+ */
+static bool Modbus_BridgeBusy(const ModbusHandle_t *hmodbus) {
+    Modbus_Frame_t frame;
+    Modbus_RxFrameGet(hmodbus, &frame);
+    
+    const ModbusHandle_t *target = Modbus_BridgeTarget(hmodbus, Modbus_FrameByte(&frame, 0));
+    return target != NULL && target->tx_pool != NULL &&
+           (target->bridge_origin != NULL || target->tx_count >= target->tx_slots);
+}
+
+/**
+ * @brief   将路由地址的请求原样转发到下游实例
+ * @param   hmodbus 来源实例
+ * @param   frame   请求帧 (CRC已校验)
+ * @param   rx_len  请求帧长度 (含CRC)
+ * 
+ * @note    接收缓冲区随即用于下一帧，整帧复制到下游发送槽一次，保留原CRC不重新计算;
+ *          转发后通知下游实例，使仅由 ready_cb/Modbus_ProcessAll() 驱动时超时同样生效
+ */
+static void Modbus_BridgeForward(ModbusHandle_t *hmodbus, const Modbus_Frame_t *frame, uint16_t rx_len) {
+    uint8_t addr = Modbus_FrameByte(frame, 0);
+    uint8_t func_code = Modbus_FrameByte(frame, 1);
+    ModbusHandle_t *target = Modbus_BridgeTarget(hmodbus, addr);
+    
+    /* 目标未初始化为串口实例或请求放不下其发送槽: 路径不可用 */
+    if (target == NULL || rx_len > target->tx_buf_size) {
+        Modbus_BridgeException(hmodbus, addr, func_code, MB_EX_GATEWAY_PATH);
+        return;
+    }
+    
+    /* 下游中断快速路径与本次转发共用发送构建槽 */
+    uint8_t busy = target->process_busy;
+    target->process_busy = 1;
+    uint8_t *tx = Modbus_BridgeSlot(target);
+    if (tx == NULL) {
+        target->process_busy = busy;
+        Modbus_BridgeException(hmodbus, addr, func_code, MB_EX_GATEWAY_PATH);
+        return;
+    }
+    Modbus_FrameCopy(frame, 0, tx, rx_len);
+    
+    /* 先登记等待状态再发送: 应答首字节到达时接收中断即按等待地址接收 */
+    target->bridge_addr = addr;
+    target->bridge_func = func_code;
+    target->bridge_wait_ms = hmodbus->bridge_timeout_ms;
+    target->bridge_tick = HAL_GetTick();
+    target->bridge_origin = hmodbus;
+    MODBUS_STAT_INC(hmodbus, bridge_fwd);
+    
+    Modbus_SendFrame(target, rx_len);
+    target->process_busy = busy;
+    
+    /* 超时由下游实例的 Modbus_BridgePoll() 判定: 通知其处理，等待期间 Modbus_ProcessReady() 保持其就绪 */
+    Modbus_SignalReady(target);
+}
+
+/**
+ * @brief   将下游应答原样发回来源实例
+ * @param   hmodbus 下游实例
+ * @param   frame   等待中的应答帧 (地址与CRC已校验)
+ * @param   rx_len  应答帧长度 (含CRC)
+ * 
+ * @note    功能码 (不含异常标志位) 与请求不符的帧属于迟到的旧应答，丢弃后继续等待
+ */
+static void Modbus_BridgeReply(ModbusHandle_t *hmodbus, const Modbus_Frame_t *frame, uint16_t rx_len) {
+    if ((Modbus_FrameByte(frame, 1) & 0x7FU) != hmodbus->bridge_func) {
+        return;
+    }
+    
+    ModbusHandle_t *origin = hmodbus->bridge_origin;
+    hmodbus->bridge_origin = NULL;
+    
+    uint8_t busy = origin->process_busy;
+    origin->process_busy = 1;
+    uint8_t *tx = (rx_len <= origin->tx_buf_size) ? Modbus_BridgeSlot(origin) : NULL;
+    if (tx == NULL) {
+        MODBUS_STAT_INC(origin, tx_dropped);
+    } else {
+        Modbus_FrameCopy(frame, 0, tx, rx_len);
+        Modbus_SendFrame(origin, rx_len);
+    }
+    origin->process_busy = busy;
+    
+    /* 来源实例可能有等待本总线空闲的转发请求 */
+    Modbus_SignalReady(origin);
+}
+
+/**
+ * @brief   检查下游应答超时，超时后由来源实例返回 MB_EX_GATEWAY_TARGET
+ * @param   hmodbus 下游实例
+ */
+static void Modbus_BridgePoll(ModbusHandle_t *hmodbus) {
+    ModbusHandle_t *origin = hmodbus->bridge_origin;
+    if (origin == NULL || (uint32_t)(HAL_GetTick() - hmodbus->bridge_tick) < hmodbus->bridge_wait_ms) {
+        return;
+    }
+    
+    /* 此后到达的迟到应答在接收中断中按他站帧丢弃 */
+    hmodbus->bridge_origin = NULL;
+    MODBUS_STAT_INC(origin, bridge_timeout);
+    Modbus_BridgeException(origin, hmodbus->bridge_addr, hmodbus->bridge_func, MB_EX_GATEWAY_TARGET);
+    Modbus_SignalReady(origin);
+}
+
+/**
+ * @brief   取得实例的下一个空闲发送槽作为构建槽
+ * @param   hmodbus Modbus句柄指针
+ * @return  发送槽; 实例无发送缓冲区或发送槽已满时返回NULL
+ */
+static uint8_t *Modbus_BridgeSlot(ModbusHandle_t *hmodbus) {
+    if (hmodbus->tx_pool == NULL || hmodbus->tx_count >= hmodbus->tx_slots) {
+        return NULL;
+    }
+    hmodbus->tx_buf = MODBUS_TX_SLOT(hmodbus, (hmodbus->tx_head + hmodbus->tx_count) % hmodbus->tx_slots);
+    return hmodbus->tx_buf;
+}
+
+/**
+ * @brief   由来源实例代目标从站返回网关异常
+ * @param   origin          来源实例
+ * @param   addr            目标从站地址 (异常响应的地址字段)
+ * @param   func_code       请求的功能码
+ * @param   exception_code  MB_EX_GATEWAY_PATH 或 MB_EX_GATEWAY_TARGET
+ */
+static void Modbus_BridgeException(ModbusHandle_t *origin, uint8_t addr, uint8_t func_code, uint8_t exception_code) {
+    uint8_t busy = origin->process_busy;
+    origin->process_busy = 1;
+    
+    uint8_t *tx = Modbus_BridgeSlot(origin);
+    if (tx == NULL) {
+        MODBUS_STAT_INC(origin, tx_dropped);
+    } else {
+        (void)Modbus_ExceptionReply(origin, tx, func_code, exception_code);
+        tx[0] = addr;
+        Modbus_SendResponse(origin, 3);
+    }
+    origin->process_busy = busy;
+}
+
+/* ============================================================================
+ *                              响应缓存
+ * ============================================================================ */
+
+/**
+ * @brief   校验并清空响应缓存
+ * @param   hmodbus Modbus句柄指针
+ * @param   cache   响应缓存配置
+ * @retval  true    配置有效 (count 为0时不缓存)
+ * @retval  false   count 非0但缓存项数组为空
+ */
+static bool Modbus_CacheSetup(ModbusHandle_t *hmodbus, const Modbus_RespCacheConfig_t *cache) {
+    if (cache->count != 0 && cache->entries == NULL) {
+        return false;
+    }
+    
+    hmodbus->resp_cache = *cache;
+    hmodbus->resp_cache_next = 0;
+    for (uint32_t i = 0; i < cache->count; i++) {
+        cache->entries[i].len = 0;
+    }
+    return true;
+}
+
+/**
+ * @brief   判断请求是否可经响应缓存处理
+ * @param   func_code 功能码
+ * @param   rx_len    请求帧长度 (含CRC)
+ * @retval  true      标准长度的0x03/0x04请求，且分发表中仍为内置处理函数
+ */
+static bool Modbus_CacheCacheable(uint8_t func_code, uint16_t rx_len) {
+    if (rx_len != 8 || (func_code != MB_FUNC_READ_HOLDING && func_code != MB_FUNC_READ_INPUT)) {
+        return false;
+    }
+    
+    Modbus_FuncHandler_t builtin = s_fast_path_handlers[func_code - MB_FUNC_READ_COILS];
+    return builtin != NULL && s_func_table[func_code] == builtin;
+}
+
+/**
+ * @brief   按 (功能码, 起始地址, 数量) 查找缓存项
+ * @return  缓存项 (可能已过期); 未找到时返回NULL
+ */
+static Modbus_RespCacheEntry_t *Modbus_CacheFind(ModbusHandle_t *hmodbus, uint8_t func_code,
+                                                 uint16_t start, uint16_t quantity) {
+    for (uint32_t i = 0; i < hmodbus->resp_cache.count; i++) {
+        Modbus_RespCacheEntry_t *entry = &hmodbus->resp_cache.entries[i];
+        if (entry->len != 0 && entry->func_code == func_code && entry->start == start &&
+            entry->quantity == quantity) {
+            return entry;
         }
-        
-        case MB_FUNC_WRITE_MULTI_REGS:  /* 0x10: 写多个寄存器 */
-        {
-            if (hmodbus->data_map.holding_regs == NULL || hmodbus->data_map.holding_reg_count == 0) {
-                Modbus_SendException(hmodbus, func_code, MB_EX_ILLEGAL_FUNCTION);
-                break;
-            }
-            
-            start_addr = (rx_buf[2] << 8) | rx_buf[3];
-            quantity = (rx_buf[4] << 8) | rx_buf[5];
-            
-            if (start_addr + quantity > hmodbus->data_map.holding_reg_count) {
-                Modbus_SendException(hmodbus, func_code, MB_EX_ILLEGAL_DATA_ADDRESS);
-                break;
-            }
-            
-            /* 写入前回调检查 */
-            if (hmodbus->write_cb != NULL) {
-                if (!hmodbus->write_cb(hmodbus, func_code, start_addr, quantity)) {
-                    Modbus_SendException(hmodbus, func_code, MB_EX_SLAVE_DEVICE_FAILURE);
-                    break;
-                }
-            }
-            
-            /* 写入保持寄存器数据
-             * 注意: 批量写入共享数据时，建议使用临界区保护 */
-            for (i = 0; i < quantity; i++) {
-                hmodbus->data_map.holding_regs[start_addr + i] = 
-                    (rx_buf[7 + i * 2] << 8) | rx_buf[8 + i * 2];
-            }
-            
-            memcpy(&hmodbus->tx_buf[2], &rx_buf[2], 4);
-            Modbus_SendResponse(hmodbus, 6);
-            break;
-        }
-        
-        /* ================================================================
-         *                    输入寄存器处理 (Input Registers)
-         *                         功能码: 0x04
-         * ================================================================ */
-        case MB_FUNC_READ_INPUT:  /* 0x04: 读输入寄存器 */
-        {
-            if (hmodbus->data_map.input_regs == NULL || hmodbus->data_map.input_reg_count == 0) {
-                Modbus_SendException(hmodbus, func_code, MB_EX_ILLEGAL_FUNCTION);
-                break;
+    }
+    return NULL;
+}
+
+/**
+ * @brief   缓存命中且数据未变时重发已组帧的响应
+ * @param   hmodbus    Modbus句柄指针 (tx_buf 为当前构建槽)
+ * @param   frame      请求帧 (CRC已校验)
+ * @param   generation 当前数据版本
+ * @retval  true       已重发，请求处理完毕
+ * @retval  false      未命中，照常处理
+ */
+static bool Modbus_CacheReplay(ModbusHandle_t *hmodbus, const Modbus_Frame_t *frame, uint32_t generation) {
+    const Modbus_RespCacheEntry_t *entry = Modbus_CacheFind(hmodbus, Modbus_FrameByte(frame, 1),
+                                                            Modbus_FrameU16(frame, 2), Modbus_FrameU16(frame, 4));
+    if (entry == NULL || entry->generation != generation) {
+        return false;
+    }
+    
+    memcpy(hmodbus->tx_buf, entry->frame, entry->len);
+    MODBUS_STAT_INC(hmodbus, cache_hits);
+    Modbus_SendFrame(hmodbus, entry->len);
+    return true;
+}
+
+/**
+ * @brief   保存刚发出的读响应
+ * @param   hmodbus    Modbus句柄指针 (tx_buf 中为已带CRC的响应)
+ * @param   frame      请求帧
+ * @param   generation 读取数据区之前取样的数据版本
+ * 
+ * @note    仅在处理函数未返回异常时调用: 正常响应与流水线发送的响应均已在构建槽中带上CRC，
+ *          超出发送槽而未发送的响应按长度排除
+ */
+static void Modbus_CacheStore(ModbusHandle_t *hmodbus, const Modbus_Frame_t *frame, uint32_t generation) {
+    uint8_t func_code = Modbus_FrameByte(frame, 1);
+    uint16_t start = Modbus_FrameU16(frame, 2);
+    uint16_t quantity = Modbus_FrameU16(frame, 4);
+    uint16_t len = 3U + quantity * 2U + 2U;
+    
+    if (quantity > MODBUS_RESP_CACHE_MAX_REGS || len > hmodbus->tx_buf_size) {
+        return;
+    }
+    
+    /* 提供者段的数据随时变化，不缓存 */
+    Modbus_Area_t area = (func_code == MB_FUNC_READ_HOLDING) ? MODBUS_AREA_HOLDING : MODBUS_AREA_INPUT;
+    const Modbus_Segment_t *seg = Modbus_MapLookup(hmodbus, area, start, quantity, false);
+    if (seg == NULL || seg->read_cb != NULL) {
+        return;
+    }
+    
+    /* 同一请求沿用原项，否则依次替换 */
+    Modbus_RespCacheEntry_t *entry = Modbus_CacheFind(hmodbus, func_code, start, quantity);
+    if (entry == NULL) {
+        entry = &hmodbus->resp_cache.entries[hmodbus->resp_cache_next];
+        hmodbus->resp_cache_next = (uint8_t)((hmodbus->resp_cache_next + 1U) % hmodbus->resp_cache.count);
+    }
+    memcpy(entry->frame, hmodbus->tx_buf, len);
+    entry->func_code = func_code;
+    entry->start = start;
+    entry->quantity = quantity;
+    entry->generation = generation;
+    entry->len = len;
+}
+
+/* ============================================================================
+ *                              内置功能码处理函数
+ * ============================================================================ */
+
+/**
+ * @brief   注册功能码处理函数
+ */
+bool Modbus_RegisterFunction(uint8_t func_code, Modbus_FuncHandler_t handler) {
+    if (func_code == 0 || func_code >= MODBUS_FUNC_TABLE_SIZE) {
+        return false;
+    }
+    
+    s_func_table[func_code] = handler;
+    return true;
+}
+
+#if MODBUS_FC_01_ENABLED || MODBUS_FC_02_ENABLED
+/**
+ * @brief   读位 (0x01/0x02) 公共处理
+ * @param   hmodbus Modbus句柄指针
+ * @param   req     预解析的请求
+ * @param   tx      响应缓冲区
+ * @param   area    数据区 (线圈或离散输入)
+ * @return  响应长度或异常
+ */
+static uint16_t Modbus_FC_ReadBits(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx,
+                                   Modbus_Area_t area) {
+    /* 检查是否支持此功能 */
+    if (MODBUS_SEG_COUNT(hmodbus, area) == 0) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_FUNCTION);
+    }
+    
+    uint16_t start_addr = req->addr;
+    uint16_t quantity = req->value;
+    
+    /* 参数校验 */
+    if (quantity < 1 || quantity > 2000) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_DATA_VALUE);
+    }
+    const Modbus_Segment_t *seg = Modbus_MapLookup(hmodbus, area, start_addr, quantity, false);
+    if (seg == NULL) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_DATA_ADDRESS);
+    }
+    
+    /* 响应超出发送槽时不应答 (不得越界组帧) */
+    uint8_t byte_count = (quantity + 7) / 8;
+    if (3U + byte_count > req->tx_size) {
+        MODBUS_STAT_INC(hmodbus, tx_dropped);
+        return MODBUS_REPLY_NONE;
+    }
+    if (!Modbus_MapFetch(hmodbus, seg, start_addr, quantity)) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_SLAVE_DEVICE_FAILURE);
+    }
+    
+    tx[2] = byte_count;
+    
+    /* 读取位状态并打包响应
+     * 注意: 访问共享数据时，在高安全要求场景应使用临界区保护 */
+    if (!Modbus_MapRead(seg, &tx[3], start_addr, quantity, true, MODBUS_SEQLOCK_RETRIES)) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_SLAVE_DEVICE_BUSY);
+    }
+    return 3 + byte_count;
+}
+#endif
+
+#if MODBUS_FC_03_ENABLED || MODBUS_FC_04_ENABLED
+/**
+ * @brief   读寄存器 (0x03/0x04) 公共处理
+ * @param   hmodbus Modbus句柄指针
+ * @param   req     预解析的请求
+ * @param   tx      响应缓冲区
+ * @param   area    数据区 (保持寄存器或输入寄存器)
+ * @return  响应长度或异常; 流水线发送时已自行发出响应，返回 MODBUS_REPLY_NONE
+ */
+static uint16_t Modbus_FC_ReadRegs(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx,
+                                   Modbus_Area_t area) {
+    if (MODBUS_SEG_COUNT(hmodbus, area) == 0) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_FUNCTION);
+    }
+    
+    uint16_t start_addr = req->addr;
+    uint16_t quantity = req->value;
+    
+    if (quantity < 1 || quantity > 125) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_DATA_VALUE);
+    }
+    const Modbus_Segment_t *seg = Modbus_MapLookup(hmodbus, area, start_addr, quantity, false);
+    if (seg == NULL) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_DATA_ADDRESS);
+    }
+    
+    /* 响应超出发送槽时不应答 (不得越界组帧) */
+    if (3U + quantity * 2U > req->tx_size) {
+        MODBUS_STAT_INC(hmodbus, tx_dropped);
+        return MODBUS_REPLY_NONE;
+    }
+    if (!Modbus_MapFetch(hmodbus, seg, start_addr, quantity)) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_SLAVE_DEVICE_FAILURE);
+    }
+    
+    tx[2] = quantity * 2;
+    
+    /* 带顺序锁的段须先取得一致快照再发出帧头，其余情况数据填充与帧头发送同时进行
+     * (仅在本实例发送槽中组帧时先行发送帧头; Modbus_Execute() 的缓冲区由调用者发送) */
+    if (seg->seqlock != NULL &&
+        !Modbus_MapRead(seg, &tx[3], start_addr, quantity, false, MODBUS_SEQLOCK_RETRIES)) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_SLAVE_DEVICE_BUSY);
+    }
+    if (tx == hmodbus->tx_buf) {
+        Modbus_SendPipelinedHeader(hmodbus, 3 + quantity * 2);
+    }
+    
+    if (seg->seqlock == NULL) {
+        /* 读取寄存器数据
+         * 注意: 对于16位寄存器，Cortex-M内核可保证单次读取的原子性 */
+        Modbus_RegsToBytes(&tx[3], (const uint16_t *)seg->data + (start_addr - seg->base), quantity);
+    }
+    
+    /* 帧头未先行发送: 与其他功能码相同，整帧由调用者发送 */
+    if (hmodbus->tx_pipe_state == MODBUS_TX_PIPE_IDLE || tx != hmodbus->tx_buf) {
+        return 3 + quantity * 2;
+    }
+    Modbus_SendPipelinedBody(hmodbus, 3 + quantity * 2);
+    return MODBUS_REPLY_NONE;
+}
+#endif
+
+#if MODBUS_FC_01_ENABLED
+/**
+ * @brief   0x01: 读线圈状态
+ */
+static uint16_t Modbus_FC01_ReadCoils(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx) {
+    return Modbus_FC_ReadBits(hmodbus, req, tx, MODBUS_AREA_COILS);
+}
+#endif
+
+#if MODBUS_FC_02_ENABLED
+/**
+ * @brief   0x02: 读离散输入
+ */
+static uint16_t Modbus_FC02_ReadDiscrete(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx) {
+    return Modbus_FC_ReadBits(hmodbus, req, tx, MODBUS_AREA_DISCRETE);
+}
+#endif
+
+#if MODBUS_FC_03_ENABLED
+/**
+ * @brief   0x03: 读保持寄存器
+ */
+static uint16_t Modbus_FC03_ReadHolding(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx) {
+    return Modbus_FC_ReadRegs(hmodbus, req, tx, MODBUS_AREA_HOLDING);
+}
+#endif
+
+#if MODBUS_FC_04_ENABLED
+/**
+ * @brief   0x04: 读输入寄存器
+ */
+static uint16_t Modbus_FC04_ReadInput(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx) {
+    return Modbus_FC_ReadRegs(hmodbus, req, tx, MODBUS_AREA_INPUT);
+}
+#endif
+
+#if MODBUS_FC_05_ENABLED
+/**
+ * @brief   0x05: 写单个线圈
+ */
+static uint16_t Modbus_FC05_WriteCoil(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx) {
+    if (MODBUS_SEG_COUNT(hmodbus, MODBUS_AREA_COILS) == 0) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_FUNCTION);
+    }
+    
+    uint16_t start_addr = req->addr;
+    uint16_t val = req->value;
+    
+    const Modbus_Segment_t *seg = Modbus_MapLookup(hmodbus, MODBUS_AREA_COILS, start_addr, 1, true);
+    if (seg == NULL) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_DATA_ADDRESS);
+    }
+    
+    /* 写入前检查: 事件队列余量与 write_cb */
+    uint16_t reject = Modbus_WriteCheck(hmodbus, req->func_code, start_addr, 1);
+    if (reject != 0) {
+        return reject;
+    }
+    
+    /* 0xFF00=置位, 0x0000=复位
+     * 注意: 写入共享数据时，在高安全要求场景应使用原子操作 */
+    uint8_t *bits = (uint8_t *)seg->data;
+    uint16_t bit_idx = start_addr - seg->base;
+    Modbus_MapWriteBegin(seg);
+    if (val == 0xFF00) {
+        bits[bit_idx / 8] |= (1 << (bit_idx % 8));
+    } else if (val == 0x0000) {
+        bits[bit_idx / 8] &= ~(1 << (bit_idx % 8));
+    }
+    Modbus_MapWriteEnd(hmodbus, seg, MODBUS_AREA_COILS, start_addr,
+                       (val == 0xFF00 || val == 0x0000) ? 1 : 0);
+    
+    /* 原样返回请求帧 */
+    Modbus_FrameCopy(&req->frame, 2, &tx[2], 4);
+    return 6;
+}
+#endif
+
+#if MODBUS_FC_06_ENABLED
+/**
+ * @brief   0x06: 写单个寄存器
+ */
+static uint16_t Modbus_FC06_WriteReg(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx) {
+    if (MODBUS_SEG_COUNT(hmodbus, MODBUS_AREA_HOLDING) == 0) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_FUNCTION);
+    }
+    
+    uint16_t start_addr = req->addr;
+    
+    const Modbus_Segment_t *seg = Modbus_MapLookup(hmodbus, MODBUS_AREA_HOLDING, start_addr, 1, true);
+    if (seg == NULL) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_DATA_ADDRESS);
+    }
+    
+    /* 写入前检查: 事件队列余量与 write_cb */
+    uint16_t reject = Modbus_WriteCheck(hmodbus, req->func_code, start_addr, 1);
+    if (reject != 0) {
+        return reject;
+    }
+    
+    /* 写入寄存器
+     * 注意: 寴于16位寄存器，Cortex-M内核可保证单次写入的原子性 */
+    Modbus_MapWriteBegin(seg);
+    ((uint16_t *)seg->data)[start_addr - seg->base] = req->value;
+    Modbus_MapWriteEnd(hmodbus, seg, MODBUS_AREA_HOLDING, start_addr, 1);
+    
+    /* 原样返回请求帧 */
+    Modbus_FrameCopy(&req->frame, 2, &tx[2], 4);
+    return 6;
+}
+#endif
+
+#if MODBUS_FC_08_ENABLED
+/**
+ * @brief   0x08: 诊断
+ * @note    子功能码见 MB_DIAG_xxx; 0x01仅清除计数器，不重启串口也不进入只听模式
+ */
+static uint16_t Modbus_FC08_Diagnostics(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx) {
+    /* 帧格式: [Addr][08][SubHi][SubLo][Data...][CRC][CRC] */
+    if (req->length < 8) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_DATA_VALUE);
+    }
+    
+    uint16_t sub_func = req->addr;
+    uint32_t count;
+    
+    switch (sub_func) {
+        case MB_DIAG_RETURN_QUERY_DATA:
+            /* 原样回送子功能码与全部数据 */
+            if (req->length - 2 > req->tx_size) {
+                MODBUS_STAT_INC(hmodbus, tx_dropped);
+                return MODBUS_REPLY_NONE;
             }
+            Modbus_FrameCopy(&req->frame, 2, &tx[2], req->length - 4);
+            return req->length - 2;
             
-            start_addr = (rx_buf[2] << 8) | rx_buf[3];
-            quantity = (rx_buf[4] << 8) | rx_buf[5];
-            
-            if (quantity < 1 || quantity > 125) {
-                Modbus_SendException(hmodbus, func_code, MB_EX_ILLEGAL_DATA_VALUE);
-                break;
+#if MODBUS_STATS_TIMING
+        case MB_DIAG_TIMING_HISTOGRAM: {
+            /* 响应: [SubHi][SubLo][阶段Hi][阶段Lo][MaxUsHi][MaxUsLo][MaxFC][桶数][桶计数Hi/Lo...] */
+            if (req->length != 8 || req->value >= MODBUS_TIMING_COUNT) {
+                return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_DATA_VALUE);
             }
-            if (start_addr + quantity > hmodbus->data_map.input_reg_count) {
-                Modbus_SendException(hmodbus, func_code, MB_EX_ILLEGAL_DATA_ADDRESS);
-                break;
+            if (10 + MODBUS_HIST_BUCKETS * 2 > req->tx_size) {
+                MODBUS_STAT_INC(hmodbus, tx_dropped);
+                return MODBUS_REPLY_NONE;
             }
             
-            hmodbus->tx_buf[2] = quantity * 2;
-            
-            /* 读取输入寄存器数据 */
-            for (i = 0; i < quantity; i++) {
-                hmodbus->tx_buf[3 + i * 2] = (hmodbus->data_map.input_regs[start_addr + i] >> 8) & 0xFF;
-                hmodbus->tx_buf[4 + i * 2] = hmodbus->data_map.input_regs[start_addr + i] & 0xFF;
+            const Modbus_Histogram_t *hist = &hmodbus->stats.timing[req->value];
+            uint32_t max_us = (hist->max_us > 0xFFFFU) ? 0xFFFFU : hist->max_us;
+            Modbus_FrameCopy(&req->frame, 2, &tx[2], 4);
+            tx[6] = (max_us >> 8) & 0xFF;
+            tx[7] = max_us & 0xFF;
+            tx[8] = hist->max_func_code;
+            tx[9] = MODBUS_HIST_BUCKETS;
+            for (uint16_t i = 0; i < MODBUS_HIST_BUCKETS; i++) {
+                uint32_t n = (hist->bucket[i] > 0xFFFFU) ? 0xFFFFU : hist->bucket[i];
+                tx[10 + i * 2] = (n >> 8) & 0xFF;
+                tx[11 + i * 2] = n & 0xFF;
             }
-            Modbus_SendResponse(hmodbus, 3 + quantity * 2);
-            break;
+            return 10 + MODBUS_HIST_BUCKETS * 2;
         }
-        
-        /* ================================================================
-         *                    自定义配置功能码 (0x64)
-         *             通过回调函数实现，应用层处理Flash等操作
-         * ================================================================ */
-        case MB_FUNC_CUSTOM_CONFIG:  /* 0x64: 自定义配置指令 */
-        {
-            /* 帧格式: [Addr][64][RegHi][RegLo][ValHi][ValLo][CRC][CRC]
-             * 长度固定为8字节 */
-            if (rx_len != 8) {
-                Modbus_SendException(hmodbus, func_code, MB_EX_ILLEGAL_DATA_VALUE);
-                break;
-            }
+#endif
             
-            uint16_t param_addr = (rx_buf[2] << 8) | rx_buf[3];
-            uint16_t param_val  = (rx_buf[4] << 8) | rx_buf[5];
-            
-            /* 检查是否注册了回调函数 */
-            if (hmodbus->custom_config_cb == NULL) {
-                Modbus_SendException(hmodbus, func_code, MB_EX_ILLEGAL_FUNCTION);
-                break;
+        case MB_DIAG_RESTART_COMM:
+        case MB_DIAG_CLEAR_COUNTERS:
+            if (req->length != 8) {
+                return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_DATA_VALUE);
             }
+            Modbus_StatsReset(hmodbus);
+            Modbus_FrameCopy(&req->frame, 2, &tx[2], 4);
+            return 6;
             
-            /* 调用回调函数处理配置
-             * 回调内部应处理:
-             * - param_addr=0x0000: 修改从站地址
-             * - param_addr=0x0001: 修改波特率
-             * - 其他地址: 用户自定义参数 */
-            if (hmodbus->custom_config_cb(hmodbus, param_addr, param_val)) {
-                /* 处理成功，发送确认响应 */
-                memcpy(hmodbus->tx_buf, rx_buf, 6);
-                hmodbus->tx_buf[0] = hmodbus->slave_addr;
-                Modbus_SendResponse(hmodbus, 6);
-            } else {
-                /* 处理失败，发送异常响应 */
-                Modbus_SendException(hmodbus, func_code, MB_EX_ILLEGAL_DATA_VALUE);
-            }
-            break;
+        case MB_DIAG_RETURN_REGISTER:     count = 0;                            break;
+        case MB_DIAG_BUS_MESSAGE_COUNT:   count = hmodbus->stats.bus_msg;       break;
+        case MB_DIAG_BUS_COMM_ERROR_COUNT: count = hmodbus->stats.bus_comm_err; break;
+        case MB_DIAG_BUS_EXCEPTION_COUNT: count = hmodbus->stats.bus_exception; break;
+        case MB_DIAG_SLAVE_MESSAGE_COUNT: count = hmodbus->stats.slave_msg;     break;
+        case MB_DIAG_SLAVE_NO_RESP_COUNT: count = hmodbus->stats.slave_no_resp; break;
+        case MB_DIAG_SLAVE_NAK_COUNT:     count = 0;                            break;
+        case MB_DIAG_SLAVE_BUSY_COUNT:    count = hmodbus->stats.slave_busy;    break;
+        case MB_DIAG_BUS_OVERRUN_COUNT:   count = hmodbus->stats.bus_overrun;   break;
+            
+        default:
+            return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_FUNCTION);
+    }
+    
+    /* 计数器类子功能码: 数据字段须为0x0000，返回计数低16位 */
+    if (req->length != 8 || req->value != 0) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_DATA_VALUE);
+    }
+    tx[2] = (sub_func >> 8) & 0xFF;
+    tx[3] = sub_func & 0xFF;
+    tx[4] = (count >> 8) & 0xFF;
+    tx[5] = count & 0xFF;
+    return 6;
+}
+#endif
+
+#if MODBUS_FC_0F_ENABLED
+/**
+ * @brief   0x0F: 写多个线圈
+ */
+static uint16_t Modbus_FC0F_WriteCoils(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx) {
+    if (MODBUS_SEG_COUNT(hmodbus, MODBUS_AREA_COILS) == 0) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_FUNCTION);
+    }
+    
+    uint16_t start_addr = req->addr;
+    uint16_t quantity = req->value;
+    uint8_t byte_count = req->byte_count;
+    
+    /* 参数校验: 数据字节数须与数量一致且完整包含在帧内 */
+    if (quantity < 1 || quantity > 1968 || byte_count != (quantity + 7) / 8 ||
+        req->length < 9 + byte_count) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_DATA_VALUE);
+    }
+    const Modbus_Segment_t *seg = Modbus_MapLookup(hmodbus, MODBUS_AREA_COILS, start_addr, quantity, true);
+    if (seg == NULL) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_DATA_ADDRESS);
+    }
+    
+    /* 写入前检查: 事件队列余量与 write_cb */
+    uint16_t reject = Modbus_WriteCheck(hmodbus, req->func_code, start_addr, quantity);
+    if (reject != 0) {
+        return reject;
+    }
+    
+    /* 写入线圈状态
+     * 注意: 批量写入共享数据时，建议使用临界区保护 */
+    Modbus_MapWriteBegin(seg);
+    Modbus_FrameToBits(&req->frame, 7, (uint8_t *)seg->data, start_addr - seg->base, quantity);
+    Modbus_MapWriteEnd(hmodbus, seg, MODBUS_AREA_COILS, start_addr, quantity);
+    
+    Modbus_FrameCopy(&req->frame, 2, &tx[2], 4);
+    return 6;
+}
+#endif
+
+#if MODBUS_FC_10_ENABLED
+/**
+ * @brief   0x10: 写多个寄存器
+ */
+static uint16_t Modbus_FC10_WriteRegs(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx) {
+    if (MODBUS_SEG_COUNT(hmodbus, MODBUS_AREA_HOLDING) == 0) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_FUNCTION);
+    }
+    
+    uint16_t start_addr = req->addr;
+    uint16_t quantity = req->value;
+    uint8_t byte_count = req->byte_count;
+    
+    /* 参数校验: 数据字节数须与数量一致且完整包含在帧内 */
+    if (quantity < 1 || quantity > 123 || byte_count != quantity * 2 ||
+        req->length < 9 + byte_count) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_DATA_VALUE);
+    }
+    const Modbus_Segment_t *seg = Modbus_MapLookup(hmodbus, MODBUS_AREA_HOLDING, start_addr, quantity, true);
+    if (seg == NULL) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_DATA_ADDRESS);
+    }
+    
+    /* 写入前检查: 事件队列余量与 write_cb */
+    uint16_t reject = Modbus_WriteCheck(hmodbus, req->func_code, start_addr, quantity);
+    if (reject != 0) {
+        return reject;
+    }
+    
+    /* 写入保持寄存器数据
+     * 注意: 批量写入共享数据时，建议使用临界区保护 */
+    Modbus_MapWriteBegin(seg);
+    Modbus_FrameToRegs(&req->frame, 7, (uint16_t *)seg->data + (start_addr - seg->base), quantity);
+    Modbus_MapWriteEnd(hmodbus, seg, MODBUS_AREA_HOLDING, start_addr, quantity);
+    
+    Modbus_FrameCopy(&req->frame, 2, &tx[2], 4);
+    return 6;
+}
+#endif
+
+#if MODBUS_FC_16_ENABLED
+/**
+ * @brief   0x16: 屏蔽写寄存器
+ * 
+ * @note    结果 = (当前值 AND And_Mask) OR (Or_Mask AND (NOT And_Mask))，
+ *          读-改-写在数据区锁内一次完成，替代主站"读-修改-写"三次事务
+ */
+static uint16_t Modbus_FC16_MaskWriteReg(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx) {
+    if (MODBUS_SEG_COUNT(hmodbus, MODBUS_AREA_HOLDING) == 0) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_FUNCTION);
+    }
+    
+    /* 帧格式: [Addr][16][RefHi][RefLo][AndHi][AndLo][OrHi][OrLo][CRC][CRC] */
+    if (req->length != 10) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_DATA_VALUE);
+    }
+    
+    uint16_t start_addr = req->addr;
+    uint16_t and_mask = req->value;
+    uint16_t or_mask = Modbus_FrameU16(&req->frame, 6);
+    
+    const Modbus_Segment_t *seg = Modbus_MapLookup(hmodbus, MODBUS_AREA_HOLDING, start_addr, 1, true);
+    if (seg == NULL) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_DATA_ADDRESS);
+    }
+    
+    /* 写入前检查: 事件队列余量与 write_cb */
+    uint16_t reject = Modbus_WriteCheck(hmodbus, req->func_code, start_addr, 1);
+    if (reject != 0) {
+        return reject;
+    }
+    
+    /* 带提供者的段先刷新当前值 */
+    if (!Modbus_MapFetch(hmodbus, seg, start_addr, 1)) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_SLAVE_DEVICE_FAILURE);
+    }
+    
+    uint16_t *reg = (uint16_t *)seg->data + (start_addr - seg->base);
+    Modbus_MapWriteBegin(seg);
+    *reg = (uint16_t)((*reg & and_mask) | (or_mask & (uint16_t)~and_mask));
+    Modbus_MapWriteEnd(hmodbus, seg, MODBUS_AREA_HOLDING, start_addr, 1);
+    
+    /* 原样返回请求帧 */
+    Modbus_FrameCopy(&req->frame, 2, &tx[2], 6);
+    return 8;
+}
+#endif
+
+#if MODBUS_FC_17_ENABLED
+/**
+ * @brief   0x17: 读写多个寄存器
+ * 
+ * @note    先写后读，写入与回读在数据区锁内一次完成，替代主站 0x10 + 0x03 两次事务;
+ *          回读范围可与写入范围重叠，读到的是本次写入后的值
+ */
+static uint16_t Modbus_FC17_ReadWriteRegs(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx) {
+    if (MODBUS_SEG_COUNT(hmodbus, MODBUS_AREA_HOLDING) == 0) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_FUNCTION);
+    }
+    
+    /* 帧格式: [Addr][17][读起始2][读数量2][写起始2][写数量2][字节数][数据N][CRC][CRC]
+     * 先确认固定字段完整，再读取第6~10字节 (短帧时这些位置可能已超出接收缓冲区) */
+    if (req->length < 13) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_DATA_VALUE);
+    }
+    uint16_t read_addr = req->addr;
+    uint16_t read_qty = req->value;
+    uint16_t write_addr = Modbus_FrameU16(&req->frame, 6);
+    uint16_t write_qty = Modbus_FrameU16(&req->frame, 8);
+    uint8_t byte_count = Modbus_FrameByte(&req->frame, 10);
+    
+    /* 参数校验: 写入数据须完整包含在帧内，回读数据须能装入响应 */
+    if (read_qty < 1 || read_qty > 125 || write_qty < 1 || write_qty > 121 ||
+        byte_count != write_qty * 2 || req->length < 13 + byte_count ||
+        3 + read_qty * 2 > req->tx_size) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_DATA_VALUE);
+    }
+    const Modbus_Segment_t *write_seg = Modbus_MapLookup(hmodbus, MODBUS_AREA_HOLDING, write_addr, write_qty, true);
+    const Modbus_Segment_t *read_seg = Modbus_MapLookup(hmodbus, MODBUS_AREA_HOLDING, read_addr, read_qty, false);
+    if (write_seg == NULL || read_seg == NULL) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_DATA_ADDRESS);
+    }
+    
+    /* 写入前检查: 事件队列余量与 write_cb */
+    uint16_t reject = Modbus_WriteCheck(hmodbus, req->func_code, write_addr, write_qty);
+    if (reject != 0) {
+        return reject;
+    }
+    
+    Modbus_MapWriteBegin(write_seg);
+    Modbus_FrameToRegs(&req->frame, 11, (uint16_t *)write_seg->data + (write_addr - write_seg->base), write_qty);
+    Modbus_MapWriteEnd(hmodbus, write_seg, MODBUS_AREA_HOLDING, write_addr, write_qty);
+    
+    /* 写入已生效: 回读失败时仍以异常应答 */
+    if (!Modbus_MapFetch(hmodbus, read_seg, read_addr, read_qty)) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_SLAVE_DEVICE_FAILURE);
+    }
+    
+    tx[2] = (uint8_t)(read_qty * 2);
+    if (!Modbus_MapRead(read_seg, &tx[3], read_addr, read_qty, false, MODBUS_SEQLOCK_RETRIES)) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_SLAVE_DEVICE_BUSY);
+    }
+    return 3 + read_qty * 2;
+}
+#endif
+
+#if MODBUS_FC_64_ENABLED
+/**
+ * @brief   0x64: 自定义配置指令 (通过回调函数实现，应用层处理Flash等操作)
+ */
+static uint16_t Modbus_FC64_CustomConfig(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx) {
+    /* 帧格式: [Addr][64][RegHi][RegLo][ValHi][ValLo][CRC][CRC]
+     * 长度固定为8字节 */
+    if (req->length != 8) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_DATA_VALUE);
+    }
+    
+    /* 检查是否注册了回调函数 */
+    if (hmodbus->custom_config_cb == NULL) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_FUNCTION);
+    }
+    
+    /* 延后执行: 仅做快速校验，确认后登记事件，回调由 Modbus_EventDispatch() 调用 */
+    if (hmodbus->event_queue.defer_config) {
+        uint16_t reject = Modbus_WriteCheck(hmodbus, req->func_code, req->addr, req->value);
+        if (reject != 0) {
+            return reject;
         }
+        Modbus_EventPublish(hmodbus);
         
-        default:
-            /* 不支持的功能码 */
-            Modbus_SendException(hmodbus, func_code, MB_EX_ILLEGAL_FUNCTION);
+        tx[0] = hmodbus->slave_addr;
+        Modbus_FrameCopy(&req->frame, 2, &tx[2], 4);
+        return 6;
+    }
+    
+    /* 调用回调函数处理配置
+     * 回调内部应处理:
+     * - param_addr=0x0000: 修改从站地址
+     * - param_addr=0x0001: 修改波特率
+     * - 其他地址: 用户自定义参数 */
+    if (!hmodbus->custom_config_cb(hmodbus, req->addr, req->value)) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_DATA_VALUE);
+    }
+    
+    /* 处理成功，发送确认响应 (回调可能已修改从站地址，以新地址应答) */
+    tx[0] = hmodbus->slave_addr;
+    Modbus_FrameCopy(&req->frame, 2, &tx[2], 4);
+    return 6;
+}
+#endif
+
+/* ============================================================================
+ *                              统计与诊断
+ * ============================================================================ */
+
+#if MODBUS_STATS_ENABLED
+/**
+ * @brief   清零实例统计与耗时直方图
+ */
+void Modbus_StatsReset(ModbusHandle_t *hmodbus) {
+    if (hmodbus == NULL) {
+        return;
+    }
+    
+    /* 计数器也在中断中更新，清零期间关中断 */
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    memset(&hmodbus->stats, 0, sizeof(hmodbus->stats));
+    __set_PRIMASK(primask);
+    
+#if MODBUS_STATS_TIMING
+    hmodbus->cycles_per_us = SystemCoreClock / 1000000U;
+    if (hmodbus->cycles_per_us == 0) {
+        hmodbus->cycles_per_us = 1;
+    }
+#endif
+}
+#endif
+
+#if MODBUS_STATS_TIMING
+/**
+ * @brief   记录一次耗时样本
+ * @param   hmodbus   Modbus句柄指针
+ * @param   stage     测量阶段
+ * @param   start     起始周期计数
+ * @param   func_code 样本对应的功能码
+ * 
+ * @note    按 MODBUS_HIST_BASE_US 的二次幂分桶，用 __CLZ 求桶号，无除法循环
+ */
+static void Modbus_TimingRecord(ModbusHandle_t *hmodbus, Modbus_Timing_t stage, uint32_t start, uint8_t func_code) {
+    Modbus_Histogram_t *hist = &hmodbus->stats.timing[stage];
+    uint32_t us = (DWT->CYCCNT - start) / hmodbus->cycles_per_us;
+    uint32_t v = us / MODBUS_HIST_BASE_US;
+    uint32_t idx = (v != 0) ? (32U - __CLZ(v)) : 0;
+    
+    if (idx >= MODBUS_HIST_BUCKETS) {
+        idx = MODBUS_HIST_BUCKETS - 1;
+    }
+    hist->bucket[idx]++;
+    if (us > hist->max_us) {
+        hist->max_us = us;
+        hist->max_func_code = func_code;
+    }
+}
+#endif
+
+/**
+ * @brief   结束当前帧的解析计时 (每帧仅记录一次)
+ */
+static void Modbus_TimingParseEnd(ModbusHandle_t *hmodbus) {
+#if MODBUS_STATS_TIMING
+    if (hmodbus->parse_timing) {
+        hmodbus->parse_timing = false;
+        Modbus_TimingRecord(hmodbus, MODBUS_TIMING_PARSE, hmodbus->parse_stamp, hmodbus->parse_func_code);
+    }
+#else
+    (void)hmodbus;
+#endif
+}
+
+/**
+ * @brief   记录响应启动发送的时刻
+ */
+static void Modbus_TimingTxBegin(ModbusHandle_t *hmodbus) {
+#if MODBUS_STATS_TIMING
+    hmodbus->tx_stamp = DWT->CYCCNT;
+#else
+    (void)hmodbus;
+#endif
+}
+
+/**
+ * @brief   记录响应发送耗时
+ * @param   hmodbus   Modbus句柄指针
+ * @param   func_code 响应帧功能码 (异常响应含0x80位)
+ */
+static void Modbus_TimingTxEnd(ModbusHandle_t *hmodbus, uint8_t func_code) {
+#if MODBUS_STATS_TIMING
+    Modbus_TimingRecord(hmodbus, MODBUS_TIMING_TX, hmodbus->tx_stamp, func_code);
+#else
+    (void)hmodbus;
+    (void)func_code;
+#endif
+}
+
+/* ============================================================================
+ *                              多实例分发接口
+ * ============================================================================ */
+
+#if MODBUS_MAX_INSTANCES > 0
+
+/**
+ * @brief   按UART查找已登记的Modbus实例
+ */
+ModbusHandle_t *Modbus_FindByUart(const UART_HandleTypeDef *huart) {
+    if (huart == NULL) {
+        return NULL;
+    }
+    
+    /* 线性探测: 遇到空位即表示未登记 */
+    uint32_t key = MODBUS_REGISTRY_HASH(huart->Instance);
+    for (uint32_t n = 0; n < MODBUS_REGISTRY_HASH_SIZE; n++) {
+        uint8_t entry = s_registry_hash[(key + n) & (MODBUS_REGISTRY_HASH_SIZE - 1U)];
+        if (entry == 0) {
             break;
+        }
+        if (s_registry_slots[entry - 1].instance == huart->Instance) {
+            return s_registry_slots[entry - 1].handle;
+        }
+    }
+    
+    return NULL;
+}
+
+/**
+ * @brief   接收事件分发
+ */
+void Modbus_DispatchRxEvent(UART_HandleTypeDef *huart, uint16_t size) {
+    Modbus_RxCallback(Modbus_FindByUart(huart), size);
+}
+
+/**
+ * @brief   发送完成分发
+ */
+void Modbus_DispatchTxCplt(UART_HandleTypeDef *huart) {
+    Modbus_TxCallback(Modbus_FindByUart(huart));
+}
+
+/**
+ * @brief   处理所有就绪实例
+ */
+void Modbus_ProcessAll(void) {
+    (void)Modbus_ProcessReady(0xFFFFFFFFUL);
+}
+
+/**
+ * @brief   处理指定槽位中的就绪实例
+ */
+bool Modbus_ProcessReady(uint32_t slot_mask) {
+    /* 取出并清空所选就绪位; 处理期间中断置位的新就绪位留待下次调用 */
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint32_t ready = s_registry_ready & slot_mask;
+    s_registry_ready &= ~ready;
+    __set_PRIMASK(primask);
+    
+    bool pending = false;
+    while (ready != 0U) {
+        uint32_t slot = 31U - __CLZ(ready & (0U - ready));  /* 最低置位 */
+        ready &= ready - 1U;
+        
+        ModbusHandle_t *hmodbus = s_registry_slots[slot].handle;
+        Modbus_Process(hmodbus);
+        
+        /* 请求因发送槽占用仍挂起、排队响应等待帧间隔、写入变更等待合并窗口或转发请求等待应答:
+         * 保持就绪 (不重复通知) */
+        if (hmodbus->rx_ready || hmodbus->tx_state == MODBUS_TX_TURNAROUND || hmodbus->commit_count != 0 ||
+            hmodbus->bridge_origin != NULL) {
+            Modbus_MarkReady(hmodbus);
+            pending = true;
+        }
+    }
+    
+    return pending;
+}
+
+/**
+ * @brief   检查网关路由两端是否落在同一处理分组
+ */
+bool Modbus_RoutesGrouped(uint32_t group_count) {
+    if (group_count == 0) {
+        return false;
+    }
+    
+    for (uint32_t slot = 0; slot < s_registry_count; slot++) {
+        const ModbusHandle_t *hmodbus = s_registry_slots[slot].handle;
+        
+        for (uint32_t i = 0; i < hmodbus->bridge_route_count; i++) {
+            const ModbusHandle_t *target = hmodbus->bridge_routes[i].target;
+            if (target->registry_slot >= MODBUS_MAX_INSTANCES ||
+                target->registry_slot % group_count != slot % group_count) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief   登记实例到注册表
+ * @param   hmodbus Modbus句柄指针 (huart/transport已赋值)
+ * @retval  true    登记成功
+ * @retval  false   注册表已满
+ * 
+ * @note    同一句柄或同一UART(传输层上下文)重复初始化时复用原槽;
+ *          每次登记后重建散列表，仅在初始化时执行
+ */
+static bool Modbus_Register(ModbusHandle_t *hmodbus) {
+    const void *instance;
+    if (hmodbus->transport != NULL) {
+        instance = (hmodbus->transport_ctx != NULL) ? hmodbus->transport_ctx : (const void *)hmodbus;
+    } else {
+        instance = hmodbus->huart->Instance;
+    }
+    uint32_t slot;
+    
+    for (slot = 0; slot < s_registry_count; slot++) {
+        if (s_registry_slots[slot].handle == hmodbus || s_registry_slots[slot].instance == instance) {
+            break;
+        }
+    }
+    if (slot == s_registry_count) {
+        if (s_registry_count >= MODBUS_MAX_INSTANCES) {
+            return false;
+        }
+        s_registry_count++;
+    }
+    
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    s_registry_slots[slot].instance = instance;
+    s_registry_slots[slot].handle = hmodbus;
+    hmodbus->registry_slot = (uint8_t)slot;
+    s_registry_ready &= ~(1UL << slot);
+    
+    /* 重建散列表 */
+    memset(s_registry_hash, 0, sizeof(s_registry_hash));
+    for (uint32_t i = 0; i < s_registry_count; i++) {
+        uint32_t key = MODBUS_REGISTRY_HASH(s_registry_slots[i].instance);
+        while (s_registry_hash[key] != 0) {
+            key = (key + 1U) & (MODBUS_REGISTRY_HASH_SIZE - 1U);
+        }
+        s_registry_hash[key] = (uint8_t)(i + 1);
+    }
+    __set_PRIMASK(primask);
+    
+    return true;
+}
+
+#endif
+
+/**
+ * @brief   置位实例就绪标志并调用 ready_cb，通知 Modbus_ProcessAll() 或RTOS任务
+ * @param   hmodbus Modbus句柄指针
+ * 
+ * @note    可在中断与主循环中调用
+ */
+static void Modbus_SignalReady(ModbusHandle_t *hmodbus) {
+    Modbus_MarkReady(hmodbus);
+    
+    if (hmodbus->ready_cb != NULL) {
+        hmodbus->ready_cb(hmodbus);
+    }
+}
+
+/**
+ * @brief   仅置位实例就绪标志
+ * @param   hmodbus Modbus句柄指针
+ */
+static void Modbus_MarkReady(ModbusHandle_t *hmodbus) {
+#if MODBUS_MAX_INSTANCES > 0
+    if (hmodbus->registry_slot < MODBUS_MAX_INSTANCES) {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        s_registry_ready |= 1UL << hmodbus->registry_slot;
+        __set_PRIMASK(primask);
+    }
+#else
+    (void)hmodbus;
+#endif
+}
+
+/**
+ * @brief   数据区加锁 (未配置 lock_cb 时不做任何操作)
+ * @param   hmodbus Modbus句柄指针
+ */
+static void Modbus_DataLock(ModbusHandle_t *hmodbus) {
+    if (hmodbus->lock_cb != NULL && !hmodbus->data_locked) {
+        hmodbus->lock_cb(hmodbus, true);
+        hmodbus->data_locked = true;
+    }
+}
+
+/**
+ * @brief   数据区解锁 (未加锁时不做任何操作，可重复调用)
+ * @param   hmodbus Modbus句柄指针
+ */
+static void Modbus_DataUnlock(ModbusHandle_t *hmodbus) {
+    if (hmodbus->data_locked) {
+        hmodbus->data_locked = false;
+        hmodbus->lock_cb(hmodbus, false);
+    }
+}
+
+/* ============================================================================
+ *                              配置接口函数
+ * ============================================================================ */
+
+/**
+ * @brief   更新从站地址
+ */
+void Modbus_SetSlaveAddr(ModbusHandle_t *hmodbus, uint8_t addr) {
+    if (hmodbus != NULL && addr >= 1 && addr <= 247) {
+        hmodbus->slave_addr = addr;
+        
+        /* 缓存的响应帧带有原地址 */
+        for (uint32_t i = 0; i < hmodbus->resp_cache.count; i++) {
+            hmodbus->resp_cache.entries[i].len = 0;
+        }
+    }
+}
+
+/**
+ * @brief   更新波特率
+ */
+void Modbus_SetBaudRate(ModbusHandle_t *hmodbus, uint32_t baud_rate) {
+    if (hmodbus != NULL && baud_rate > 0) {
+        hmodbus->baud_rate = baud_rate;
+        Modbus_FramingSetup(hmodbus);
+    }
+}
+
+/**
+ * @brief   启动UART接收
+ */
+void Modbus_StartReceive(ModbusHandle_t *hmodbus) {
+    if (hmodbus == NULL || (hmodbus->huart == NULL && hmodbus->transport == NULL)) {
+        return;
+    }
+    
+    /* 接收重新开始，丢弃未完成帧的滚动CRC与帧定时状态 */
+    hmodbus->rx_crc = 0xFFFF;
+    hmodbus->rx_crc_pos = 0;
+    hmodbus->rx_crc_count = 0;
+    hmodbus->rx_arm_offset = 0;
+    hmodbus->rx_timer_stage = 0;
+    hmodbus->rx_gap_error = 0;
+    
+    if (hmodbus->rx_mode == MODBUS_RX_DMA_RING) {
+        /* 环形模式: 一次启动循环DMA，此后无需重新启动 */
+        hmodbus->rx_ring_tail = 0;
+        HAL_UARTEx_ReceiveToIdle_DMA(hmodbus->huart, hmodbus->rx_buf_a, hmodbus->rx_buf_size);
+        
+        /* 半传输事件仅对增量CRC有意义; 旧版HAL无法区分事件类型时必须关闭 */
+#if defined(HAL_UART_RXEVENT_IDLE)
+        if (!hmodbus->incremental_crc)
+#endif
+        {
+            __HAL_DMA_DISABLE_IT(hmodbus->huart->hdmarx, DMA_IT_HT);
+        }
+    } else {
+        Modbus_PortStartRx(hmodbus, hmodbus->rx_active_buf, hmodbus->rx_buf_size);
+    }
+}
+
+/* ============================================================================
+ *                              低功耗
+ * ============================================================================ */
+
+/**
+ * @brief   查询实例是否完全空闲
+ */
+bool Modbus_IsIdle(const ModbusHandle_t *hmodbus) {
+    if (hmodbus == NULL) {
+        return true;
+    }
+    
+    /* 待处理请求、发送队列与RS485方向 (切回接收后发送状态才回到空闲) */
+    if (hmodbus->rx_ready || hmodbus->tx_count != 0 || hmodbus->tx_state != MODBUS_TX_IDLE) {
+        return false;
+    }
+    
+    /* 合并窗口与网关等待依赖 HAL_GetTick() 计时，STOP模式下节拍停止 */
+    if (hmodbus->commit_count != 0 || hmodbus->bridge_origin != NULL) {
+        return false;
+    }
+    
+    /* 接收中的帧: 帧定时进行中，或已收到帧尾之前的字节 */
+    if (hmodbus->huart == NULL && hmodbus->transport == NULL) {
+        return true;  /* 无串口实例 */
+    }
+    if (hmodbus->rx_timer_stage != 0) {
+        return false;
+    }
+    uint16_t pos = Modbus_RxPosition(hmodbus);
+    if (hmodbus->rx_mode == MODBUS_RX_DMA_RING) {
+        return pos == hmodbus->rx_ring_tail;
+    }
+    return pos == 0;
+}
+
+/**
+ * @brief   进入STOP模式前调用: 实例空闲时使能USART唤醒
+ */
+bool Modbus_EnterStop(ModbusHandle_t *hmodbus) {
+    if (!Modbus_IsIdle(hmodbus)) {
+        return false;
+    }
+    
+#if MODBUS_STOP_WAKE_SUPPORTED
+    if (hmodbus != NULL && hmodbus->stop_wake) {
+        USART_TypeDef *uart = hmodbus->huart->Instance;
+        uart->ICR = USART_ICR_WUCF;
+        SET_BIT(uart->CR3, USART_CR3_WUFIE);
+        SET_BIT(uart->CR1, USART_CR1_UESM);
+    }
+#endif
+    return true;
+}
+
+/**
+ * @brief   自STOP模式唤醒后调用
+ */
+void Modbus_ExitStop(ModbusHandle_t *hmodbus) {
+    if (hmodbus == NULL || hmodbus->huart == NULL || hmodbus->transport != NULL) {
+        return;
+    }
+    
+#if MODBUS_STOP_WAKE_SUPPORTED
+    if (hmodbus->stop_wake) {
+        USART_TypeDef *uart = hmodbus->huart->Instance;
+        CLEAR_BIT(uart->CR1, USART_CR1_UESM);
+        CLEAR_BIT(uart->CR3, USART_CR3_WUFIE);
+        uart->ICR = USART_ICR_WUCF;
+    }
+#endif
+    
+    /* 唤醒期间溢出等错误已使HAL中止接收: 重新启动，下一帧不会丢失 */
+    if (hmodbus->huart->RxState != HAL_UART_STATE_BUSY_RX) {
+        Modbus_StartReceive(hmodbus);
+    }
+}
+
+/* ============================================================================
+ *                              地址映射
+ * ============================================================================ */
+
+/**
+ * @brief   建立各数据区的段表
+ * @param   hmodbus Modbus句柄指针 (data_map已复制)
+ * @retval  true    段表有效
+ * @retval  false   段表未按base升序排列、段间重叠、越过地址空间或数据指针为空
+ * 
+ * @note    未配置段表的数据区把连续数组转换为base=0的单段，查找路径统一
+ */
+static bool Modbus_MapSetup(ModbusHandle_t *hmodbus) {
+    const Modbus_DataMap_t *map = &hmodbus->data_map;
+#if MODBUS_PROFILE_LAYOUT
+    /* 编译期布局: 只校验配置档段表，忽略 data_map */
+    const Modbus_Segment_t *segs[MODBUS_AREA_COUNT];
+    uint8_t seg_counts[MODBUS_AREA_COUNT];
+    for (uint32_t area = 0; area < MODBUS_AREA_COUNT; area++) {
+        segs[area] = MODBUS_SEG_TABLE(hmodbus, area);
+        seg_counts[area] = MODBUS_SEG_COUNT(hmodbus, area);
+    }
+    void *flat_data[MODBUS_AREA_COUNT] = { NULL, NULL, NULL, NULL };
+    const uint16_t flat_counts[MODBUS_AREA_COUNT] = { 0, 0, 0, 0 };
+    uint32_t *flat_dirty[MODBUS_AREA_COUNT] = { NULL, NULL, NULL, NULL };
+#else
+    const Modbus_Segment_t *segs[MODBUS_AREA_COUNT] = {
+        map->coil_segs, map->discrete_segs, map->holding_segs, map->input_segs
+    };
+    const uint8_t seg_counts[MODBUS_AREA_COUNT] = {
+        map->coil_seg_count, map->discrete_seg_count, map->holding_seg_count, map->input_seg_count
+    };
+    void *flat_data[MODBUS_AREA_COUNT] = {
+        map->coils, map->discrete_inputs, map->holding_regs, map->input_regs
+    };
+    const uint16_t flat_counts[MODBUS_AREA_COUNT] = {
+        map->coil_count, map->discrete_count, map->holding_reg_count, map->input_reg_count
+    };
+    uint32_t *flat_dirty[MODBUS_AREA_COUNT] = {
+        map->coil_dirty, NULL, map->holding_dirty, NULL
+    };
+#endif
+    
+    for (uint32_t area = 0; area < MODBUS_AREA_COUNT; area++) {
+        Modbus_Segment_t *flat = &hmodbus->area_flat[area];
+        
+        if (segs[area] != NULL && seg_counts[area] > 0) {
+            uint32_t next_free = 0;  /* 上一段结束地址 */
+            for (uint32_t i = 0; i < seg_counts[area]; i++) {
+                const Modbus_Segment_t *seg = &segs[area][i];
+                if (seg->data == NULL || seg->count == 0 || seg->base < next_free ||
+                    (uint32_t)seg->base + seg->count > 0x10000UL) {
+                    return false;
+                }
+                next_free = (uint32_t)seg->base + seg->count;
+            }
+            hmodbus->area_segs[area] = segs[area];
+            hmodbus->area_seg_count[area] = seg_counts[area];
+        } else if (flat_data[area] != NULL && flat_counts[area] > 0) {
+            flat->base = 0;
+            flat->count = flat_counts[area];
+            flat->data = flat_data[area];
+            flat->flags = (hmodbus->fast_path.flat_areas & (1U << area)) ? MODBUS_SEG_ISR_READ : 0U;
+            flat->max_age_ms = 0;
+            flat->read_cb = NULL;
+            flat->cache = NULL;
+            flat->seqlock = map->seqlock;
+            flat->dirty = flat_dirty[area];
+            hmodbus->area_segs[area] = flat;
+            hmodbus->area_seg_count[area] = 1;
+        } else {
+            hmodbus->area_segs[area] = NULL;
+            hmodbus->area_seg_count[area] = 0;
+        }
+    }
+    
+    return true;
+}
+
+/**
+ * @brief   查找完整包含请求地址范围的段
+ * @param   hmodbus  Modbus句柄指针
+ * @param   area     数据区类型
+ * @param   start    起始地址
+ * @param   quantity 数量
+ * @param   write    是否为写请求
+ * @return  段指针; 地址未映射、跨段或写只读段时返回NULL
+ * 
+ * @note    二分查找最后一个 base <= start 的段，段数为n时最多比较 log2(n)+1 次
+ */
+static const Modbus_Segment_t *Modbus_MapLookup(const ModbusHandle_t *hmodbus, Modbus_Area_t area,
+                                                uint16_t start, uint16_t quantity, bool write) {
+    const Modbus_Segment_t *segs = MODBUS_SEG_TABLE(hmodbus, area);
+    uint32_t lo = 0;
+    uint32_t hi = MODBUS_SEG_COUNT(hmodbus, area);
+    
+    while (hi - lo > 1U) {
+        uint32_t mid = (lo + hi) >> 1;
+        if (segs[mid].base <= start) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    
+    const Modbus_Segment_t *seg = &segs[lo];
+    if (start < seg->base || (uint32_t)start + quantity > (uint32_t)seg->base + seg->count) {
+        return NULL;
+    }
+    if (write && (seg->flags & MODBUS_SEG_READONLY) != 0U) {
+        return NULL;
+    }
+    return seg;
+}
+
+#if MODBUS_FC_ANY_FETCH
+/**
+ * @brief   读请求前按需刷新段数据
+ * @param   hmodbus  Modbus句柄指针
+ * @param   seg      已查得的段
+ * @param   start    起始地址
+ * @param   quantity 数量
+ * @retval  true     seg->data 中请求范围有效
+ * @retval  false    提供者读取失败
+ * 
+ * @note    请求范围落在缓存有效范围内且未超过 max_age_ms 时直接使用缓存，
+ *          否则只对请求的精确范围调用提供者并更新缓存
+ */
+static bool Modbus_MapFetch(ModbusHandle_t *hmodbus, const Modbus_Segment_t *seg, uint16_t start, uint16_t quantity) {
+    if (seg->read_cb == NULL) {
+        return true;
+    }
+    
+    uint16_t offset = start - seg->base;
+    uint32_t now = HAL_GetTick();
+    Modbus_SegmentCache_t *cache = seg->cache;
+    
+    if (cache != NULL && seg->max_age_ms != 0 &&
+        offset >= cache->lo && (uint32_t)offset + quantity <= cache->hi &&
+        (uint32_t)(now - cache->tick) < seg->max_age_ms) {
+        return true;
+    }
+    
+    if (!seg->read_cb(hmodbus, seg, offset, quantity)) {
+        Modbus_SegmentInvalidate(seg);
+        return false;
+    }
+    
+    if (cache != NULL) {
+        cache->tick = now;
+        cache->lo = offset;
+        cache->hi = offset + quantity;
+    }
+    return true;
+}
+#endif
+
+/**
+ * @brief   使段读取缓存失效
+ */
+void Modbus_SegmentInvalidate(const Modbus_Segment_t *seg) {
+    if (seg == NULL) {
+        return;
+    }
+    
+    if (seg->cache != NULL) {
+        seg->cache->hi = seg->cache->lo;
+    }
+    Modbus_DataChanged();
+}
+
+/**
+ * @brief   通知协议栈数据区已被应用修改
+ */
+void Modbus_DataChanged(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    s_data_generation = s_data_generation + 1U;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief   将段内请求范围复制到响应数据区
+ * @param   seg      已查得的段
+ * @param   dst      响应数据区 (寄存器为大端字节, 位为LSB优先打包)
+ * @param   start    起始地址
+ * @param   quantity 数量
+ * @param   is_bits  true=位段, false=寄存器段
+ * @param   attempts 最大复制次数 (不少于1; 无顺序锁时首次即成功)
+ * @retval  true     已复制一致的数据
+ * @retval  false    每次复制期间都有写入方在修改数据
+ * 
+ * @note    复制前后读取序号: 两次相同且为偶数说明复制期间没有写入，否则重新复制;
+ *          读取方只读序号，不阻塞写入方
+ */
+static bool Modbus_MapRead(const Modbus_Segment_t *seg, uint8_t *dst, uint16_t start, uint16_t quantity,
+                           bool is_bits, uint32_t attempts) {
+    const Modbus_Seqlock_t *lock = seg->seqlock;
+    uint16_t offset = start - seg->base;
+    
+    for (uint32_t i = 0; i < attempts; i++) {
+        uint32_t seq = (lock != NULL) ? lock->seq : 0U;
+        if ((seq & 1U) != 0U) {
+            continue;  /* 写入进行中 */
+        }
+        __DMB();
+        
+        if (is_bits) {
+            Modbus_BitsExtract(dst, (const uint8_t *)seg->data, offset, quantity);
+        } else {
+            Modbus_RegsToBytes(dst, (const uint16_t *)seg->data + offset, quantity);
+        }
+        
+        __DMB();
+        if (lock == NULL || lock->seq == seq) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#if MODBUS_FC_ANY_WRITE
+/**
+ * @brief   写请求修改段数据前调用
+ * @param   seg 已查得的段
+ */
+static void Modbus_MapWriteBegin(const Modbus_Segment_t *seg) {
+    Modbus_SeqlockWriteBegin(seg->seqlock);
+}
+
+/**
+ * @brief   写请求修改段数据后调用: 发布新序号、使读取缓存失效并记录变更
+ * @param   hmodbus  Modbus句柄指针
+ * @param   seg      已查得的段
+ * @param   area     数据区类型
+ * @param   start    起始地址
+ * @param   quantity 实际修改的数量 (0表示未修改)
+ * 
+ * @note    脏位按32位整字置位，每个字在短临界区内读改写，与应用层 Modbus_DirtyFetch() 互斥
+ */
+static void Modbus_MapWriteEnd(ModbusHandle_t *hmodbus, const Modbus_Segment_t *seg, Modbus_Area_t area,
+                               uint16_t start, uint16_t quantity) {
+    Modbus_SeqlockWriteEnd(seg->seqlock);
+    Modbus_SegmentInvalidate(seg);
+    
+    if (quantity == 0) {
+        return;
+    }
+    
+    if (seg->dirty != NULL) {
+        uint32_t bit = start - seg->base;
+        uint32_t end = bit + quantity;
+        while (bit < end) {
+            uint32_t shift = bit & 31U;
+            uint32_t n = 32U - shift;
+            if (n > end - bit) {
+                n = end - bit;
+            }
+            uint32_t mask = ((n == 32U) ? 0xFFFFFFFFUL : ((1UL << n) - 1U)) << shift;
+            
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            seg->dirty[bit >> 5] |= mask;
+            __set_PRIMASK(primask);
+            bit += n;
+        }
+    }
+    
+    if (hmodbus->commit_cb != NULL) {
+        Modbus_CommitRecord(hmodbus, area, start, quantity);
+    }
+    
+    /* 写入已生效: 发布 Modbus_WriteCheck() 登记的事件 */
+    if (hmodbus->event_staged) {
+        Modbus_EventPublish(hmodbus);
+    }
+}
+
+/**
+ * @brief   记录一次写入变更，与同一数据区相邻或重叠的待提交范围合并
+ * @param   hmodbus  Modbus句柄指针
+ * @param   area     数据区类型
+ * @param   start    起始地址
+ * @param   quantity 数量
+ * 
+ * @note    范围数已达 MODBUS_COMMIT_MAX_RANGES 时先提交已有范围 (此时仍处于请求处理中)
+ */
+static void Modbus_CommitRecord(ModbusHandle_t *hmodbus, Modbus_Area_t area, uint16_t start, uint16_t quantity) {
+    uint32_t end = (uint32_t)start + quantity;
+    
+    for (uint32_t i = 0; i < hmodbus->commit_count; i++) {
+        Modbus_Change_t *range = &hmodbus->commit_ranges[i];
+        uint32_t range_end = (uint32_t)range->start + range->quantity;
+        if (range->area != area || start > range_end || range->start > end) {
+            continue;
+        }
+        
+        uint32_t lo = (start < range->start) ? start : range->start;
+        uint32_t hi = (end > range_end) ? end : range_end;
+        if (hi - lo <= 0xFFFFU) {
+            range->start = (uint16_t)lo;
+            range->quantity = (uint16_t)(hi - lo);
+            return;
+        }
+    }
+    
+    if (hmodbus->commit_count >= MODBUS_COMMIT_MAX_RANGES) {
+        Modbus_CommitFlush(hmodbus);
+    }
+    if (hmodbus->commit_count == 0) {
+        hmodbus->commit_tick = HAL_GetTick();
+    }
+    
+    Modbus_Change_t *range = &hmodbus->commit_ranges[hmodbus->commit_count++];
+    range->area = area;
+    range->start = start;
+    range->quantity = quantity;
+}
+#endif
+
+/**
+ * @brief   立即提交全部待提交范围
+ * @param   hmodbus Modbus句柄指针
+ */
+static void Modbus_CommitFlush(ModbusHandle_t *hmodbus) {
+    if (hmodbus->commit_count == 0) {
+        return;
+    }
+    
+    hmodbus->commit_cb(hmodbus, hmodbus->commit_ranges, hmodbus->commit_count);
+    hmodbus->commit_count = 0;
+}
+
+/**
+ * @brief   合并窗口到期时提交 (commit_window_ms 为0时每次调用即提交)
+ * @param   hmodbus Modbus句柄指针
+ */
+static void Modbus_CommitPoll(ModbusHandle_t *hmodbus) {
+    if (hmodbus->commit_count == 0 ||
+        (uint32_t)(HAL_GetTick() - hmodbus->commit_tick) < hmodbus->commit_window_ms) {
+        return;
+    }
+    
+    Modbus_CommitFlush(hmodbus);
+}
+
+/**
+ * @brief   取出一段被主站写入过的连续地址并清除其脏位
+ */
+bool Modbus_DirtyFetch(ModbusHandle_t *hmodbus, Modbus_Area_t area, uint16_t *start, uint16_t *quantity) {
+    if (hmodbus == NULL || start == NULL || quantity == NULL || area >= MODBUS_AREA_COUNT) {
+        return false;
+    }
+    
+    for (uint32_t seg_idx = 0; seg_idx < MODBUS_SEG_COUNT(hmodbus, area); seg_idx++) {
+        const Modbus_Segment_t *seg = &MODBUS_SEG_TABLE(hmodbus, area)[seg_idx];
+        if (seg->dirty == NULL) {
+            continue;
+        }
+        
+        uint32_t words = ((uint32_t)seg->count + 31U) / 32U;
+        for (uint32_t i = 0; i < words; i++) {
+            uint32_t word = seg->dirty[i];
+            if (word == 0U) {
+                continue;
+            }
+            
+            /* 自最低置位起取连续置位，跨字时继续到下一字的bit0 */
+            uint32_t shift = 31U - __CLZ(word & (0U - word));
+            uint32_t first = i * 32U + shift;
+            uint32_t count = 0;
+            for (uint32_t w = i; w < words; w++) {
+                uint32_t rest = ~(seg->dirty[w] >> shift);
+                uint32_t n = (rest == 0U) ? 32U : 31U - __CLZ(rest & (0U - rest));
+                if (n > 32U - shift) {
+                    n = 32U - shift;
+                }
+                if (n == 0U) {
+                    break;
+                }
+                uint32_t mask = ((n == 32U) ? 0xFFFFFFFFUL : ((1UL << n) - 1U)) << shift;
+                
+                uint32_t primask = __get_PRIMASK();
+                __disable_irq();
+                seg->dirty[w] &= ~mask;
+                __set_PRIMASK(primask);
+                
+                count += n;
+                if (shift + n < 32U) {
+                    break;
+                }
+                shift = 0;
+            }
+            
+            *start = (uint16_t)(seg->base + first);
+            *quantity = (uint16_t)count;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief   开始更新顺序锁保护的数据
+ */
+void Modbus_SeqlockWriteBegin(Modbus_Seqlock_t *lock) {
+    if (lock == NULL) {
+        return;
+    }
+    
+    lock->seq = lock->seq + 1U;
+    __DMB();  /* 奇数序号先于数据修改可见 */
+}
+
+/**
+ * @brief   结束更新顺序锁保护的数据
+ */
+void Modbus_SeqlockWriteEnd(Modbus_Seqlock_t *lock) {
+    if (lock == NULL) {
+        return;
+    }
+    
+    __DMB();  /* 数据修改先于偶数序号可见 */
+    lock->seq = lock->seq + 1U;
+    Modbus_DataChanged();
+}
+
+/* ============================================================================
+ *                              写入事件队列
+ * ============================================================================ */
+
+/**
+ * @brief   校验并清空写入事件队列
+ * @param   hmodbus Modbus句柄指针
+ * @param   queue   写入事件队列配置
+ * @retval  true    配置有效 (size 为0时不使用)
+ * @retval  false   size 不是2的幂、事件数组为空，或 defer_config 未配置队列
+ */
+static bool Modbus_EventSetup(ModbusHandle_t *hmodbus, const Modbus_EventQueueConfig_t *queue) {
+    if (queue->size != 0 && (queue->entries == NULL || (queue->size & (queue->size - 1U)) != 0)) {
+        return false;
+    }
+    if (queue->defer_config && queue->size == 0) {
+        return false;
+    }
+    
+    hmodbus->event_queue = *queue;
+    hmodbus->event_head = 0;
+    hmodbus->event_tail = 0;
+    hmodbus->event_staged = false;
+    return true;
+}
+
+#if MODBUS_FC_ANY_WRITE || MODBUS_FC_64_ENABLED
+/**
+ * @brief   写入前检查: 事件队列余量与应用校验回调，通过后在队尾填入事件
+ * @param   hmodbus    Modbus句柄指针
+ * @param   func_code  功能码
+ * @param   start_addr 起始地址 (0x64为参数地址)
+ * @param   quantity   数量 (0x64为参数值)
+ * @return  0表示允许写入，否则为异常响应
+ * 
+ * @note    队列已满时返回从站忙异常，写入不执行，主站重试时队列已被取出;
+ *          填入的事件在写入生效后才由 Modbus_EventPublish() 发布，被拒绝的写入不占用队列
+ */
+static uint16_t Modbus_WriteCheck(ModbusHandle_t *hmodbus, uint8_t func_code, uint16_t start_addr, uint16_t quantity) {
+    uint16_t size = hmodbus->event_queue.size;
+    uint16_t head = hmodbus->event_head;
+    
+    hmodbus->event_staged = false;
+    if (size != 0 && (uint16_t)(head - hmodbus->event_tail) >= size) {
+        return MODBUS_REPLY_EXCEPTION(MB_EX_SLAVE_DEVICE_BUSY);
+    }
+    
+    /* 快速校验: 0x64 (defer_config) 使用 config_check_cb，其他写入使用 write_cb */
+    if (func_code == 0x64) {
+        Modbus_CustomConfigCallback_t check = hmodbus->event_queue.config_check_cb;
+        if (check != NULL && !check(hmodbus, start_addr, quantity)) {
+            return MODBUS_REPLY_EXCEPTION(MB_EX_ILLEGAL_DATA_VALUE);
+        }
+    } else if (hmodbus->write_cb != NULL) {
+        if (!hmodbus->write_cb(hmodbus, func_code, start_addr, quantity)) {
+            return MODBUS_REPLY_EXCEPTION(MB_EX_SLAVE_DEVICE_FAILURE);
+        }
+    }
+    
+    if (size != 0) {
+        Modbus_Event_t *event = &hmodbus->event_queue.entries[head & (size - 1U)];
+        event->func_code = func_code;
+        event->addr = start_addr;
+        event->value = quantity;
+        hmodbus->event_staged = true;
+    }
+    return 0;
+}
+
+/**
+ * @brief   发布已填入队尾的事件
+ * @param   hmodbus Modbus句柄指针
+ */
+static void Modbus_EventPublish(ModbusHandle_t *hmodbus) {
+    hmodbus->event_staged = false;
+    __DMB();  /* 事件内容先于写入序号可见 */
+    hmodbus->event_head = (uint16_t)(hmodbus->event_head + 1U);
+}
+#endif
+
+/**
+ * @brief   从写入事件队列取出最早的一个事件
+ */
+bool Modbus_EventFetch(ModbusHandle_t *hmodbus, Modbus_Event_t *event) {
+    if (hmodbus == NULL || event == NULL || hmodbus->event_queue.size == 0) {
+        return false;
+    }
+    
+    uint16_t tail = hmodbus->event_tail;
+    if (tail == hmodbus->event_head) {
+        return false;
+    }
+    __DMB();  /* 读取序号后再读事件内容 */
+    *event = hmodbus->event_queue.entries[tail & (hmodbus->event_queue.size - 1U)];
+    __DMB();  /* 事件内容读完后才释放该位置 */
+    hmodbus->event_tail = (uint16_t)(tail + 1U);
+    return true;
+}
+
+/**
+ * @brief   取出并处理队列中的全部写入事件
+ */
+uint32_t Modbus_EventDispatch(ModbusHandle_t *hmodbus) {
+    Modbus_Event_t event;
+    uint32_t count = 0;
+    
+    while (Modbus_EventFetch(hmodbus, &event)) {
+        if (event.func_code == 0x64) {
+            if (hmodbus->custom_config_cb != NULL) {
+                (void)hmodbus->custom_config_cb(hmodbus, event.addr, event.value);
+            }
+        } else if (hmodbus->event_queue.event_cb != NULL) {
+            hmodbus->event_queue.event_cb(hmodbus, &event);
+        }
+        count++;
+    }
+    return count;
+}
+
+/* ============================================================================
+ *                              底层辅助函数
+ * ============================================================================ */
+
+/**
+ * @brief   计算CRC16校验码
+ * @param   hmodbus Modbus句柄指针
+ * @param   buffer  数据缓冲区指针
+ * @param   length  数据长度
+ * @return  16位CRC校验码
+ * 
+ * @note    实际算法由初始化时绑定的CRC后端决定
+ */
+static uint16_t Modbus_CRC16(const ModbusHandle_t *hmodbus, const uint8_t *buffer, uint16_t length) {
+    return MODBUS_CRC_CALL(hmodbus, 0xFFFF, buffer, length);
+}
+
+#if MODBUS_CRC_BUILTIN(MODBUS_PROFILE_CRC_SHIFT)
+/**
+ * @brief   CRC16移位法: 代码体积小
+ */
+static uint16_t Modbus_CRC16_Shift(const ModbusHandle_t *hmodbus, uint16_t crc, const uint8_t *buffer, uint16_t length) {
+    (void)hmodbus;
+    
+    for (uint16_t i = 0; i < length; i++) {
+        crc ^= buffer[i];
+        for (int j = 0; j < 8; j++) {
+            if (crc & 1) {
+                crc = (crc >> 1) ^ 0xA001;
+            } else {
+                crc >>= 1;
+            }
+        }
+    }
+    
+    return crc;
+}
+#endif
+
+#if MODBUS_CRC_BUILTIN(MODBUS_PROFILE_CRC_TABLE)
+/**
+ * @brief   CRC16查表法: 速度快约10倍
+ */
+static uint16_t Modbus_CRC16_Table(const ModbusHandle_t *hmodbus, uint16_t crc, const uint8_t *buffer, uint16_t length) {
+    (void)hmodbus;
+    
+    for (uint16_t i = 0; i < length; i++) {
+        crc = (crc >> 8) ^ CRC16_TABLE[(crc ^ buffer[i]) & 0xFF];
+    }
+    
+    return crc;
+}
+#endif
+
+#if MODBUS_CRC_BUILTIN(MODBUS_PROFILE_CRC_NIBBLE)
+/**
+ * @brief   CRC16半字节查表法: 每字节分高低4位两次查表
+ */
+static uint16_t Modbus_CRC16_Nibble(const ModbusHandle_t *hmodbus, uint16_t crc, const uint8_t *buffer, uint16_t length) {
+    (void)hmodbus;
+    
+    for (uint16_t i = 0; i < length; i++) {
+        crc ^= buffer[i];
+        crc = (crc >> 4) ^ CRC16_NIBBLE_TABLE[crc & 0x0F];
+        crc = (crc >> 4) ^ CRC16_NIBBLE_TABLE[crc & 0x0F];
+    }
+    
+    return crc;
+}
+#endif
+
+#if MODBUS_HW_CRC_SUPPORTED && MODBUS_CRC_BUILTIN(MODBUS_PROFILE_CRC_HARDWARE)
+/**
+ * @brief   CRC16硬件计算: 使用STM32可编程CRC外设
+ * 
+ * @note    外设配置: 多项式0x8005, 16位, 输入按字节/字反转, 输出反转
+ *          初值寄存器位于非反转域，因此续算时需写入位反转后的CRC值
+ *          对齐部分以32位字写入(输入按字反转)，首尾不足一字的部分逐字节写入
+ *          数据较长且配置了DMA句柄时，由DMA将数据送入CRC_DR
+ */
+static uint16_t Modbus_CRC16_Hardware(const ModbusHandle_t *hmodbus, uint16_t crc, const uint8_t *buffer, uint16_t length) {
+    CRC_TypeDef *crc_reg = hmodbus->hw_crc.hcrc->Instance;
+    uint32_t cr_byte = CRC_CR_POLYSIZE_0 | CRC_CR_REV_IN_0 | CRC_CR_REV_OUT;
+    uint32_t cr_word = CRC_CR_POLYSIZE_0 | CRC_CR_REV_IN | CRC_CR_REV_OUT;
+    
+    crc_reg->POL = 0x8005;
+    crc_reg->INIT = __RBIT(crc) >> 16;
+    crc_reg->CR = cr_byte | CRC_CR_RESET;
+    
+    /* 长数据: DMA送数 (DMA需配置为字节宽度，与字节反转模式匹配) */
+    uint16_t threshold = hmodbus->hw_crc.dma_threshold ? hmodbus->hw_crc.dma_threshold
+                                                       : MODBUS_HW_CRC_DMA_THRESHOLD;
+    if (hmodbus->hw_crc.hdma != NULL && length >= threshold) {
+        if (HAL_DMA_Start(hmodbus->hw_crc.hdma, (uint32_t)buffer,
+                          (uint32_t)&crc_reg->DR, length) == HAL_OK &&
+            HAL_DMA_PollForTransfer(hmodbus->hw_crc.hdma, HAL_DMA_FULL_TRANSFER,
+                                    MODBUS_HW_CRC_DMA_TIMEOUT) == HAL_OK) {
+            return (uint16_t)crc_reg->DR;
+        }
+        
+        /* DMA失败: 重新装载初值，回退到CPU写入 */
+        HAL_DMA_Abort(hmodbus->hw_crc.hdma);
+        crc_reg->CR = cr_byte | CRC_CR_RESET;
+    }
+    
+    /* 前导非对齐字节 */
+    while (length > 0 && ((uintptr_t)buffer & 0x03) != 0) {
+        *(__IO uint8_t *)&crc_reg->DR = *buffer++;
+        length--;
+    }
+    
+    /* 对齐部分: 32位写入，一次送入4字节 */
+    if (length >= 4) {
+        crc_reg->CR = cr_word;
+        while (length >= 4) {
+            crc_reg->DR = *(const uint32_t *)buffer;
+            buffer += 4;
+            length -= 4;
+        }
+        crc_reg->CR = cr_byte;
+    }
+    
+    /* 尾部剩余字节 */
+    while (length > 0) {
+        *(__IO uint8_t *)&crc_reg->DR = *buffer++;
+        length--;
+    }
+    
+    return (uint16_t)crc_reg->DR;
+}
+#endif
+
+/**
+ * @brief   计算帧内前 length 字节的CRC16 (跨越环尾时分两段计算)
+ * @param   hmodbus Modbus句柄指针
+ * @param   frame   帧描述符指针
+ * @param   length  参与计算的字节数
+ * @return  16位CRC校验码
+ */
+static uint16_t Modbus_FrameCRC16(const ModbusHandle_t *hmodbus, const Modbus_Frame_t *frame, uint16_t length) {
+    uint16_t first = Modbus_FrameSpanLen(frame, 0, length);
+    uint16_t crc = MODBUS_CRC_CALL(hmodbus, 0xFFFF, Modbus_FrameSpan(frame, 0), first);
+    
+    if (first < length) {
+        crc = MODBUS_CRC_CALL(hmodbus, crc, frame->base, length - first);
+    }
+    return crc;
+}
+
+/**
+ * @brief   从帧中拷贝数据到线性缓冲区
+ */
+void Modbus_FrameCopy(const Modbus_Frame_t *frame, uint16_t idx, uint8_t *dst, uint16_t len) {
+    uint16_t first = Modbus_FrameSpanLen(frame, idx, len);
+    
+    memcpy(dst, Modbus_FrameSpan(frame, idx), first);
+    if (first < len) {
+        memcpy(&dst[first], frame->base, len - first);
+    }
+}
+
+/**
+ * @brief   寄存器数组转换为大端字节流
+ */
+void Modbus_RegsToBytes(uint8_t *dst, const uint16_t *src, uint16_t count) {
+    /* 源地址对齐到32位，之后每次读取两个寄存器 */
+    if (((uintptr_t)src & 2U) != 0U && count > 0) {
+        dst[0] = (uint8_t)(src[0] >> 8);
+        dst[1] = (uint8_t)src[0];
+        dst += 2;
+        src++;
+        count--;
+    }
+    
+    /* 每轮4个寄存器: 两次32位读取，__REV16 交换各半字字节序，非对齐整字写出;
+     * 寄存器侧同样经 __UNALIGNED_UINT32_* 访问，不以 uint32_t 左值读写 uint16_t 对象 (严格别名) */
+    while (count >= 4) {
+        uint32_t w0 = __REV16(__UNALIGNED_UINT32_READ(src));
+        uint32_t w1 = __REV16(__UNALIGNED_UINT32_READ(&src[2]));
+        __UNALIGNED_UINT32_WRITE(dst, w0);
+        __UNALIGNED_UINT32_WRITE(&dst[4], w1);
+        dst += 8;
+        src += 4;
+        count -= 4;
+    }
+    if (count >= 2) {
+        __UNALIGNED_UINT32_WRITE(dst, __REV16(__UNALIGNED_UINT32_READ(src)));
+        dst += 4;
+        src += 2;
+        count -= 2;
+    }
+    if (count > 0) {
+        dst[0] = (uint8_t)(src[0] >> 8);
+        dst[1] = (uint8_t)src[0];
+    }
+}
+
+/**
+ * @brief   大端字节流转换为寄存器数组
+ */
+void Modbus_BytesToRegs(uint16_t *dst, const uint8_t *src, uint16_t count) {
+    /* 目标地址对齐到32位，源数据以非对齐整字读取; 寄存器侧整字写入同样不经 uint32_t 左值 (严格别名) */
+    if (((uintptr_t)dst & 2U) != 0U && count > 0) {
+        dst[0] = (uint16_t)((src[0] << 8) | src[1]);
+        dst++;
+        src += 2;
+        count--;
+    }
+    
+    while (count >= 4) {
+        uint32_t w0 = __REV16(__UNALIGNED_UINT32_READ(src));
+        uint32_t w1 = __REV16(__UNALIGNED_UINT32_READ(&src[4]));
+        __UNALIGNED_UINT32_WRITE(dst, w0);
+        __UNALIGNED_UINT32_WRITE(&dst[2], w1);
+        dst += 4;
+        src += 8;
+        count -= 4;
+    }
+    if (count >= 2) {
+        __UNALIGNED_UINT32_WRITE(dst, __REV16(__UNALIGNED_UINT32_READ(src)));
+        dst += 2;
+        src += 4;
+        count -= 2;
+    }
+    if (count > 0) {
+        dst[0] = (uint16_t)((src[0] << 8) | src[1]);
+    }
+}
+
+/**
+ * @brief   从位压缩数组中提取连续位段
+ */
+void Modbus_BitsExtract(uint8_t *dst, const uint8_t *src, uint16_t start, uint16_t count) {
+    if (count == 0) {
+        return;
+    }
+    
+    const uint8_t *p = &src[start >> 3];
+    uint32_t shift = start & 7U;
+    uint32_t out_bytes = ((uint32_t)count + 7U) >> 3;
+    uint32_t src_last = (shift + count - 1U) >> 3;  /* 相对p的最后一个源字节 */
+    uint32_t k = 0;
+    
+    if (shift == 0U) {
+        memcpy(dst, p, out_bytes);
+    } else {
+        /* 每轮输出4字节，需读取5个源字节; 保证不越过源位段末字节 */
+        while (k + 4U <= src_last) {
+            uint32_t w = __UNALIGNED_UINT32_READ(&p[k]);
+            w = (w >> shift) | ((uint32_t)p[k + 4U] << (32U - shift));
+            __UNALIGNED_UINT32_WRITE(&dst[k], w);
+            k += 4U;
+        }
+        for (; k < out_bytes; k++) {
+            uint32_t v = (uint32_t)p[k] >> shift;
+            if (k + 1U <= src_last) {
+                v |= (uint32_t)p[k + 1U] << (8U - shift);
+            }
+            dst[k] = (uint8_t)v;
+        }
+    }
+    
+    /* 末字节超出位段的高位清零 */
+    if ((count & 7U) != 0U) {
+        dst[out_bytes - 1U] &= (uint8_t)((1U << (count & 7U)) - 1U);
+    }
+}
+
+/**
+ * @brief   计算位段写入后目标字节j的内容 (未合并掩码)
+ * @param   src       源字节缓冲区
+ * @param   src_bytes 源字节数
+ * @param   j         相对起始目标字节的序号
+ * @param   shift     起始位在目标字节内的偏移
+ * @return  由源字节j的低位与源字节j-1的高位拼成的值
+ */
+static inline uint32_t Modbus_BitsShiftIn(const uint8_t *src, uint32_t src_bytes, uint32_t j, uint32_t shift) {
+    uint32_t v = (j < src_bytes) ? ((uint32_t)src[j] << shift) : 0U;
+    
+    if (j > 0U && shift != 0U) {
+        v |= (uint32_t)src[j - 1U] >> (8U - shift);
+    }
+    return v;
+}
+
+/**
+ * @brief   将连续位段写入位压缩数组
+ */
+void Modbus_BitsInsert(uint8_t *dst, uint16_t start, const uint8_t *src, uint16_t count) {
+    if (count == 0) {
+        return;
+    }
+    
+    uint8_t *p = &dst[start >> 3];
+    uint32_t shift = start & 7U;
+    uint32_t src_bytes = ((uint32_t)count + 7U) >> 3;
+    uint32_t last = (shift + count - 1U) >> 3;      /* 相对p的最后一个目标字节 */
+    uint8_t first_mask = (uint8_t)(0xFFU << shift);
+    uint8_t last_mask = (uint8_t)(0xFFU >> (7U - ((shift + count - 1U) & 7U)));
+    
+    if (last == 0U) {
+        uint8_t mask = first_mask & last_mask;
+        p[0] = (uint8_t)((p[0] & ~mask) | (Modbus_BitsShiftIn(src, src_bytes, 0U, shift) & mask));
+        return;
+    }
+    
+    p[0] = (uint8_t)((p[0] & ~first_mask) | (Modbus_BitsShiftIn(src, src_bytes, 0U, shift) & first_mask));
+    
+    /* 中间整字节: 每轮4字节，源字节 j-1..j+3 均在位段内 */
+    uint32_t j = 1;
+    while (j + 4U <= last) {
+        uint32_t w = __UNALIGNED_UINT32_READ(&src[j]) << shift;
+        if (shift != 0U) {
+            w |= (uint32_t)src[j - 1U] >> (8U - shift);
+        }
+        __UNALIGNED_UINT32_WRITE(&p[j], w);
+        j += 4U;
+    }
+    for (; j < last; j++) {
+        p[j] = (uint8_t)Modbus_BitsShiftIn(src, src_bytes, j, shift);
+    }
+    
+    p[last] = (uint8_t)((p[last] & ~last_mask) | (Modbus_BitsShiftIn(src, src_bytes, last, shift) & last_mask));
+}
+
+#if MODBUS_FC_0F_ENABLED
+/**
+ * @brief   帧内位压缩数据写入位压缩数组 (自动处理回绕)
+ * @param   frame 帧描述符指针
+ * @param   idx   首个数据字节在帧内的序号
+ * @param   dst   目标位压缩数组
+ * @param   start 起始位序号
+ * @param   count 位数
+ * 
+ * @note    回绕点总在源字节边界上，分两段写入即可
+ */
+static void Modbus_FrameToBits(const Modbus_Frame_t *frame, uint16_t idx, uint8_t *dst, uint16_t start, uint16_t count) {
+    uint16_t len = (count + 7) / 8;
+    uint16_t first = Modbus_FrameSpanLen(frame, idx, len);
+    
+    if (first == len) {
+        Modbus_BitsInsert(dst, start, Modbus_FrameSpan(frame, idx), count);
+    } else {
+        Modbus_BitsInsert(dst, start, Modbus_FrameSpan(frame, idx), first * 8);
+        Modbus_BitsInsert(dst, start + first * 8, Modbus_FrameSpan(frame, idx + first), count - first * 8);
+    }
+}
+#endif
+
+#if MODBUS_FC_10_ENABLED || MODBUS_FC_17_ENABLED
+/**
+ * @brief   帧内大端寄存器数据转换为寄存器数组 (自动处理回绕)
+ * @param   frame 帧描述符指针
+ * @param   idx   首个寄存器高字节在帧内的序号
+ * @param   dst   目标寄存器数组
+ * @param   count 寄存器数量
+ */
+static void Modbus_FrameToRegs(const Modbus_Frame_t *frame, uint16_t idx, uint16_t *dst, uint16_t count) {
+    uint16_t len = count * 2;
+    uint16_t first = Modbus_FrameSpanLen(frame, idx, len);
+    
+    Modbus_BytesToRegs(dst, Modbus_FrameSpan(frame, idx), first / 2);
+    if (first < len) {
+        /* 跨越环尾: 被环尾拆开的寄存器单独拼接，其余部分从环首继续转换 */
+        uint16_t done = first / 2;
+        if ((first & 1U) != 0U) {
+            dst[done] = Modbus_FrameU16(frame, idx + done * 2);
+            done++;
+        }
+        Modbus_BytesToRegs(&dst[done], Modbus_FrameSpan(frame, idx + done * 2), count - done);
+    }
+}
+#endif
+
+/**
+ * @brief   增量CRC: 将新到达的字节计入滚动CRC
+ * @param   hmodbus  Modbus句柄指针
+ * @param   buffer   当前接收缓冲区
+ * @param   received 缓冲区中已接收的总字节数
+ * 
+ * @note    仅在中断上下文中调用
+ */
+static void Modbus_RxCrcUpdate(ModbusHandle_t *hmodbus, const uint8_t *buffer, uint16_t received) {
+    uint16_t pos = hmodbus->rx_crc_pos;
+    
+    if (received > pos) {
+        hmodbus->rx_crc = MODBUS_CRC_CALL(hmodbus, hmodbus->rx_crc, &buffer[pos], received - pos);
+        hmodbus->rx_crc_pos = received;
+    }
+}
+
+/**
+ * @brief   增量CRC(环形模式): 将环形缓冲中新写入的字节计入滚动CRC
+ * @param   hmodbus Modbus句柄指针
+ * @param   pos     DMA当前写入位置 (0 ~ rx_buf_size)
+ * 
+ * @note    同时累计当前帧计入的字节数: 帧长超过环大小时帧首已被覆盖，滚动CRC不再对应环中的帧
+ */
+static void Modbus_RxRingCrcUpdate(ModbusHandle_t *hmodbus, uint16_t pos) {
+    uint16_t from = hmodbus->rx_crc_pos;
+    
+    if (pos >= hmodbus->rx_buf_size) {
+        pos = 0;
+    }
+    uint32_t count = hmodbus->rx_crc_count + (uint32_t)(pos + hmodbus->rx_buf_size - from) % hmodbus->rx_buf_size;
+    hmodbus->rx_crc_count = (count > 0xFFFFU) ? 0xFFFFU : (uint16_t)count;
+    
+    /* 写入位置已回绕: 先计入至环尾的部分 */
+    if (pos < from) {
+        hmodbus->rx_crc = MODBUS_CRC_CALL(hmodbus, hmodbus->rx_crc, &hmodbus->rx_buf_a[from],
+                                            hmodbus->rx_buf_size - from);
+        from = 0;
+    }
+    if (pos > from) {
+        hmodbus->rx_crc = MODBUS_CRC_CALL(hmodbus, hmodbus->rx_crc, &hmodbus->rx_buf_a[from],
+                                            pos - from);
+    }
+    hmodbus->rx_crc_pos = pos;
+}
+
+/**
+ * @brief   环形接收事件处理 (HT/TC/空闲)
+ * @param   hmodbus Modbus句柄指针
+ * @param   size    DMA在环形缓冲中的写入位置
+ * 
+ * @note    帧在环形缓冲中原地划分，不发生拷贝，也无需重新启动接收
+ *          仅空闲事件代表帧结束; HT/TC事件仅推进增量CRC
+ */
+static void Modbus_RxRingEvent(ModbusHandle_t *hmodbus, uint16_t size) {
+    uint16_t ring_size = hmodbus->rx_buf_size;
+    uint16_t pos = (size >= ring_size) ? 0 : size;
+    
+    if (hmodbus->incremental_crc) {
+        Modbus_RxRingCrcUpdate(hmodbus, pos);
+    }
+    
+    /* 判断是否为空闲事件 */
+#if defined(HAL_UART_RXEVENT_IDLE)
+    if (HAL_UARTEx_GetRxEventType(hmodbus->huart) != HAL_UART_RXEVENT_IDLE) {
+        return;
+    }
+#else
+    /* 旧版HAL: HT已关闭，size等于环大小即为TC(回绕)事件 */
+    if (size >= ring_size) {
+        return;
+    }
+#endif
+    
+    /* 定时帧定界: 空闲事件仅为候选帧尾 */
+    if (hmodbus->framing.mode != MODBUS_FRAMING_IDLE) {
+        Modbus_FramingIdle(hmodbus, pos);
+        return;
+    }
+    
+    Modbus_RxRingFrameEnd(hmodbus, pos);
+}
+
+/**
+ * @brief   构建待处理帧的描述符
+ * @param   hmodbus Modbus句柄指针
+ * @param   frame   输出帧描述符
+ */
+static void Modbus_RxFrameGet(const ModbusHandle_t *hmodbus, Modbus_Frame_t *frame) {
+    if (hmodbus->rx_mode == MODBUS_RX_DMA_RING) {
+        /* 环形模式: 帧直接在环形缓冲中原地解析，跨越环尾时由回绕点处理 */
+        frame->base = hmodbus->rx_buf_a;
+        frame->offset = hmodbus->rx_frame_offset;
+    } else {
+        frame->base = hmodbus->rx_process_buf;
+        frame->offset = 0;
+    }
+    frame->size = hmodbus->rx_buf_size;
+    frame->length = hmodbus->rx_len;
+    frame->wrap = frame->size - frame->offset;
+}
+
+/**
+ * @brief   判断帧首字节是否需由本实例接收 (本站、广播、网关路由地址或等待中的下游应答)
+ * @param   hmodbus Modbus句柄指针
+ * @param   addr    帧首字节
+ * @retval  true    应由本实例处理
+ * @retval  false   发往其他从站的帧
+ */
+static bool Modbus_RxAddrMatch(const ModbusHandle_t *hmodbus, uint8_t addr) {
+    if (Modbus_RxAddrLocal(hmodbus, addr) || (hmodbus->bridge_map[addr >> 5] & (1UL << (addr & 31U))) != 0U) {
+        return true;
+    }
+    return hmodbus->bridge_origin != NULL && addr == hmodbus->bridge_addr;
+}
+
+/**
+ * @brief   判断帧首字节是否为本站地址或广播地址(0xFF)
+ * @param   hmodbus Modbus句柄指针
+ * @param   addr    帧首字节
+ * @retval  true    应由本站应答
+ * @retval  false   发往其他从站的帧
+ */
+static bool Modbus_RxAddrLocal(const ModbusHandle_t *hmodbus, uint8_t addr) {
+    return addr == hmodbus->slave_addr || addr == 0xFF;
+}
+
+#if MODBUS_MUTE_SUPPORTED
+/**
+ * @brief   他站帧: 中止本次接收并令USART静默至下一次空闲线
+ * @param   hmodbus Modbus句柄指针
+ * 
+ * @note    静默期间不置位RXNE/IDLE，该帧不产生接收事件; 空闲线到来时硬件自动解除静默，
+ *          新的接收已在同一缓冲区起始处就绪
+ */
+static void Modbus_RxMute(ModbusHandle_t *hmodbus) {
+    HAL_UART_AbortReceive(hmodbus->huart);
+    
+    /* 丢弃接收数据寄存器中的后续字节并请求进入静默 */
+    hmodbus->huart->Instance->RQR = USART_RQR_RXFRQ | USART_RQR_MMRQ;
+    
+    hmodbus->rx_crc = 0xFFFF;
+    hmodbus->rx_crc_pos = 0;
+    hmodbus->rx_gap_error = 0;
+    hmodbus->rx_arm_offset = 0;
+    HAL_UARTEx_ReceiveToIdle_IT(hmodbus->huart, hmodbus->rx_active_buf, hmodbus->rx_buf_size);
+}
+#endif
+
+/**
+ * @brief   发布待处理帧: 可由快速路径直接应答时在中断中完成，否则通知主循环
+ * @param   hmodbus Modbus句柄指针
+ */
+static void Modbus_RxPublish(ModbusHandle_t *hmodbus) {
+#if MODBUS_STATS_TIMING
+    hmodbus->rx_stamp = DWT->CYCCNT;
+#endif
+    if (!Modbus_FastPath(hmodbus)) {
+        Modbus_SignalReady(hmodbus);
+    }
+}
+
+/**
+ * @brief   中断快速路径: 在接收中断中直接应答白名单内的读请求
+ * @param   hmodbus Modbus句柄指针 (rx_ready 已置位)
+ * @retval  true    已应答并消费该帧
+ * @retval  false   不满足快速路径条件，交由 Modbus_Process() 处理
+ * 
+ * @note    仅处理长度为8字节、CRC正确、地址命中、目标段带 MODBUS_SEG_ISR_READ 且无提供者的
+ *          0x01~0x04 读请求，数量不超过 fast_path.max_regs (位为其16倍);
+ *          一切异常响应、写请求与回调均延后到 Modbus_Process()，最坏耗时由 max_regs 限定
+ */
+static bool Modbus_FastPath(ModbusHandle_t *hmodbus) {
+    if (!hmodbus->fast_path.enabled || hmodbus->process_busy || hmodbus->rx_len != 8 ||
+        hmodbus->tx_state != MODBUS_TX_IDLE || hmodbus->tx_count != 0) {
+        return false;
+    }
+    
+    Modbus_Frame_t frame;
+    Modbus_RxFrameGet(hmodbus, &frame);
+    
+    uint8_t req_addr = Modbus_FrameByte(&frame, 0);
+    uint8_t func_code = Modbus_FrameByte(&frame, 1);
+    if (!Modbus_RxAddrLocal(hmodbus, req_addr) ||
+        func_code < MB_FUNC_READ_COILS || func_code > MB_FUNC_READ_INPUT) {
+        return false;
+    }
+    
+    if (hmodbus->rx_crc_result == MODBUS_RX_CRC_UNKNOWN) {
+        uint16_t received_crc = (Modbus_FrameByte(&frame, 7) << 8) | Modbus_FrameByte(&frame, 6);
+        if (received_crc != Modbus_FrameCRC16(hmodbus, &frame, 6)) {
+            return false;
+        }
+    } else if (hmodbus->rx_crc_result != MODBUS_RX_CRC_OK) {
+        return false;
+    }
+    
+    uint16_t start_addr = Modbus_FrameU16(&frame, 2);
+    uint16_t quantity = Modbus_FrameU16(&frame, 4);
+    bool is_bits = (func_code <= MB_FUNC_READ_DISCRETE);
+    uint16_t max_qty = is_bits ? (uint16_t)(hmodbus->fast_path.max_regs * 16U) : hmodbus->fast_path.max_regs;
+    if (quantity < 1 || quantity > max_qty) {
+        return false;
     }
+    
+    /* 功能码已裁剪或被应用覆盖: 交由 Modbus_Process() 经分发表处理 */
+    Modbus_FuncHandler_t builtin = s_fast_path_handlers[func_code - MB_FUNC_READ_COILS];
+    if (builtin == NULL || s_func_table[func_code] != builtin) {
+        return false;
+    }
+    
+    static const Modbus_Area_t areas[4] = {
+        MODBUS_AREA_COILS, MODBUS_AREA_DISCRETE, MODBUS_AREA_HOLDING, MODBUS_AREA_INPUT
+    };
+    Modbus_Area_t area = areas[func_code - MB_FUNC_READ_COILS];
+    if (MODBUS_SEG_COUNT(hmodbus, area) == 0) {
+        return false;
+    }
+    const Modbus_Segment_t *seg = Modbus_MapLookup(hmodbus, area, start_addr, quantity, false);
+    if (seg == NULL || (seg->flags & MODBUS_SEG_ISR_READ) == 0U || seg->read_cb != NULL) {
+        return false;
+    }
+    
+    /* 响应须能装入发送槽 (含CRC) */
+    uint16_t byte_count = is_bits ? (uint16_t)((quantity + 7U) / 8U) : (uint16_t)(quantity * 2U);
+    if (3U + byte_count + 2U > hmodbus->tx_buf_size) {
+        return false;
+    }
+    
+    /* 发送器空闲且队列为空: 队首槽即构建槽 */
+    hmodbus->tx_buf = MODBUS_TX_SLOT(hmodbus, hmodbus->tx_head);
+    hmodbus->tx_buf[0] = hmodbus->slave_addr;
+    hmodbus->tx_buf[1] = func_code;
+    hmodbus->tx_buf[2] = (uint8_t)byte_count;
+    
+    /* 中断可能打断了顺序锁写入方: 仅尝试一次，快照不一致时交由 Modbus_Process() 重试 */
+    if (!Modbus_MapRead(seg, &hmodbus->tx_buf[3], start_addr, quantity, is_bits, 1)) {
+        return false;
+    }
+    
+    hmodbus->rx_ready = 0;
+    hmodbus->rx_len = 0;
+    MODBUS_STAT_INC(hmodbus, slave_msg);
+    Modbus_SendResponse(hmodbus, 3 + hmodbus->tx_buf[2]);
+    return true;
 }
 
-/* ============================================================================
- *                              配置接口函数
- * ============================================================================ */
+/**
+ * @brief   环形模式帧结束: 将 [rx_ring_tail, pos) 发布为待处理帧
+ * @param   hmodbus Modbus句柄指针
+ * @param   pos     帧尾在环形缓冲中的位置
+ */
+static void Modbus_RxRingFrameEnd(ModbusHandle_t *hmodbus, uint16_t pos) {
+    uint16_t ring_size = hmodbus->rx_buf_size;
+    uint16_t tail = hmodbus->rx_ring_tail;
+    uint16_t len = (uint16_t)((pos + ring_size - tail) % ring_size);
+    if (len == 0) {
+        return;  /* 无新数据 */
+    }
+    
+    MODBUS_STAT_INC(hmodbus, bus_msg);
+    
+    /* 他站帧: 仅推进帧起点; 待处理帧及其CRC判定保持不变 */
+    if (!Modbus_RxAddrMatch(hmodbus, hmodbus->rx_buf_a[tail])) {
+        if (hmodbus->incremental_crc) {
+            Modbus_RxRingCrcUpdate(hmodbus, pos);
+            hmodbus->rx_crc = 0xFFFF;
+            hmodbus->rx_crc_count = 0;
+        }
+        hmodbus->rx_gap_error = 0;
+        hmodbus->rx_ring_tail = pos;
+        return;
+    }
+    
+    /* 增量CRC: 计入的字节数与帧长不符时帧首已被覆盖，按CRC错误处理 */
+    if (hmodbus->incremental_crc) {
+        Modbus_RxRingCrcUpdate(hmodbus, pos);
+        hmodbus->rx_crc_result = (len >= 4 && hmodbus->rx_crc == 0 && hmodbus->rx_crc_count == len)
+                               ? MODBUS_RX_CRC_OK : MODBUS_RX_CRC_FAIL;
+        hmodbus->rx_crc = 0xFFFF;
+        hmodbus->rx_crc_count = 0;
+    } else {
+        hmodbus->rx_crc_result = MODBUS_RX_CRC_UNKNOWN;
+    }
+    if (hmodbus->rx_gap_error) {
+        hmodbus->rx_crc_result = MODBUS_RX_FRAME_GAP;
+        hmodbus->rx_gap_error = 0;
+    }
+    
+    /* 上一帧尚未处理即被新帧取代 */
+    if (hmodbus->rx_ready) {
+        MODBUS_STAT_INC(hmodbus, bus_overrun);
+    }
+    
+    /* 发布帧描述并推进帧起点 */
+    hmodbus->rx_frame_offset = tail;
+    hmodbus->rx_len = len;
+    hmodbus->rx_ring_tail = pos;
+    hmodbus->rx_ready = 1;
+    Modbus_RxPublish(hmodbus);
+}
 
 /**
- * @brief   更新从站地址
+ * @brief   乒乓模式帧结束: 交换缓冲区并重新启动接收
+ * @param   hmodbus Modbus句柄指针
+ * @param   size    当前接收缓冲区中的帧长度
  */
-void Modbus_SetSlaveAddr(ModbusHandle_t *hmodbus, uint8_t addr) {
-    if (hmodbus != NULL && addr >= 1 && addr <= 247) {
-        hmodbus->slave_addr = addr;
+static void Modbus_RxFrameComplete(ModbusHandle_t *hmodbus, uint16_t size) {
+    /* 乒乓缓冲切换:
+     * 1. 将当前接收缓冲区设为处理缓冲区
+     * 2. 记录接收数据长度
+     * 3. 切换中断接收目标到另一个缓冲区
+     * 4. 立即重新启动接收，减少数据丢失窗口 */
+    
+    if (size > 0) {
+        MODBUS_STAT_INC(hmodbus, bus_msg);
+    }
+    
+    /* 他站帧: 不交换缓冲区、不通知主循环，在同一缓冲区重新接收 */
+    if (size > 0 && !Modbus_RxAddrMatch(hmodbus, hmodbus->rx_active_buf[0])) {
+        hmodbus->rx_crc = 0xFFFF;
+        hmodbus->rx_crc_pos = 0;
+        hmodbus->rx_gap_error = 0;
+        hmodbus->rx_arm_offset = 0;
+        Modbus_PortStartRx(hmodbus, hmodbus->rx_active_buf, hmodbus->rx_buf_size);
+        return;
+    }
+    
+    /* 交换缓冲区指针 */
+    uint8_t *completed_buf = hmodbus->rx_active_buf;
+    hmodbus->rx_active_buf = (completed_buf == hmodbus->rx_buf_a) 
+                            ? hmodbus->rx_buf_b : hmodbus->rx_buf_a;
+    
+    /* 增量CRC: 计入尚未计算的剩余字节, 对含CRC字段的完整帧计算结果应为0 */
+    if (hmodbus->incremental_crc) {
+        Modbus_RxCrcUpdate(hmodbus, completed_buf, size);
+        hmodbus->rx_crc_result = (size >= 4 && hmodbus->rx_crc == 0)
+                               ? MODBUS_RX_CRC_OK : MODBUS_RX_CRC_FAIL;
+        hmodbus->rx_crc = 0xFFFF;
+        hmodbus->rx_crc_pos = 0;
+    } else {
+        hmodbus->rx_crc_result = MODBUS_RX_CRC_UNKNOWN;
     }
+    if (hmodbus->rx_gap_error) {
+        hmodbus->rx_crc_result = MODBUS_RX_FRAME_GAP;
+        hmodbus->rx_gap_error = 0;
+    }
+    hmodbus->rx_arm_offset = 0;
+    
+    /* 上一帧尚未处理即被新帧取代 */
+    if (hmodbus->rx_ready) {
+        MODBUS_STAT_INC(hmodbus, bus_overrun);
+    }
+    
+    /* 设置处理缓冲区和数据长度 */
+    hmodbus->rx_process_buf = completed_buf;
+    hmodbus->rx_len = size;
+    hmodbus->rx_ready = 1;
+    
+    /* 立即重新启动接收，指向新的缓冲区 */
+    Modbus_PortStartRx(hmodbus, hmodbus->rx_active_buf, hmodbus->rx_buf_size);
+    
+    Modbus_RxPublish(hmodbus);
 }
 
 /**
- * @brief   更新波特率
+ * @brief   获取当前接收位置
+ * @param   hmodbus Modbus句柄指针
+ * @return  环形模式: DMA写入位置; 乒乓模式: 当前缓冲区中已接收的字节数
+ * 
+ * @note    由DMA剩余计数、HAL中断接收计数或传输层接收计数得到，不依赖空闲事件
  */
-void Modbus_SetBaudRate(ModbusHandle_t *hmodbus, uint32_t baud_rate) {
-    if (hmodbus != NULL && baud_rate > 0) {
-        hmodbus->baud_rate = baud_rate;
+static uint16_t Modbus_RxPosition(const ModbusHandle_t *hmodbus) {
+    const UART_HandleTypeDef *huart = hmodbus->huart;
+    
+    if (hmodbus->transport != NULL) {
+        uint16_t received = (hmodbus->transport->rx_count != NULL) ? hmodbus->transport->rx_count(hmodbus) : 0;
+        return hmodbus->rx_arm_offset + received;
+    }
+    
+    if (hmodbus->rx_mode == MODBUS_RX_DMA_RING) {
+        uint16_t pos = hmodbus->rx_buf_size - (uint16_t)__HAL_DMA_GET_COUNTER(huart->hdmarx);
+        return (pos >= hmodbus->rx_buf_size) ? 0 : pos;
     }
+    
+    /* 仅在中断接收进行中时统计本次启动后接收的字节数 */
+    uint16_t offset = hmodbus->rx_arm_offset;
+    if (huart->RxXferSize != hmodbus->rx_buf_size - offset || huart->RxXferCount > huart->RxXferSize) {
+        return offset;
+    }
+    
+    return offset + (huart->RxXferSize - huart->RxXferCount);
 }
 
 /**
- * @brief   启动UART接收
+ * @brief   t3.5到期(接收超时或帧定时器): 以当前接收位置结束帧
+ * @param   hmodbus Modbus句柄指针
+ * 
+ * @note    仅在中断上下文中调用
  */
-void Modbus_StartReceive(ModbusHandle_t *hmodbus) {
-    if (hmodbus != NULL && hmodbus->huart != NULL) {
-        HAL_UARTEx_ReceiveToIdle_IT(hmodbus->huart, hmodbus->rx_active_buf, hmodbus->rx_buf_size);
+static void Modbus_RxFrameTimeout(ModbusHandle_t *hmodbus) {
+    uint16_t pos = Modbus_RxPosition(hmodbus);
+    
+    if (hmodbus->rx_mode == MODBUS_RX_DMA_RING) {
+        Modbus_RxRingFrameEnd(hmodbus, pos);
+        return;
+    }
+    
+    if (pos == 0) {
+        return;  /* 无数据 */
     }
+    
+    /* 中断接收仍在进行(候选帧尾后续接)，停止后切换缓冲区 */
+    HAL_UART_AbortReceive(hmodbus->huart);
+    Modbus_RxFrameComplete(hmodbus, pos);
 }
 
-/* ============================================================================
- *                              底层辅助函数
- * ============================================================================ */
+/**
+ * @brief   计算t1.5/t3.5并配置帧定界硬件
+ * @param   hmodbus Modbus句柄指针
+ * 
+ * @note    在初始化及波特率更新时调用
+ *          字符时间按11位(起始位+8数据位+校验位/第二停止位+停止位)计算;
+ *          空闲线检测延迟按10位计算，使定时器补足的剩余时间不短于规定值
+ */
+static void Modbus_FramingSetup(ModbusHandle_t *hmodbus) {
+    uint32_t baud = hmodbus->baud_rate;
+    
+    if (baud == 0 || baud > MODBUS_FIXED_TIMING_BAUD) {
+        hmodbus->t15_us = MODBUS_T15_FIXED_US;
+        hmodbus->t35_us = MODBUS_T35_FIXED_US;
+    } else {
+        hmodbus->t15_us = (16500000UL + baud - 1) / baud;  /* 1.5 x 11位 */
+        hmodbus->t35_us = (38500000UL + baud - 1) / baud;  /* 3.5 x 11位 */
+    }
+    hmodbus->tidle_us = (baud != 0) ? 10000000UL / baud : 0;
+    
+    if (baud == 0) {
+        return;  /* 未配置波特率: 仅提供固定定时值 (定时帧定界要求 baud_rate > 0) */
+    }
+    
+#if MODBUS_RTO_SUPPORTED
+    if (hmodbus->framing.mode == MODBUS_FRAMING_RTO) {
+        /* RTOR以位时间为单位，从最后一个字符的停止位之后开始计数 */
+        USART_TypeDef *uart = hmodbus->huart->Instance;
+        uint32_t bits = (uint32_t)(((uint64_t)hmodbus->t35_us * baud + 999999U) / 1000000U);
+        
+        MODIFY_REG(uart->RTOR, USART_RTOR_RTO, bits);
+        SET_BIT(uart->CR2, USART_CR2_RTOEN);
+        uart->ICR = USART_ICR_RTOCF;
+        SET_BIT(uart->CR1, USART_CR1_RTOIE);
+    }
+#endif
+    
+#if defined(HAL_TIM_MODULE_ENABLED)
+    if (hmodbus->framing.mode == MODBUS_FRAMING_TIMER) {
+        /* 单脉冲模式: 到期后自动停止; URS: 软件更新事件不产生中断 */
+        TIM_TypeDef *tim = hmodbus->framing.htim->Instance;
+        
+        CLEAR_BIT(tim->CR1, TIM_CR1_CEN);
+        SET_BIT(tim->CR1, TIM_CR1_OPM | TIM_CR1_URS);
+        tim->SR = ~(uint32_t)TIM_SR_UIF;
+        SET_BIT(tim->DIER, TIM_DIER_UIE);
+    }
+#endif
+}
 
 /**
- * @brief   计算CRC16校验码
+ * @brief   定时帧定界: 处理空闲事件(候选帧尾)
  * @param   hmodbus Modbus句柄指针
- * @param   buffer  数据缓冲区指针
- * @param   length  数据长度
- * @return  16位CRC校验码
+ * @param   pos     当前接收位置
+ * 
+ * @note    接收超时模式下由硬件计时，无需处理;
+ *          定时器模式下从空闲检测时刻起补足剩余的t1.5或t3.5
  */
-static uint16_t Modbus_CRC16(const ModbusHandle_t *hmodbus, const uint8_t *buffer, uint16_t length) {
-    uint16_t crc = 0xFFFF;
+static void Modbus_FramingIdle(ModbusHandle_t *hmodbus, uint16_t pos) {
+#if defined(HAL_TIM_MODULE_ENABLED)
+    if (hmodbus->framing.mode != MODBUS_FRAMING_TIMER) {
+        return;
+    }
     
-    if (hmodbus->use_crc_table) {
-        /* 查表法: 速度快约10倍 */
-        for (uint16_t i = 0; i < length; i++) {
-            crc = (crc >> 8) ^ CRC16_TABLE[(crc ^ buffer[i]) & 0xFF];
-        }
+    /* t1.5已到期后又收到字符: 帧内间隔超过t1.5 */
+    if (hmodbus->rx_timer_stage == 2 && hmodbus->framing.strict_t15) {
+        hmodbus->rx_gap_error = 1;
+    }
+    
+    hmodbus->rx_timer_mark = pos;
+    if (hmodbus->framing.strict_t15) {
+        hmodbus->rx_timer_stage = 1;
+        Modbus_FramingTimerStart(hmodbus, hmodbus->t15_us - hmodbus->tidle_us);
     } else {
-        /* 移位法: 代码体积小 */
-        for (uint16_t i = 0; i < length; i++) {
-            crc ^= buffer[i];
-            for (int j = 0; j < 8; j++) {
-                if (crc & 1) {
-                    crc = (crc >> 1) ^ 0xA001;
-                } else {
-                    crc >>= 1;
-                }
-            }
-        }
+        hmodbus->rx_timer_stage = 2;
+        Modbus_FramingTimerStart(hmodbus, hmodbus->t35_us - hmodbus->tidle_us);
     }
+#else
+    (void)hmodbus;
+    (void)pos;
+#endif
+}
+
+#if defined(HAL_TIM_MODULE_ENABLED)
+/**
+ * @brief   启动帧定时器单次计时
+ * @param   hmodbus Modbus句柄指针
+ * @param   us      计时时长 (us, 定时器为1MHz计数)
+ * 
+ * @note    16位定时器最长计时65.536ms，低于600波特率时t3.5被截断
+ */
+static void Modbus_FramingTimerStart(const ModbusHandle_t *hmodbus, uint32_t us) {
+    TIM_TypeDef *tim = hmodbus->framing.htim->Instance;
     
-    return crc;
+    if (us < 2) {
+        us = 2;
+    } else if (us > 0x10000UL) {
+        us = 0x10000UL;
+    }
+    
+    CLEAR_BIT(tim->CR1, TIM_CR1_CEN);
+    tim->ARR = us - 1;
+    tim->CNT = 0;
+    tim->EGR = TIM_EGR_UG;              /* 立即装载ARR (URS=1时不置位UIF) */
+    tim->SR = ~(uint32_t)TIM_SR_UIF;
+    SET_BIT(tim->CR1, TIM_CR1_CEN);
 }
+#endif
 
 /**
  * @brief   RS485切换到发送模式
  */
 static void Modbus_RS485_SetTxMode(const ModbusHandle_t *hmodbus) {
-    if (hmodbus->rs485.enabled && hmodbus->rs485.de_port != NULL) {
+    if (!hmodbus->rs485.enabled || hmodbus->rs485.hw_de) {
+        return;
+    }
+    
+    if (hmodbus->transport != NULL && hmodbus->transport->set_direction != NULL) {
+        hmodbus->transport->set_direction(hmodbus, true);
+    } else if (hmodbus->rs485.de_port != NULL) {
         if (hmodbus->rs485.de_polarity) {
             HAL_GPIO_WritePin(hmodbus->rs485.de_port, hmodbus->rs485.de_pin, GPIO_PIN_SET);
         } else {
@@ -679,7 +4107,13 @@ static void Modbus_RS485_SetTxMode(const ModbusHandle_t *hmodbus) {
  * @brief   RS485切换到接收模式
  */
 static void Modbus_RS485_SetRxMode(const ModbusHandle_t *hmodbus) {
-    if (hmodbus->rs485.enabled && hmodbus->rs485.de_port != NULL) {
+    if (!hmodbus->rs485.enabled || hmodbus->rs485.hw_de) {
+        return;
+    }
+    
+    if (hmodbus->transport != NULL && hmodbus->transport->set_direction != NULL) {
+        hmodbus->transport->set_direction(hmodbus, false);
+    } else if (hmodbus->rs485.de_port != NULL) {
         if (hmodbus->rs485.de_polarity) {
             HAL_GPIO_WritePin(hmodbus->rs485.de_port, hmodbus->rs485.de_pin, GPIO_PIN_RESET);
         } else {
@@ -688,6 +4122,88 @@ static void Modbus_RS485_SetRxMode(const ModbusHandle_t *hmodbus) {
     }
 }
 
+#if MODBUS_HW_DE_SUPPORTED
+/**
+ * @brief   配置USART硬件DE (驱动使能) 功能
+ * @param   hmodbus Modbus句柄指针
+ * 
+ * @note    DEM/DEP/DEAT/DEDT 仅能在USART禁用(UE=0)时修改，配置期间短暂关闭USART
+ *          此后DE在每次发送时由硬件自动驱动，软件无需在发送前后切换方向
+ */
+static void Modbus_RS485_HwDeSetup(const ModbusHandle_t *hmodbus) {
+    USART_TypeDef *uart = hmodbus->huart->Instance;
+    bool was_enabled = (uart->CR1 & USART_CR1_UE) != 0U;
+    
+    __HAL_UART_DISABLE(hmodbus->huart);
+    MODIFY_REG(uart->CR1, USART_CR1_DEAT | USART_CR1_DEDT,
+               ((uint32_t)hmodbus->rs485.de_assert_time << USART_CR1_DEAT_Pos) |
+               ((uint32_t)hmodbus->rs485.de_deassert_time << USART_CR1_DEDT_Pos));
+    
+    /* DEP=0: DE高电平有效 */
+    MODIFY_REG(uart->CR3, USART_CR3_DEP, hmodbus->rs485.de_polarity ? 0U : USART_CR3_DEP);
+    SET_BIT(uart->CR3, USART_CR3_DEM);
+    
+    if (was_enabled) {
+        __HAL_UART_ENABLE(hmodbus->huart);
+    }
+}
+#endif
+
+#if MODBUS_STOP_WAKE_SUPPORTED
+/**
+ * @brief   选择USART自STOP模式的唤醒源
+ * @param   hmodbus Modbus句柄指针
+ * 
+ * @note    WUS 仅能在USART禁用(UE=0)时修改，配置期间短暂关闭USART
+ *          选择起始位唤醒: MCU在首字节接收期间即开始恢复，该字节由HSI/LSE时钟继续接收;
+ *          无WUS字段的芯片由RXNE唤醒 (需中断接收)
+ */
+static void Modbus_StopWakeSetup(const ModbusHandle_t *hmodbus) {
+#if defined(USART_CR3_WUS)
+    USART_TypeDef *uart = hmodbus->huart->Instance;
+    bool was_enabled = (uart->CR1 & USART_CR1_UE) != 0U;
+    
+    __HAL_UART_DISABLE(hmodbus->huart);
+    MODIFY_REG(uart->CR3, USART_CR3_WUS, USART_CR3_WUS_1);
+    
+    if (was_enabled) {
+        __HAL_UART_ENABLE(hmodbus->huart);
+    }
+#else
+    (void)hmodbus;
+#endif
+}
+#endif
+
+/**
+ * @brief   启动接收 (传输层或HAL空闲中断接收)
+ * @param   hmodbus Modbus句柄指针
+ * @param   buf     接收缓冲区
+ * @param   size    最大接收字节数
+ */
+static void Modbus_PortStartRx(const ModbusHandle_t *hmodbus, uint8_t *buf, uint16_t size) {
+    if (hmodbus->transport != NULL) {
+        (void)hmodbus->transport->start_rx(hmodbus, buf, size);
+    } else {
+        HAL_UARTEx_ReceiveToIdle_IT(hmodbus->huart, buf, size);
+    }
+}
+
+/**
+ * @brief   启动异步发送 (传输层或HAL DMA发送)
+ * @param   hmodbus Modbus句柄指针
+ * @param   data    发送数据 (完成回调前保持有效)
+ * @param   len     字节数
+ * @retval  true    已启动，完成时回调 Modbus_TxCallback()
+ * @retval  false   发送器忙
+ */
+static bool Modbus_PortSend(const ModbusHandle_t *hmodbus, const uint8_t *data, uint16_t len) {
+    if (hmodbus->transport != NULL) {
+        return hmodbus->transport->send(hmodbus, data, len);
+    }
+    return HAL_UART_Transmit_DMA(hmodbus->huart, data, len) == HAL_OK;
+}
+
 /**
  * @brief   发送Modbus响应帧
  * @param   hmodbus Modbus句柄指针
@@ -696,6 +4212,7 @@ static void Modbus_RS485_SetRxMode(const ModbusHandle_t *hmodbus) {
 static void Modbus_SendResponse(ModbusHandle_t *hmodbus, uint16_t len) {
     /* 检查发送缓冲区大小 */
     if (len + 2 > hmodbus->tx_buf_size) {
+        MODBUS_STAT_INC(hmodbus, tx_dropped);
         return;  /* 缓冲区不足 */
     }
     
@@ -703,16 +4220,41 @@ static void Modbus_SendResponse(ModbusHandle_t *hmodbus, uint16_t len) {
     uint16_t crc = Modbus_CRC16(hmodbus, hmodbus->tx_buf, len);
     hmodbus->tx_buf[len] = crc & 0xFF;
     hmodbus->tx_buf[len + 1] = (crc >> 8) & 0xFF;
-    uint16_t total_len = len + 2;
+    Modbus_SendFrame(hmodbus, len + 2);
+}
+
+/**
+ * @brief   发送当前构建槽中已含CRC的完整帧 (入队或阻塞发送)
+ * @param   hmodbus   Modbus句柄指针
+ * @param   total_len 帧长度(含CRC，不超过 tx_buf_size)
+ */
+static void Modbus_SendFrame(ModbusHandle_t *hmodbus, uint16_t total_len) {
+    MODBUS_STAT_INC(hmodbus, tx_frames);
+    Modbus_TimingParseEnd(hmodbus);
     
-    /* RS485方向控制: 切换为发送模式 */
-    Modbus_RS485_SetTxMode(hmodbus);
+    /* 响应已组帧完毕，发送期间不再占用数据区 */
+    Modbus_DataUnlock(hmodbus);
     
-    if (hmodbus->use_dma_tx) {
-        /* DMA模式: 非阻塞发送，释放CPU
-         * RS485方向切换在 Modbus_TxCallback 中处理 */
-        HAL_UART_Transmit_DMA(hmodbus->huart, hmodbus->tx_buf, total_len);
+    if (MODBUS_ASYNC_TX(hmodbus)) {
+        /* DMA模式: 响应入队后立即返回，发送器空闲时立即启动
+         * RS485方向切换与队列推进在 Modbus_TxCallback 中处理 */
+        uint8_t slot = (hmodbus->tx_head + hmodbus->tx_count) % hmodbus->tx_slots;
+        hmodbus->tx_slot_len[slot] = total_len;
+        
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        hmodbus->tx_count++;
+        bool start = (hmodbus->tx_state == MODBUS_TX_IDLE && hmodbus->tx_count == 1);
+        __set_PRIMASK(primask);
+        
+        if (start) {
+            Modbus_TxStart(hmodbus);
+        }
     } else {
+        /* RS485方向控制: 切换为发送模式 */
+        Modbus_RS485_SetTxMode(hmodbus);
+        hmodbus->tx_state = MODBUS_TX_SENDING;
+        
         /* 阻塞模式: 动态计算超时时间 (ms)
          * 公式: timeout = (字节数 * 10位 * 1000ms) / 波特率 + 安全余量
          * 10位 = 1起始位 + 8数据位 + 1停止位
@@ -727,14 +4269,162 @@ static void Modbus_SendResponse(ModbusHandle_t *hmodbus, uint16_t len) {
         }
         
         /* 阻塞式发送 */
+        Modbus_TimingTxBegin(hmodbus);
         HAL_UART_Transmit(hmodbus->huart, hmodbus->tx_buf, total_len, timeout);
+        Modbus_TimingTxEnd(hmodbus, hmodbus->tx_buf[1]);
         
-        /* RS485方向控制: 等待TC标志后切回接收模式 */
-        if (hmodbus->rs485.enabled) {
-            while (__HAL_UART_GET_FLAG(hmodbus->huart, UART_FLAG_TC) == RESET);
-            Modbus_RS485_SetRxMode(hmodbus);
+        /* RS485方向控制: HAL_UART_Transmit() 返回前已等待TC标志，最后一个字节已完全发出 */
+        Modbus_RS485_SetRxMode(hmodbus);
+        hmodbus->tx_state = MODBUS_TX_IDLE;
+    }
+}
+
+#if MODBUS_FC_03_ENABLED || MODBUS_FC_04_ENABLED
+/**
+ * @brief   流水线发送: 先行发送响应帧头 (从站地址 + 功能码 + 字节数)
+ * @param   hmodbus Modbus句柄指针
+ * @param   len     完整响应数据部分长度(不含CRC)
+ * 
+ * @note    帧头在线路上发送期间，主循环继续填充数据并计算CRC，
+ *          随后由 Modbus_SendPipelinedBody() 或发送完成中断接续发送
+ *          未启用流水线或发送未能启动时不做任何操作，处理函数返回响应长度，按普通响应整帧发送
+ */
+static void Modbus_SendPipelinedHeader(ModbusHandle_t *hmodbus, uint16_t len) {
+    if (!hmodbus->pipelined_tx || len + 2 > hmodbus->tx_buf_size) {
+        return;
+    }
+    
+    /* 仅在发送器空闲且队列为空时先行发送，此时当前构建槽即为队首 */
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (hmodbus->tx_state != MODBUS_TX_IDLE || hmodbus->tx_count != 0) {
+        __set_PRIMASK(primask);
+        return;
+    }
+    hmodbus->tx_state = MODBUS_TX_SENDING;
+    hmodbus->tx_count = 1;
+    __set_PRIMASK(primask);
+    
+    hmodbus->tx_slot_len[hmodbus->tx_head] = len + 2;
+    hmodbus->tx_pipe_len = 0;
+    hmodbus->tx_pipe_state = MODBUS_TX_PIPE_HEADER;
+    
+    Modbus_RS485_SetTxMode(hmodbus);
+    Modbus_TimingTxBegin(hmodbus);
+    if (!Modbus_PortSend(hmodbus, hmodbus->tx_buf, MODBUS_TX_PIPE_HEADER_LEN)) {
+        /* 发送器忙: 释放队首槽，回退为整帧发送 */
+        hmodbus->tx_pipe_state = MODBUS_TX_PIPE_IDLE;
+        hmodbus->tx_count = 0;
+        hmodbus->tx_state = MODBUS_TX_IDLE;
+    }
+}
+
+/**
+ * @brief   流水线发送: 追加CRC并接续发送帧头之后的数据部分
+ * @param   hmodbus Modbus句柄指针
+ * @param   len     完整响应数据部分长度(不含CRC)
+ * 
+ * @note    帧头已发完则立即启动，否则登记长度由发送完成中断启动;
+ *          二者在临界区内判定，保证数据部分只被启动一次
+ *          仅在 Modbus_SendPipelinedHeader() 已先行发送帧头后调用
+ */
+static void Modbus_SendPipelinedBody(ModbusHandle_t *hmodbus, uint16_t len) {
+    /* CRC覆盖整帧，帧头仍保留在tx_buf中，DMA读取期间可并发计算 */
+    uint16_t crc = Modbus_CRC16(hmodbus, hmodbus->tx_buf, len);
+    hmodbus->tx_buf[len] = crc & 0xFF;
+    hmodbus->tx_buf[len + 1] = (crc >> 8) & 0xFF;
+    Modbus_DataUnlock(hmodbus);
+    MODBUS_STAT_INC(hmodbus, tx_frames);
+    Modbus_TimingParseEnd(hmodbus);
+    
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (hmodbus->tx_pipe_state == MODBUS_TX_PIPE_HEADER_DONE) {
+        hmodbus->tx_pipe_state = MODBUS_TX_PIPE_IDLE;
+        __set_PRIMASK(primask);
+        (void)Modbus_PortSend(hmodbus, &hmodbus->tx_buf[MODBUS_TX_PIPE_HEADER_LEN],
+                              len + 2 - MODBUS_TX_PIPE_HEADER_LEN);
+        return;
+    }
+    hmodbus->tx_pipe_len = len + 2;
+    __set_PRIMASK(primask);
+}
+#endif
+
+/**
+ * @brief   启动队首响应的异步发送 (DMA或传输层)
+ * @param   hmodbus Modbus句柄指针
+ */
+static void Modbus_TxStart(ModbusHandle_t *hmodbus) {
+    uint8_t head = hmodbus->tx_head;
+    
+    hmodbus->tx_state = MODBUS_TX_SENDING;
+    Modbus_RS485_SetTxMode(hmodbus);
+    Modbus_TimingTxBegin(hmodbus);
+    
+    if (!Modbus_PortSend(hmodbus, MODBUS_TX_SLOT(hmodbus, head), hmodbus->tx_slot_len[head])) {
+        /* 发送器被其他用户占用: 丢弃该响应，由下次 Modbus_Process() 继续推进队列 */
+        Modbus_RS485_SetRxMode(hmodbus);
+        Modbus_TxComplete(hmodbus);
+    }
+}
+
+/**
+ * @brief   队首响应发送完成: 出队并进入下一状态
+ * @param   hmodbus Modbus句柄指针
+ * 
+ * @note    队列非空时进入 MODBUS_TX_TURNAROUND，由 Modbus_TxPoll() 在t3.5后启动下一帧
+ */
+static void Modbus_TxComplete(ModbusHandle_t *hmodbus) {
+    if (hmodbus->tx_count > 0) {
+        Modbus_TimingTxEnd(hmodbus, MODBUS_TX_SLOT(hmodbus, hmodbus->tx_head)[1]);
+    }
+    
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (hmodbus->tx_count > 0) {
+        hmodbus->tx_head = (hmodbus->tx_head + 1) % hmodbus->tx_slots;
+        hmodbus->tx_count--;
+    }
+    if (hmodbus->tx_count > 0) {
+        hmodbus->tx_done_tick = (hmodbus->transport != NULL && hmodbus->transport->now_us != NULL)
+                              ? hmodbus->transport->now_us(hmodbus) : HAL_GetTick();
+        hmodbus->tx_state = MODBUS_TX_TURNAROUND;
+    } else {
+        hmodbus->tx_state = MODBUS_TX_IDLE;
+    }
+    __set_PRIMASK(primask);
+    
+    /* 有排队响应或挂起请求时唤醒主循环处理 */
+    if (hmodbus->tx_count > 0 || hmodbus->rx_ready) {
+        Modbus_SignalReady(hmodbus);
+    }
+}
+
+/**
+ * @brief   推进发送队列
+ * @param   hmodbus Modbus句柄指针
+ * 
+ * @note    在主循环中调用; 帧间隔按ms节拍向上取整并多等待1个节拍，保证不短于t3.5;
+ *          传输层提供微秒时基时按t3.5精确计时
+ */
+static void Modbus_TxPoll(ModbusHandle_t *hmodbus) {
+    if (hmodbus->tx_state != MODBUS_TX_TURNAROUND) {
+        return;
+    }
+    
+    if (hmodbus->transport != NULL && hmodbus->transport->now_us != NULL) {
+        if (hmodbus->transport->now_us(hmodbus) - hmodbus->tx_done_tick < hmodbus->t35_us) {
+            return;
+        }
+    } else {
+        uint32_t gap_ms = (hmodbus->t35_us + 999U) / 1000U + 1U;
+        if (HAL_GetTick() - hmodbus->tx_done_tick < gap_ms) {
+            return;
         }
     }
+    
+    Modbus_TxStart(hmodbus);
 }
 
 /**
@@ -744,8 +4434,25 @@ static void Modbus_SendResponse(ModbusHandle_t *hmodbus, uint16_t len) {
  * @param   exception_code 异常码
  */
 static void Modbus_SendException(ModbusHandle_t *hmodbus, uint8_t func_code, uint8_t exception_code) {
-    hmodbus->tx_buf[0] = hmodbus->slave_addr;
-    hmodbus->tx_buf[1] = func_code | 0x80;  /* 功能码最高位置1表示异常 */
-    hmodbus->tx_buf[2] = exception_code;
-    Modbus_SendResponse(hmodbus, 3);
+    Modbus_SendResponse(hmodbus, Modbus_ExceptionReply(hmodbus, hmodbus->tx_buf, func_code, exception_code));
+}
+
+/**
+ * @brief   组装异常响应
+ * @param   hmodbus         Modbus句柄指针
+ * @param   tx              响应缓冲区 (至少3字节)
+ * @param   func_code       原始功能码
+ * @param   exception_code  异常码
+ * @return  响应长度 (不含CRC)
+ */
+static uint16_t Modbus_ExceptionReply(ModbusHandle_t *hmodbus, uint8_t *tx, uint8_t func_code, uint8_t exception_code) {
+    MODBUS_STAT_INC(hmodbus, bus_exception);
+    if (exception_code == MB_EX_SLAVE_DEVICE_BUSY) {
+        MODBUS_STAT_INC(hmodbus, slave_busy);
+    }
+    
+    tx[0] = hmodbus->slave_addr;
+    tx[1] = func_code | 0x80;  /* 功能码最高位置1表示异常 */
+    tx[2] = exception_code;
+    return 3;
 }
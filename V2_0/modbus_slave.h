@@ -34,10 +34,158 @@ extern "C" {
 #define MB_FUNC_READ_INPUT           0x04    /**< 读输入寄存器 */
 #define MB_FUNC_WRITE_SINGLE_COIL    0x05    /**< 写单个线圈 */
 #define MB_FUNC_WRITE_SINGLE_REG     0x06    /**< 写单个寄存器 */
+#define MB_FUNC_DIAGNOSTICS          0x08    /**< 诊断 */
 #define MB_FUNC_WRITE_MULTI_COILS    0x0F    /**< 写多个线圈 */
 #define MB_FUNC_WRITE_MULTI_REGS     0x10    /**< 写多个寄存器 */
+#define MB_FUNC_MASK_WRITE_REG       0x16    /**< 屏蔽写寄存器 */
+#define MB_FUNC_READ_WRITE_REGS      0x17    /**< 读写多个寄存器 */
 #define MB_FUNC_CUSTOM_CONFIG        0x64    /**< 自定义功能码: 设备配置 */
 
+/** @brief 0x08诊断子功能码 */
+#define MB_DIAG_RETURN_QUERY_DATA    0x0000  /**< 回送请求数据 */
+#define MB_DIAG_RESTART_COMM         0x0001  /**< 重启通信选项 (仅清除计数器) */
+#define MB_DIAG_RETURN_REGISTER      0x0002  /**< 返回诊断寄存器 (恒为0) */
+#define MB_DIAG_CLEAR_COUNTERS       0x000A  /**< 清除计数器与诊断寄存器 */
+#define MB_DIAG_BUS_MESSAGE_COUNT    0x000B  /**< 总线报文计数 */
+#define MB_DIAG_BUS_COMM_ERROR_COUNT 0x000C  /**< 总线通信错误计数 */
+#define MB_DIAG_BUS_EXCEPTION_COUNT  0x000D  /**< 异常响应计数 */
+#define MB_DIAG_SLAVE_MESSAGE_COUNT  0x000E  /**< 本站报文计数 */
+#define MB_DIAG_SLAVE_NO_RESP_COUNT  0x000F  /**< 本站未应答计数 */
+#define MB_DIAG_SLAVE_NAK_COUNT      0x0010  /**< 否定应答计数 (恒为0) */
+#define MB_DIAG_SLAVE_BUSY_COUNT     0x0011  /**< 从站忙计数 */
+#define MB_DIAG_BUS_OVERRUN_COUNT    0x0012  /**< 字符溢出计数 */
+#define MB_DIAG_TIMING_HISTOGRAM     0x0064  /**< 厂商扩展: 读取耗时直方图 (数据字段为 Modbus_Timing_t) */
+
+/* ============================================================================
+ *                              编译期配置档 (可选)
+ * ============================================================================ */
+
+/**
+ * @brief   编译期配置档开关 (1=包含 modbus_profile.h, 0=全部由 Modbus_Config_t 运行时配置)
+ * @note    配置档在编译期固定CRC后端、发送方式与寄存器布局，协议栈按常量编译，
+ *          相应的运行时分支与数据区间接访问被编译器消除; 功能码裁剪等宏也可在配置档中设置
+ *          由编译选项定义 (如 -DMODBUS_PROFILE=1)，协议栈与应用须使用相同的定义
+ */
+#ifndef MODBUS_PROFILE
+#define MODBUS_PROFILE               0
+#endif
+
+/** @brief 配置档取值: 该项保持运行时配置 */
+#define MODBUS_PROFILE_RUNTIME       0
+
+/** @brief MODBUS_PROFILE_CRC 取值 (与 Modbus_CrcMode_t 相同) */
+#define MODBUS_PROFILE_CRC_SHIFT     1       /**< 移位法 */
+#define MODBUS_PROFILE_CRC_TABLE     2       /**< 256项查表法 */
+#define MODBUS_PROFILE_CRC_NIBBLE    3       /**< 16项半字节查表法 */
+#define MODBUS_PROFILE_CRC_HARDWARE  4       /**< 硬件CRC外设 */
+
+/** @brief MODBUS_PROFILE_TX 取值 */
+#define MODBUS_PROFILE_TX_BLOCKING   1       /**< 阻塞发送 (不支持 transport) */
+#define MODBUS_PROFILE_TX_ASYNC      2       /**< DMA发送或传输层发送 */
+
+#if MODBUS_PROFILE
+#include "modbus_profile.h"
+#endif
+
+#ifndef MODBUS_PROFILE_CRC
+#define MODBUS_PROFILE_CRC           MODBUS_PROFILE_RUNTIME
+#endif
+#ifndef MODBUS_PROFILE_TX
+#define MODBUS_PROFILE_TX            MODBUS_PROFILE_RUNTIME
+#endif
+
+/**
+ * @brief   编译期寄存器布局: 定义任一 MODBUS_PROFILE_<区>(X) 段表宏后启用，data_map 被忽略
+ * @note    段表宏按 base 升序列出 X(base, count, data, flags)，未定义的数据区不支持
+ */
+#if defined(MODBUS_PROFILE_COILS) || defined(MODBUS_PROFILE_DISCRETE) || \
+    defined(MODBUS_PROFILE_HOLDING) || defined(MODBUS_PROFILE_INPUT)
+#define MODBUS_PROFILE_LAYOUT        1
+#ifndef MODBUS_PROFILE_COILS
+#define MODBUS_PROFILE_COILS(X)
+#endif
+#ifndef MODBUS_PROFILE_DISCRETE
+#define MODBUS_PROFILE_DISCRETE(X)
+#endif
+#ifndef MODBUS_PROFILE_HOLDING
+#define MODBUS_PROFILE_HOLDING(X)
+#endif
+#ifndef MODBUS_PROFILE_INPUT
+#define MODBUS_PROFILE_INPUT(X)
+#endif
+#else
+#define MODBUS_PROFILE_LAYOUT        0
+#endif
+
+/* ============================================================================
+ *                              内置功能码裁剪
+ * ============================================================================ */
+
+/**
+ * @brief   统计与诊断计数器 (1=编入, 0=裁剪)
+ * @note    每个实例约占用230字节RAM (其中耗时直方图约170字节); 0x08诊断功能码依赖此开关
+ */
+#ifndef MODBUS_STATS_ENABLED
+#define MODBUS_STATS_ENABLED         1
+#endif
+
+/**
+ * @brief   内置功能码处理函数编译开关 (1=编入, 0=裁剪)
+ * @note    裁剪后该功能码返回非法功能码异常，也可用 Modbus_RegisterFunction() 另行注册
+ */
+#ifndef MODBUS_FC_01_ENABLED
+#define MODBUS_FC_01_ENABLED         1       /**< 0x01 读线圈状态 */
+#endif
+#ifndef MODBUS_FC_02_ENABLED
+#define MODBUS_FC_02_ENABLED         1       /**< 0x02 读离散输入 */
+#endif
+#ifndef MODBUS_FC_03_ENABLED
+#define MODBUS_FC_03_ENABLED         1       /**< 0x03 读保持寄存器 */
+#endif
+#ifndef MODBUS_FC_04_ENABLED
+#define MODBUS_FC_04_ENABLED         1       /**< 0x04 读输入寄存器 */
+#endif
+#ifndef MODBUS_FC_05_ENABLED
+#define MODBUS_FC_05_ENABLED         1       /**< 0x05 写单个线圈 */
+#endif
+#ifndef MODBUS_FC_06_ENABLED
+#define MODBUS_FC_06_ENABLED         1       /**< 0x06 写单个寄存器 */
+#endif
+#ifndef MODBUS_FC_08_ENABLED
+#define MODBUS_FC_08_ENABLED         MODBUS_STATS_ENABLED /**< 0x08 诊断 (需 MODBUS_STATS_ENABLED) */
+#endif
+#ifndef MODBUS_FC_0F_ENABLED
+#define MODBUS_FC_0F_ENABLED         1       /**< 0x0F 写多个线圈 */
+#endif
+#ifndef MODBUS_FC_10_ENABLED
+#define MODBUS_FC_10_ENABLED         1       /**< 0x10 写多个寄存器 */
+#endif
+#ifndef MODBUS_FC_16_ENABLED
+#define MODBUS_FC_16_ENABLED         1       /**< 0x16 屏蔽写寄存器 */
+#endif
+#ifndef MODBUS_FC_17_ENABLED
+#define MODBUS_FC_17_ENABLED         1       /**< 0x17 读写多个寄存器 */
+#endif
+#ifndef MODBUS_FC_64_ENABLED
+#define MODBUS_FC_64_ENABLED         1       /**< 0x64 自定义配置 (custom_config_cb) */
+#endif
+
+/**
+ * @brief   功能码分发表大小 (可注册功能码 1 ~ MODBUS_FUNC_TABLE_SIZE-1)
+ * @note    分发表位于RAM (每项一个函数指针); 不需要高位厂商功能码时可减小，但不得小于0x65
+ */
+#ifndef MODBUS_FUNC_TABLE_SIZE
+#define MODBUS_FUNC_TABLE_SIZE       128
+#endif
+
+#if MODBUS_FC_08_ENABLED && !MODBUS_STATS_ENABLED
+#error "MODBUS_FC_08_ENABLED requires MODBUS_STATS_ENABLED"
+#endif
+
+#if MODBUS_FUNC_TABLE_SIZE > 128 || MODBUS_FUNC_TABLE_SIZE <= MB_FUNC_CUSTOM_CONFIG
+#error "MODBUS_FUNC_TABLE_SIZE must be in (0x64, 128]"
+#endif
+
 /* ============================================================================
  *                              Modbus异常码定义
  * ============================================================================ */
@@ -46,12 +194,175 @@ extern "C" {
 #define MB_EX_ILLEGAL_DATA_ADDRESS   0x02    /**< 非法数据地址 */
 #define MB_EX_ILLEGAL_DATA_VALUE     0x03    /**< 非法数据值 */
 #define MB_EX_SLAVE_DEVICE_FAILURE   0x04    /**< 从站设备故障 */
+#define MB_EX_SLAVE_DEVICE_BUSY      0x06    /**< 从站设备忙 */
+#define MB_EX_GATEWAY_PATH           0x0A    /**< 网关路径不可用 */
+#define MB_EX_GATEWAY_TARGET         0x0B    /**< 网关目标设备无响应 */
+
+/** @brief Modbus RTU帧(ADU)最大长度: 地址1 + PDU253 + CRC2 */
+#define MODBUS_RTU_ADU_MAX           256
 
 /* ============================================================================
  *                              类型前向声明
  * ============================================================================ */
 
 typedef struct ModbusHandle ModbusHandle_t;
+typedef struct Modbus_Segment Modbus_Segment_t;
+
+/* ============================================================================
+ *                              CRC算法选择
+ * ============================================================================ */
+
+/**
+ * @brief   硬件CRC支持检测
+ * @note    需芯片CRC外设支持可编程多项式(CRC_POL寄存器)，如F0/F3/F7/G0/G4/L4/H7
+ *          F1/F2/F4的CRC外设为固定CRC-32，无法计算CRC16-Modbus
+ *          并需在CubeMX中使能CRC (HAL_CRC_MODULE_ENABLED)
+ */
+#if defined(HAL_CRC_MODULE_ENABLED) && defined(CRC_POL_POL)
+#define MODBUS_HW_CRC_SUPPORTED      1
+#else
+#define MODBUS_HW_CRC_SUPPORTED      0
+#endif
+
+#if MODBUS_PROFILE_CRC == MODBUS_PROFILE_CRC_HARDWARE && !MODBUS_HW_CRC_SUPPORTED
+#error "MODBUS_PROFILE_CRC_HARDWARE requires MODBUS_HW_CRC_SUPPORTED"
+#endif
+#if MODBUS_PROFILE_CRC < MODBUS_PROFILE_RUNTIME || MODBUS_PROFILE_CRC > MODBUS_PROFILE_CRC_HARDWARE
+#error "MODBUS_PROFILE_CRC must be MODBUS_PROFILE_RUNTIME or MODBUS_PROFILE_CRC_xxx"
+#endif
+#if MODBUS_PROFILE_TX < MODBUS_PROFILE_RUNTIME || MODBUS_PROFILE_TX > MODBUS_PROFILE_TX_ASYNC
+#error "MODBUS_PROFILE_TX must be MODBUS_PROFILE_RUNTIME or MODBUS_PROFILE_TX_xxx"
+#endif
+
+/**
+ * @brief   接收模式
+ */
+typedef enum {
+    MODBUS_RX_IT_PINGPONG = 0,    /**< 空闲中断接收 + 乒乓缓冲 (默认, 每字节一次中断) */
+    MODBUS_RX_DMA_RING            /**< 循环DMA环形缓冲 (无需重新启动接收, 仅在HT/TC/空闲时中断) */
+} Modbus_RxMode_t;
+
+/**
+ * @brief   接收超时(RTOR)支持检测
+ * @note    USART v2 (F0/F3/F7/G0/G4/L4/H7等) 提供硬件接收超时计数器，
+ *          F1/F2/F4的USART无此功能，可改用 MODBUS_FRAMING_TIMER
+ */
+#if defined(USART_CR2_RTOEN)
+#define MODBUS_RTO_SUPPORTED         1
+#else
+#define MODBUS_RTO_SUPPORTED         0
+#endif
+
+/**
+ * @brief   硬件DE支持检测
+ * @note    USART v2 (F0/F3/F7/G0/G4/L4/H7等) 可由硬件在发送期间自动驱动DE引脚，
+ *          引脚需在CubeMX中配置为USARTx_DE复用功能
+ */
+#if defined(USART_CR3_DEM)
+#define MODBUS_HW_DE_SUPPORTED       1
+#else
+#define MODBUS_HW_DE_SUPPORTED       0
+#endif
+
+/**
+ * @brief   静默模式(Mute mode)支持检测
+ * @note    USART v2 (F0/F3/F7/G0/G4/L4/H7等) 可经MMRQ请求进入静默，接收器在下一次
+ *          空闲线前忽略所有字节(不置位RXNE/IDLE)，用于跳过发往其他从站的帧
+ */
+#if defined(USART_CR1_MME) && defined(USART_RQR_MMRQ)
+#define MODBUS_MUTE_SUPPORTED        1
+#else
+#define MODBUS_MUTE_SUPPORTED        0
+#endif
+
+/**
+ * @brief   USART自STOP模式唤醒支持检测
+ * @note    USART v2/LPUART (F0/F3/F7/G0/G4/L0/L4/WB等) 在STOP模式下可由HSI/LSE内核时钟继续接收，
+ *          收到起始位(无WUS字段的芯片为RXNE)时唤醒MCU
+ */
+#if defined(USART_CR1_UESM)
+#define MODBUS_STOP_WAKE_SUPPORTED   1
+#else
+#define MODBUS_STOP_WAKE_SUPPORTED   0
+#endif
+
+/**
+ * @brief   DWT周期计数器支持检测 (Cortex-M3/M4/M7/M33, M0/M0+无此部件)
+ * @note    支持时统计模块按周期计数测量各阶段耗时，否则仅保留计数器
+ */
+#if defined(DWT_CTRL_CYCCNTENA_Msk)
+#define MODBUS_CYCCNT_SUPPORTED      1
+#else
+#define MODBUS_CYCCNT_SUPPORTED      0
+#endif
+
+#define MODBUS_STATS_TIMING          (MODBUS_STATS_ENABLED && MODBUS_CYCCNT_SUPPORTED)
+
+/**
+ * @brief   帧定界方式
+ * @note    Modbus RTU规定帧间静默不少于3.5字符时间(t3.5)，帧内字符间隔不超过1.5字符时间(t1.5)
+ *          协议栈按 baud_rate 计算 (每字符11位)，波特率高于19200时固定为 t1.5=750us、t3.5=1750us
+ */
+typedef enum {
+    MODBUS_FRAMING_IDLE = 0,      /**< UART空闲线检测 (默认, 约1字符时间即断帧) */
+    MODBUS_FRAMING_RTO,           /**< USART接收超时硬件计时t3.5 (需 MODBUS_RTO_SUPPORTED) */
+    MODBUS_FRAMING_TIMER          /**< 空闲事件后由TIM单脉冲计时t1.5/t3.5 (适用于无RTOR的芯片) */
+} Modbus_FramingMode_t;
+
+/**
+ * @brief   注册表最大实例数 (0 = 不使用注册表)
+ * @note    Modbus_Init() 自动按USART外设登记实例，
+ *          HAL回调可经 Modbus_Dispatch*() 以O(1)查表分发，主循环调用 Modbus_ProcessAll() 即可
+ *          就绪位图为32位，实例数不得超过32
+ */
+#ifndef MODBUS_MAX_INSTANCES
+#define MODBUS_MAX_INSTANCES         8
+#endif
+
+#if MODBUS_MAX_INSTANCES > 32
+#error "MODBUS_MAX_INSTANCES must not exceed 32"
+#endif
+
+/**
+ * @brief   发送队列最大深度 (发送槽数量上限)
+ */
+#define MODBUS_TX_QUEUE_MAX          4
+
+/**
+ * @brief   发送状态
+ */
+typedef enum {
+    MODBUS_TX_IDLE = 0,           /**< 空闲, 可立即发送 */
+    MODBUS_TX_SENDING,            /**< 发送中 (DMA/阻塞传输进行中) */
+    MODBUS_TX_DRAINING,           /**< DMA已完成, 等待最后一个字节移出 (TC) */
+    MODBUS_TX_TURNAROUND          /**< 已切回接收, 队列中下一帧等待t3.5帧间隔 */
+} Modbus_TxState_t;
+
+/**
+ * @brief   CRC16计算后端
+ * @note    每个实例可独立选择，例如高波特率实例使用硬件CRC，低速实例使用移位法
+ */
+typedef enum {
+    MODBUS_CRC_DEFAULT = 0,       /**< 兼容模式: 由 use_crc_table 决定查表法或移位法 */
+    MODBUS_CRC_SHIFT,             /**< 移位法: 无需查找表，代码体积最小 */
+    MODBUS_CRC_TABLE,             /**< 256项查表法: 软件最快，需512B ROM */
+    MODBUS_CRC_NIBBLE,            /**< 16项半字节查表法: 仅需32B ROM，速度介于两者之间 */
+    MODBUS_CRC_HARDWARE,          /**< STM32硬件CRC外设 (需 MODBUS_HW_CRC_SUPPORTED) */
+    MODBUS_CRC_CUSTOM             /**< 用户自定义实现 (通过 crc_func 传入) */
+} Modbus_CrcMode_t;
+
+/**
+ * @brief   CRC16计算函数类型
+ * @param   hmodbus Modbus句柄指针
+ * @param   crc     CRC初值 (完整帧计算时为0xFFFF，也可传入上一段的计算结果以分段计算)
+ * @param   buffer  数据缓冲区指针
+ * @param   length  数据长度
+ * @return  16位CRC校验码
+ */
+typedef uint16_t (*Modbus_CrcFunc_t)(const ModbusHandle_t *hmodbus,
+                                     uint16_t crc,
+                                     const uint8_t *buffer,
+                                     uint16_t length);
 
 /* ============================================================================
  *                              回调函数类型定义
@@ -70,6 +381,7 @@ typedef struct ModbusHandle ModbusHandle_t;
  * 
  * @warning 回调执行期间会阻塞Modbus处理，请尽量缩短执行时间
  *          如需延时操作(如Flash写入后复位)，建议设置标志位在主循环中处理
+ *          或配置 event_queue.defer_config，校验后立即应答，回调改由 Modbus_EventDispatch() 调用
  */
 typedef bool (*Modbus_CustomConfigCallback_t)(ModbusHandle_t *hmodbus, 
                                                uint16_t param_addr, 
@@ -85,16 +397,325 @@ typedef bool (*Modbus_CustomConfigCallback_t)(ModbusHandle_t *hmodbus,
  * @retval  false 拒绝写入，将返回异常响应
  * 
  * @note    用于实现写入权限控制或数据验证
+ *          写入后的耗时处理应放在 event_queue.event_cb 中，不阻塞应答
  */
 typedef bool (*Modbus_WriteCallback_t)(ModbusHandle_t *hmodbus,
                                         uint8_t func_code,
                                         uint16_t start_addr,
                                         uint16_t quantity);
 
+/**
+ * @brief   帧就绪通知回调类型 (可选)
+ * @param   hmodbus     Modbus句柄指针
+ * 
+ * @note    在中断上下文中调用: 收到完整请求帧，或发送完成后仍有排队响应/挂起请求时
+ *          用于唤醒RTOS任务立即调用 Modbus_Process()，回调内只允许使用中断安全的RTOS接口
+ */
+typedef void (*Modbus_ReadyCallback_t)(ModbusHandle_t *hmodbus);
+
+/**
+ * @brief   数据区加锁回调类型 (可选)
+ * @param   hmodbus     Modbus句柄指针
+ * @param   lock        true=加锁 (访问data_map前), false=解锁
+ * 
+ * @note    在 Modbus_Process() 上下文中调用，加锁区间覆盖功能码处理中对data_map的读写
+ *          及 write_cb/custom_config_cb 回调，响应帧组帧完成后、启动发送前解锁
+ */
+typedef void (*Modbus_LockCallback_t)(ModbusHandle_t *hmodbus, bool lock);
+
+/**
+ * @brief   段数据读取提供者回调类型 (可选)
+ * @param   hmodbus     Modbus句柄指针
+ * @param   seg         被读取的段
+ * @param   offset      段内起始序号 (寄存器序号或位序号)
+ * @param   count       数量
+ * @retval  true  已将 [offset, offset + count) 的最新值写入 seg->data
+ * @retval  false 读取失败，将返回从站设备故障异常
+ * 
+ * @note    仅在主机读取该段时、按请求的精确范围调用，应用层无需在后台持续刷新数据
+ */
+typedef bool (*Modbus_ReadProvider_t)(ModbusHandle_t *hmodbus, const Modbus_Segment_t *seg,
+                                      uint16_t offset, uint16_t count);
+
 /* ============================================================================
  *                              数据结构定义
  * ============================================================================ */
 
+/**
+ * @brief   数据区类型
+ */
+typedef enum {
+    MODBUS_AREA_COILS = 0,        /**< 线圈 */
+    MODBUS_AREA_DISCRETE,         /**< 离散输入 */
+    MODBUS_AREA_HOLDING,          /**< 保持寄存器 */
+    MODBUS_AREA_INPUT,            /**< 输入寄存器 */
+    MODBUS_AREA_COUNT
+} Modbus_Area_t;
+
+#define MODBUS_SEG_READONLY          0x01U   /**< 段只读: 写请求返回非法数据地址异常 */
+#define MODBUS_SEG_ISR_READ          0x02U   /**< 段允许由中断快速路径直接读取 (见 Modbus_FastPathConfig_t) */
+
+/**
+ * @brief   每批提交的最大变更范围数
+ * @note    同一数据区相邻或重叠的写入合并为一个范围; 范围数达到上限时提前提交
+ */
+#ifndef MODBUS_COMMIT_MAX_RANGES
+#define MODBUS_COMMIT_MAX_RANGES     8
+#endif
+
+/**
+ * @brief   写入变更范围
+ */
+typedef struct {
+    Modbus_Area_t area;           /**< 数据区 (MODBUS_AREA_COILS 或 MODBUS_AREA_HOLDING) */
+    uint16_t      start;          /**< 起始地址 */
+    uint16_t      quantity;       /**< 数量 */
+} Modbus_Change_t;
+
+/**
+ * @brief   写入提交回调函数类型 (可选)
+ * @param   hmodbus     Modbus句柄指针
+ * @param   changes     本批变更范围 (按写入先后排列)
+ * @param   count       范围数 (1~MODBUS_COMMIT_MAX_RANGES)
+ * 
+ * @note    在 Modbus_Process() 上下文中、写入已生效且响应已启动发送之后调用，
+ *          commit_window_ms 为0时每个写请求帧提交一次，否则合并窗口内的所有写入;
+ *          回调期间不持有 lock_cb 数据区锁
+ */
+typedef void (*Modbus_CommitCallback_t)(ModbusHandle_t *hmodbus, const Modbus_Change_t *changes, uint8_t count);
+
+/**
+ * @brief   耗时直方图桶数与首桶宽度 (us)
+ * @note    第0桶为 [0, 基准)，第i桶为 [基准*2^(i-1), 基准*2^i)，最后一桶收纳其余
+ */
+#ifndef MODBUS_HIST_BUCKETS
+#define MODBUS_HIST_BUCKETS          12
+#endif
+#ifndef MODBUS_HIST_BASE_US
+#define MODBUS_HIST_BASE_US          32U
+#endif
+
+/**
+ * @brief   耗时测量阶段
+ */
+typedef enum {
+    MODBUS_TIMING_RX_TO_PARSE = 0,  /**< 帧结束(空闲线/t3.5) 到开始解析 */
+    MODBUS_TIMING_PARSE,            /**< 开始解析到响应就绪 (含数据读写与CRC) */
+    MODBUS_TIMING_TX,               /**< 启动发送到发送完成 */
+    MODBUS_TIMING_COUNT
+} Modbus_Timing_t;
+
+/**
+ * @brief   单阶段耗时直方图
+ */
+typedef struct {
+    uint32_t bucket[MODBUS_HIST_BUCKETS]; /**< 各桶样本数 */
+    uint32_t max_us;              /**< 最大耗时 (us) */
+    uint8_t  max_func_code;       /**< 产生最大耗时的功能码 */
+} Modbus_Histogram_t;
+
+/**
+ * @brief   实例统计 (计数器定义对应0x08诊断子功能码)
+ * @note    计数器为32位，经0x08读取时取低16位; 他站帧仅计入 bus_msg，
+ *          CRC校验只对本站帧进行，因此 bus_comm_err 只统计本站帧
+ */
+typedef struct {
+    uint32_t bus_msg;             /**< 0x0B 总线上检测到的帧 (含他站帧与错误帧) */
+    uint32_t bus_comm_err;        /**< 0x0C CRC错误、字符间隔错误或过短的帧 */
+    uint32_t bus_exception;       /**< 0x0D 返回的异常响应 */
+    uint32_t slave_msg;           /**< 0x0E 校验通过的本站帧 */
+    uint32_t slave_no_resp;       /**< 0x0F 未应答的本站帧 */
+    uint32_t slave_busy;          /**< 0x11 返回从站忙异常的次数 */
+    uint32_t bus_overrun;         /**< 0x12 USART溢出、超长帧或未及处理即被覆盖的帧 */
+    uint32_t tx_frames;           /**< 已启动发送的响应帧 */
+    uint32_t tx_dropped;          /**< 超出发送槽而丢弃的响应 (同时计入 slave_no_resp) */
+    uint32_t bridge_fwd;          /**< 转发到下游实例的请求 */
+    uint32_t bridge_timeout;      /**< 下游无应答而返回 MB_EX_GATEWAY_TARGET 的请求 */
+    uint32_t cache_hits;          /**< 由响应缓存直接重发的响应 */
+#if MODBUS_STATS_TIMING
+    Modbus_Histogram_t timing[MODBUS_TIMING_COUNT]; /**< 各阶段耗时直方图 */
+#endif
+} Modbus_Stats_t;
+
+/**
+ * @brief   段读取缓存状态 (位于RAM，由协议栈维护)
+ * @note    记录最近一次由提供者刷新的范围及时刻，该范围内的请求在 max_age_ms 内直接读取 seg->data
+ */
+typedef struct {
+    uint32_t  tick;               /**< 最近一次刷新时刻 (ms) */
+    uint16_t  lo;                 /**< 有效范围起始序号 */
+    uint16_t  hi;                 /**< 有效范围结束序号 (不含, lo == hi 表示无效) */
+} Modbus_SegmentCache_t;
+
+/**
+ * @brief   顺序锁重试次数上限
+ * @note    Modbus_Process() 读取带顺序锁的数据时，快照被写入方打断的最大重试次数，
+ *          超过后返回从站设备忙异常(0x06)，由主站重发
+ */
+#ifndef MODBUS_SEQLOCK_RETRIES
+#define MODBUS_SEQLOCK_RETRIES       4
+#endif
+
+/**
+ * @brief   顺序锁 (seqlock, 位于RAM)
+ * @details 写入方在修改数据前后各递增一次序号 (写入期间为奇数)，
+ *          读取方复制数据前后序号相同且为偶数即得到一致快照，否则重新复制;
+ *          读取方不加锁、不关中断，写入方不会被读取方阻塞
+ * 
+ * @note    同一把顺序锁同时只能有一个写入方; 协议栈处理写请求时也作为写入方
+ */
+typedef struct {
+    volatile uint32_t seq;        /**< 写入序号 (奇数=写入中) */
+} Modbus_Seqlock_t;
+
+/**
+ * @brief   地址段描述
+ * @details 将Modbus地址 [base, base + count) 映射到一块连续数据
+ *          寄存器段: data 指向 uint16_t[count]
+ *          位段:     data 指向位压缩 uint8_t[(count + 7) / 8]，bit0 对应地址 base
+ *          配置 read_cb 时 data 作为提供者的输出缓冲，读请求前按需刷新
+ */
+struct Modbus_Segment {
+    uint16_t  base;               /**< 段起始地址 */
+    uint16_t  count;              /**< 段内元素数量 */
+    void     *data;               /**< 段数据指针 */
+    uint8_t   flags;              /**< 段属性 (MODBUS_SEG_xxx) */
+    uint16_t  max_age_ms;         /**< 缓存有效期 (ms, 0=每次读取都调用提供者) */
+    Modbus_ReadProvider_t  read_cb; /**< 读取提供者 (NULL表示data始终有效) */
+    Modbus_SegmentCache_t *cache;   /**< 缓存状态 (NULL表示不缓存) */
+    Modbus_Seqlock_t      *seqlock; /**< 顺序锁 (NULL表示不做一致性快照) */
+    uint32_t              *dirty;   /**< 脏位图 uint32_t[(count + 31) / 32], 主站写入的元素置位 (NULL表示不跟踪) */
+};
+
+/**
+ * @brief   中断快速路径默认数量上限 (寄存器数; 线圈/离散输入为其16倍)
+ */
+#ifndef MODBUS_FAST_PATH_MAX_REGS
+#define MODBUS_FAST_PATH_MAX_REGS    16
+#endif
+
+/**
+ * @brief   中断快速路径配置
+ * @details 启用后，接收中断对白名单内的简单读请求直接组帧并启动DMA发送，
+ *          应答延迟与主循环负载无关; 其余请求照常交由 Modbus_Process()
+ * 
+ * @note    需 use_dma_tx，且不能与硬件CRC同时使用
+ * @warning 快速路径在中断中读取数据，不经过 lock_cb; 白名单段中多寄存器组合量的一致性需由应用保证
+ */
+typedef struct {
+    bool      enabled;            /**< 启用中断快速路径 */
+    uint8_t   max_regs;           /**< 单次请求寄存器数上限 (0=MODBUS_FAST_PATH_MAX_REGS, 范围1~125; 初始化时截取到 125 与 (tx_buf_size-5)/2 中的较小值)，限定中断最坏耗时 */
+    uint8_t   flat_areas;         /**< 允许快速读取的连续数组区 (bit n 对应 Modbus_Area_t n); 段表用 MODBUS_SEG_ISR_READ */
+} Modbus_FastPathConfig_t;
+
+/**
+ * @brief   网关转发默认应答超时 (ms)
+ */
+#ifndef MODBUS_BRIDGE_TIMEOUT_MS
+#define MODBUS_BRIDGE_TIMEOUT_MS     200
+#endif
+
+/**
+ * @brief   网关路由: 地址范围 [addr_first, addr_last] 的请求转发到 target 实例所在总线
+ */
+typedef struct {
+    uint8_t         addr_first;   /**< 起始从站地址 (1~247) */
+    uint8_t         addr_last;    /**< 结束从站地址 (含, 1~247) */
+    ModbusHandle_t *target;       /**< 下游实例 (不可为本实例) */
+} Modbus_Route_t;
+
+/**
+ * @brief   网关转发配置
+ * @details 本实例收到路由地址的请求时，校验CRC后将整帧 (含原CRC) 复制到下游实例的发送槽原样发出，
+ *          下游实例在应答到达、校验CRC并核对地址与功能码后，把应答帧原样经本实例发回主站:
+ *          1. 每个下游实例同一时刻只有一个未完成请求; 下游仍在等待时新的转发请求在本实例保持待处理
+ *          2. 超过 timeout_ms 未收到应答时，本实例以目标地址返回 MB_EX_GATEWAY_TARGET 异常
+ *          3. 下游实例未初始化为串口实例或请求放不下其发送槽时返回 MB_EX_GATEWAY_PATH 异常
+ * 
+ * @note    本机地址与0xFF始终由本实例处理，不参与路由; 路由重叠时取表中靠前的一项
+ *          上下游实例须在同一上下文中处理 (同一主循环或同一 Modbus_ProcessReady() 任务);
+ *          RTOS端口多任务时由 ModbusRTOS_Start() 经 Modbus_RoutesGrouped() 校验
+ *          路由表由应用持有，运行期间不得修改
+ */
+typedef struct {
+    const Modbus_Route_t *routes; /**< 路由表 (route_count 为0时可为NULL) */
+    uint8_t   route_count;        /**< 路由数量 (0=不转发) */
+    uint16_t  timeout_ms;         /**< 下游应答超时 (ms, 0=MODBUS_BRIDGE_TIMEOUT_MS)，自请求转发起计时 */
+} Modbus_BridgeConfig_t;
+
+/**
+ * @brief   响应缓存可缓存的最大寄存器数 (决定每个缓存项的帧缓冲区大小)
+ */
+#ifndef MODBUS_RESP_CACHE_MAX_REGS
+#define MODBUS_RESP_CACHE_MAX_REGS   32
+#endif
+
+/** @brief 缓存项帧缓冲区大小: 地址 + 功能码 + 字节数 + 数据 + CRC */
+#define MODBUS_RESP_CACHE_FRAME_MAX  (3U + MODBUS_RESP_CACHE_MAX_REGS * 2U + 2U)
+
+/**
+ * @brief   响应缓存项 (位于RAM，由协议栈维护)
+ */
+typedef struct {
+    uint32_t  generation;         /**< 组帧时的数据版本 (与当前版本不同即失效) */
+    uint16_t  start;              /**< 请求起始地址 */
+    uint16_t  quantity;           /**< 请求寄存器数 */
+    uint16_t  len;                /**< 帧长度 (含CRC, 0=空) */
+    uint8_t   func_code;          /**< 0x03 或 0x04 */
+    uint8_t   frame[MODBUS_RESP_CACHE_FRAME_MAX]; /**< 已组帧的完整响应 */
+} Modbus_RespCacheEntry_t;
+
+/**
+ * @brief   响应缓存配置
+ * @details 0x03/0x04 的正常响应按 (功能码, 起始地址, 数量) 保存完整帧 (含CRC)，
+ *          相同请求再次到达且数据未变时直接重发，不读取数据区、不计算CRC:
+ *          1. 经协议栈写入 (0x05/0x06/0x0F/0x10/0x16/0x17)、Modbus_SeqlockWriteEnd()、
+ *             Modbus_SegmentInvalidate() 与 Modbus_DataChanged() 使所有实例的缓存失效
+ *          2. 配置 read_cb 的段、超过 MODBUS_RESP_CACHE_MAX_REGS 的请求不缓存
+ *          3. 缓存项已满时依次替换
+ * 
+ * @warning 应用直接修改 data_map 中的数据后须调用 Modbus_DataChanged()，否则主站读到修改前的值
+ */
+typedef struct {
+    Modbus_RespCacheEntry_t *entries; /**< 缓存项数组 (count 为0时可为NULL) */
+    uint8_t                  count;   /**< 缓存项数量 (0=不缓存) */
+} Modbus_RespCacheConfig_t;
+
+/**
+ * @brief   写入事件 (写请求生效或0x64确认后登记)
+ */
+typedef struct {
+    uint8_t   func_code;          /**< 功能码 (0x05/0x06/0x0F/0x10/0x16/0x17/0x64) */
+    uint16_t  addr;               /**< 起始地址 (0x17为写入起始地址, 0x64为参数地址) */
+    uint16_t  value;              /**< 数量 (0x64为参数值) */
+} Modbus_Event_t;
+
+/**
+ * @brief   写入事件处理回调函数类型 (可选)
+ * @param   hmodbus     Modbus句柄指针
+ * @param   event       取出的事件
+ * 
+ * @note    在调用 Modbus_EventDispatch() 的上下文中执行，响应早已发出;
+ *          回调期间不持有 lock_cb 数据区锁，读取 data_map 时应自行加锁
+ */
+typedef void (*Modbus_EventCallback_t)(ModbusHandle_t *hmodbus, const Modbus_Event_t *event);
+
+/**
+ * @brief   写入事件队列配置
+ * @details 耗时的写入后处理 (参数生效、保存Flash等) 移出应答路径:
+ *          1. 写请求经 write_cb 快速校验后写入数据区并立即应答，同时向队列登记一个事件
+ *          2. 应用在低优先级任务或主循环中以 Modbus_EventDispatch() / Modbus_EventFetch() 取出处理
+ *          3. 队列已满时写请求返回从站忙异常，数据区保持不变，主站稍后重试
+ *          队列为单生产者单消费者无锁环形缓冲区: 仅 Modbus_Process() 写入、仅一个应用上下文取出
+ */
+typedef struct {
+    Modbus_Event_t        *entries;        /**< 事件数组 (size 为0时可为NULL) */
+    uint16_t               size;           /**< 事件数组长度 (2的幂, 0=不使用) */
+    Modbus_EventCallback_t event_cb;       /**< Modbus_EventDispatch() 中处理写入事件 (可为NULL) */
+    bool                   defer_config;   /**< 0x64延后执行: 校验后立即应答，custom_config_cb 由 Modbus_EventDispatch() 调用 */
+    Modbus_CustomConfigCallback_t config_check_cb; /**< defer_config 时应答前的快速校验 (NULL=不校验) */
+} Modbus_EventQueueConfig_t;
+
 /**
  * @brief   数据映射配置结构体
  * @details 用于将外部数据源绑定到Modbus实例
@@ -107,6 +728,7 @@ typedef bool (*Modbus_WriteCallback_t)(ModbusHandle_t *hmodbus,
  *          2. 对于涉及多个寄存器的复合操作，应使用临界区保护
  *          3. 可通过 __disable_irq() / __enable_irq() 实现简单的临界区
  *          4. 或使用RTOS的互斥锁(Mutex)机制
+ *          5. 或配置顺序锁 (seqlock / Modbus_Segment_t.seqlock)，读请求取得一致快照而不阻塞写入方
  */
 typedef struct {
     /* 线圈区域 (Coils) - Modbus地址 0xxxx */
@@ -124,8 +746,118 @@ typedef struct {
     /* 输入寄存器区域 (Input Registers) - Modbus地址 3xxxx */
     uint16_t *input_regs;         /**< 输入寄存器数据指针 (NULL表示不支持) */
     uint16_t  input_reg_count;    /**< 输入寄存器数量 (0表示不支持此功能) */
+    
+    /* 分段地址映射 (可选): 段表按 base 升序排列且互不重叠，配置后取代对应的连续数组
+     * 内存占用只与实际开放的地址数有关，单次请求须完整落在一个段内 */
+    const Modbus_Segment_t *coil_segs;       /**< 线圈段表 (NULL表示使用 coils) */
+    uint8_t                 coil_seg_count;  /**< 线圈段数 */
+    const Modbus_Segment_t *discrete_segs;   /**< 离散输入段表 (NULL表示使用 discrete_inputs) */
+    uint8_t                 discrete_seg_count; /**< 离散输入段数 */
+    const Modbus_Segment_t *holding_segs;    /**< 保持寄存器段表 (NULL表示使用 holding_regs) */
+    uint8_t                 holding_seg_count; /**< 保持寄存器段数 */
+    const Modbus_Segment_t *input_segs;      /**< 输入寄存器段表 (NULL表示使用 input_regs) */
+    uint8_t                 input_seg_count; /**< 输入寄存器段数 */
+    
+    /* 一致性快照 (可选): 连续数组共用的顺序锁，段表中的段各自配置 */
+    Modbus_Seqlock_t       *seqlock;         /**< 顺序锁 (NULL表示不做一致性快照) */
+    
+    /* 变更跟踪 (可选): 连续数组的脏位图 uint32_t[(count + 31) / 32]，段表中的段各自配置 */
+    uint32_t               *coil_dirty;      /**< 线圈脏位图 (NULL表示不跟踪) */
+    uint32_t               *holding_dirty;   /**< 保持寄存器脏位图 (NULL表示不跟踪) */
 } Modbus_DataMap_t;
 
+/**
+ * @brief   接收帧描述符
+ * @details 描述位于接收缓冲区(乒乓缓冲或DMA环形缓冲)中的一帧，
+ *          解析时直接从原缓冲区读取字段，跨越环尾的帧无需拷贝
+ * 
+ * @note    帧内第 i 字节的位置:
+ *          i <  wrap: base[offset + i]
+ *          i >= wrap: base[i - wrap]   (已回绕到缓冲区开头)
+ */
+typedef struct {
+    const uint8_t *base;          /**< 缓冲区起始地址 */
+    uint16_t       size;          /**< 缓冲区大小 */
+    uint16_t       offset;        /**< 帧起始位置 */
+    uint16_t       length;        /**< 帧长度 (含地址与CRC) */
+    uint16_t       wrap;          /**< 回绕点: 帧内该字节起位于缓冲区开头 (= size - offset) */
+} Modbus_Frame_t;
+
+/**
+ * @brief   功能码处理函数的预解析请求
+ * @note    addr/value/byte_count 按标准请求格式从帧内第2~6字节取出，帧长不足时内容无意义，
+ *          处理函数应先按需检查 length; 其余字段通过 Modbus_FrameByte()/Modbus_FrameU16() 读取
+ */
+typedef struct {
+    Modbus_Frame_t frame;         /**< 请求帧 (位于接收缓冲区，可能跨越环尾) */
+    uint16_t       length;        /**< 请求帧长度 (含地址与CRC) */
+    uint8_t        func_code;     /**< 功能码 */
+    uint8_t        byte_count;    /**< 第6字节: 写多个请求的数据字节数 */
+    uint16_t       addr;          /**< 第2~3字节: 起始地址 / 参数地址 */
+    uint16_t       value;         /**< 第4~5字节: 数量 / 写入值 */
+    uint16_t       tx_size;       /**< 响应可用长度 (不含CRC) */
+} Modbus_Request_t;
+
+/** @brief 处理函数返回值: 不发送响应 */
+#define MODBUS_REPLY_NONE            0U
+
+/** @brief 处理函数返回值: 发送异常响应 (ex为异常码) */
+#define MODBUS_REPLY_EXCEPTION(ex)   (0x8000U | (uint16_t)(ex))
+
+/**
+ * @brief   功能码处理函数类型
+ * @param   hmodbus     Modbus句柄指针
+ * @param   req         预解析的请求
+ * @param   tx          响应缓冲区 (tx[0]从站地址、tx[1]功能码已填好，可写入 req->tx_size 字节)
+ * @return  响应长度 (含地址与功能码、不含CRC，由协议栈追加CRC并发送)，
+ *          或 MODBUS_REPLY_EXCEPTION(异常码) / MODBUS_REPLY_NONE
+ * 
+ * @note    在 Modbus_Process() 上下文中、持有 lock_cb 数据区锁期间调用
+ */
+typedef uint16_t (*Modbus_FuncHandler_t)(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx);
+
+/**
+ * @brief   传输层接口 (可选, 替代HAL UART驱动)
+ * @note    Modbus_Config_t.transport 为NULL时使用HAL UART (默认); 否则协议栈不再调用任何HAL UART函数，
+ *          由驱动在帧结束(空闲线)或缓冲区收满时调用 Modbus_RxCallback()，在最后一个字节完全移出后
+ *          调用 Modbus_TxCallback()，每收到一个字节可调用 Modbus_UART_IRQHandler() 以增量计算CRC
+ *          仅支持中断乒乓接收与空闲线定界，不支持 mute_foreign 与 rs485.hw_de (可由驱动自行配置)
+ *          参考实现见 modbus_port_ll.h (STM32 LL驱动直接读写USART寄存器)
+ *
+ * @warning 各函数在中断与主循环中均可能被调用，驱动需保证调用期间不阻塞
+ */
+typedef struct {
+    /**
+     * @brief   启动接收: 此后收到的字节依次写入 buf，最多 size 字节
+     * @retval  true  已启动
+     * @retval  false 驱动不可用
+     */
+    bool     (*start_rx)(const ModbusHandle_t *hmodbus, uint8_t *buf, uint16_t size);
+    
+    /**
+     * @brief   本次启动接收后已收到的字节数 (可为NULL, 此时不能启用 incremental_crc)
+     */
+    uint16_t (*rx_count)(const ModbusHandle_t *hmodbus);
+    
+    /**
+     * @brief   启动发送并立即返回，data 在 Modbus_TxCallback() 之前保持有效
+     * @retval  true  已启动
+     * @retval  false 发送器忙，协议栈丢弃该响应
+     */
+    bool     (*send)(const ModbusHandle_t *hmodbus, const uint8_t *data, uint16_t len);
+    
+    /**
+     * @brief   切换RS485收发方向 (仅 rs485.enabled 时调用; 可为NULL, 此时按 rs485 配置由HAL GPIO驱动DE引脚)
+     * @param   tx  true=发送, false=接收
+     */
+    void     (*set_direction)(const ModbusHandle_t *hmodbus, bool tx);
+    
+    /**
+     * @brief   微秒时基, 允许32位回绕 (可为NULL, 此时发送队列帧间隔按ms节拍计时)
+     */
+    uint32_t (*now_us)(const ModbusHandle_t *hmodbus);
+} Modbus_Transport_t;
+
 /**
  * @brief   RS485硬件配置结构体
  */
@@ -134,20 +866,64 @@ typedef struct {
     GPIO_TypeDef *de_port;        /**< DE/RE控制引脚GPIO端口 (如GPIOA) */
     uint16_t      de_pin;         /**< DE/RE控制引脚编号 (如GPIO_PIN_8) */
     bool          de_polarity;    /**< DE极性: true=高电平发送, false=低电平发送 */
+    bool          hw_de;          /**< 使用USART硬件DE控制 (需 MODBUS_HW_DE_SUPPORTED, 此时无需de_port/de_pin) */
+    uint8_t       de_assert_time; /**< 硬件DE: 起始位之前DE提前有效时间 (0~31, 单位为1/16位时间, OVER8时为1/8) */
+    uint8_t       de_deassert_time;/**< 硬件DE: 最后停止位之后DE保持时间 (0~31, 单位同上) */
 } Modbus_RS485Config_t;
 
 /**
  * @brief   缓冲区配置结构体
  * @note    采用乒乓缓冲(双缓冲)机制，解决接收与处理的竞态问题
+ *          MODBUS_RX_DMA_RING 模式下:
+ *          - rx_buf_a 作为循环DMA环形缓冲区 (大小 rx_buf_size, 建议不小于2帧)
+ *          - rx_buf_b 不再需要 (可为NULL)，帧直接在环形缓冲中原地解析
+ *          DMA发送时 tx_buf 可划分为多个发送槽，组成响应队列:
+ *          上一帧仍在发送时，新请求的响应写入下一个空闲槽排队，不会覆盖正在发送的数据
  */
 typedef struct {
-    uint8_t  *rx_buf_a;           /**< 接收缓冲区A (乒乓缓冲) */
-    uint8_t  *rx_buf_b;           /**< 接收缓冲区B (乒乓缓冲) */
-    uint8_t  *tx_buf;             /**< 发送缓冲区 */
-    uint16_t  rx_buf_size;        /**< 接收缓冲区大小 (建议256字节) */
-    uint16_t  tx_buf_size;        /**< 发送缓冲区大小 (建议256字节) */
+    uint8_t  *rx_buf_a;           /**< 接收缓冲区A (乒乓缓冲 / DMA环形缓冲) */
+    uint8_t  *rx_buf_b;           /**< 接收缓冲区B (乒乓缓冲, 环形模式下可为NULL) */
+    uint8_t  *tx_buf;             /**< 发送缓冲区 (tx_slots > 1 时需容纳 tx_slots * tx_buf_size 字节) */
+    uint16_t  rx_buf_size;        /**< 接收缓冲区大小 (建议256字节, 环形模式建议512字节) */
+    uint16_t  tx_buf_size;        /**< 单个发送槽大小 (建议256字节) */
+    uint8_t   tx_slots;           /**< 发送槽数量 (0/1=单缓冲, 最大MODBUS_TX_QUEUE_MAX, 仅DMA发送时生效) */
 } Modbus_BufferConfig_t;
 
+/**
+ * @brief   硬件CRC配置结构体
+ * @note    仅在 crc_mode = MODBUS_CRC_HARDWARE 时使用
+ *          协议栈每次计算前会重新配置多项式/初值/反转模式，
+ *          因此CRC外设可与应用层其他CRC计算分时复用
+ *
+ * @warning 硬件CRC外设为共享资源，不得在不同中断优先级中并发使用
+ */
+typedef struct {
+#if MODBUS_HW_CRC_SUPPORTED
+    CRC_HandleTypeDef *hcrc;      /**< HAL CRC句柄指针 (CubeMX生成) */
+    DMA_HandleTypeDef *hdma;      /**< 内存到CRC的DMA句柄 (可为NULL, 需配置为MemToMem/字节宽度/目标地址不递增) */
+    uint16_t           dma_threshold; /**< 数据长度达到此值时使用DMA送数 (0=使用默认值) */
+#else
+    uint8_t            reserved;  /**< 当前芯片不支持硬件CRC16 */
+#endif
+} Modbus_HwCrcConfig_t;
+
+/**
+ * @brief   帧定界配置结构体
+ * @note    MODBUS_FRAMING_RTO: 需在 HAL_UART_IRQHandler() 之前调用 Modbus_UART_IRQHandler()
+ *          MODBUS_FRAMING_TIMER: 定时器需配置为1MHz计数(1us/tick)并使能其更新中断(NVIC),
+ *          协议栈自行设置单脉冲模式并在每次计时前装载周期，
+ *          需在 HAL_TIM_PeriodElapsedCallback() 中调用 Modbus_TimerCallback()
+ *
+ * @warning 定时器中断与UART中断应配置为相同优先级
+ */
+typedef struct {
+    Modbus_FramingMode_t mode;    /**< 帧定界方式 (默认MODBUS_FRAMING_IDLE) */
+    bool               strict_t15;/**< 丢弃字符间隔超过t1.5的帧 (仅 MODBUS_FRAMING_TIMER 时生效) */
+#if defined(HAL_TIM_MODULE_ENABLED)
+    TIM_HandleTypeDef *htim;      /**< 帧定时器句柄 (仅 MODBUS_FRAMING_TIMER 时使用, 专用于本实例) */
+#endif
+} Modbus_FramingConfig_t;
+
 /**
  * @brief   Modbus从站初始化配置结构体
  * @details 所有配置项均在运行时通过此结构体传入
@@ -155,7 +931,9 @@ typedef struct {
  */
 typedef struct {
     /* UART配置 */
-    UART_HandleTypeDef *huart;    /**< HAL UART句柄指针 */
+    UART_HandleTypeDef *huart;    /**< HAL UART句柄指针 (配置 transport 时可为NULL) */
+    const Modbus_Transport_t *transport; /**< 传输层接口 (NULL=HAL UART, 默认) */
+    void               *transport_ctx;/**< 传输层驱动上下文 (经 Modbus_GetTransportCtx() 取得) */
     uint8_t             slave_addr;/**< 从站地址 (有效范围: 1~247) */
     uint32_t            baud_rate; /**< 波特率 (用于动态超时计算) */
     
@@ -163,18 +941,37 @@ typedef struct {
     Modbus_BufferConfig_t buffer; /**< 缓冲区配置 */
     
     /* 数据映射 */
-    Modbus_DataMap_t    data_map; /**< 数据区映射配置 */
+    Modbus_DataMap_t    data_map; /**< 数据区映射配置 (MODBUS_PROFILE_LAYOUT 时忽略) */
+    Modbus_FastPathConfig_t fast_path; /**< 中断快速路径配置 (可选) */
+    Modbus_BridgeConfig_t   bridge;    /**< 网关转发配置 (可选) */
+    Modbus_RespCacheConfig_t resp_cache; /**< 读响应缓存配置 (可选) */
+    Modbus_EventQueueConfig_t event_queue; /**< 写入事件队列配置 (可选) */
     
     /* 硬件接口配置 */
     Modbus_RS485Config_t rs485;   /**< RS485配置 (不使用时enabled=false) */
     
     /* 运行时选项 */
-    bool                use_dma_tx;    /**< 使用DMA发送 (需CubeMX配置DMA) */
-    bool                use_crc_table; /**< 使用CRC查表法 (速度快, 需512B ROM) */
+    Modbus_RxMode_t     rx_mode;       /**< 接收模式 (环形模式需CubeMX将USART RX DMA配置为Circular) */
+    Modbus_FramingConfig_t framing;    /**< 帧定界配置 (默认空闲线检测) */
+    bool                mute_foreign;  /**< 地址不符时USART静默至帧尾 (需 MODBUS_MUTE_SUPPORTED, 仅中断乒乓接收+空闲线定界) */
+    bool                stop_wake;     /**< Modbus_EnterStop() 使USART可在STOP模式下唤醒MCU (需 MODBUS_STOP_WAKE_SUPPORTED, 不支持 transport) */
+    bool                use_dma_tx;    /**< 使用DMA发送 (需CubeMX配置DMA; 配置 transport 时恒为异步发送; 由 MODBUS_PROFILE_TX 固定时忽略) */
+    bool                pipelined_tx;  /**< 流水线发送: 读寄存器响应先发出帧头，数据填充与CRC计算同时进行 (需use_dma_tx) */
+    bool                use_crc_table; /**< 使用CRC查表法 (速度快, 需512B ROM, 仅 crc_mode = MODBUS_CRC_DEFAULT 时生效) */
+    
+    /* CRC后端配置 */
+    bool                 incremental_crc; /**< 接收过程中增量计算CRC (帧结束时即得校验结果, 不支持硬件CRC) */
+    Modbus_CrcMode_t     crc_mode;     /**< CRC计算后端 (默认MODBUS_CRC_DEFAULT, 兼容 use_crc_table; 由 MODBUS_PROFILE_CRC 固定时忽略) */
+    Modbus_HwCrcConfig_t hw_crc;       /**< 硬件CRC配置 (仅 MODBUS_CRC_HARDWARE 时使用) */
+    Modbus_CrcFunc_t     crc_func;     /**< 自定义CRC函数 (仅 MODBUS_CRC_CUSTOM 时使用) */
     
     /* 回调函数 */
     Modbus_CustomConfigCallback_t custom_config_cb; /**< 0x64功能码回调 (可为NULL) */
     Modbus_WriteCallback_t        write_cb;         /**< 写入前回调 (可为NULL) */
+    Modbus_ReadyCallback_t        ready_cb;         /**< 帧就绪通知回调, 中断上下文 (可为NULL) */
+    Modbus_LockCallback_t         lock_cb;          /**< 数据区加锁回调 (可为NULL) */
+    Modbus_CommitCallback_t       commit_cb;        /**< 写入提交回调 (可为NULL) */
+    uint16_t                      commit_window_ms; /**< 提交合并窗口 (ms, 0=每个写请求帧提交一次) */
 } Modbus_Config_t;
 
 /**
@@ -188,6 +985,8 @@ typedef struct {
 struct ModbusHandle {
     /* ==================== UART接口 ==================== */
     UART_HandleTypeDef *huart;            /**< HAL UART句柄指针 */
+    const Modbus_Transport_t *transport;  /**< 传输层接口 (NULL=HAL UART) */
+    void               *transport_ctx;    /**< 传输层驱动上下文 */
     
     /* ==================== 从站配置 ==================== */
     uint8_t             slave_addr;       /**< 当前从站地址 */
@@ -196,7 +995,7 @@ struct ModbusHandle {
     /* ==================== 乒乓缓冲区 ==================== */
     uint8_t            *rx_buf_a;         /**< 接收缓冲区A */
     uint8_t            *rx_buf_b;         /**< 接收缓冲区B */
-    uint8_t            *tx_buf;           /**< 发送缓冲区 */
+    uint8_t            *tx_buf;           /**< 当前构建响应的发送槽 */
     uint16_t            rx_buf_size;      /**< 接收缓冲区大小 */
     uint16_t            tx_buf_size;      /**< 发送缓冲区大小 */
     
@@ -205,19 +1004,105 @@ struct ModbusHandle {
     volatile uint16_t   rx_len;           /**< 待处理数据长度 */
     volatile uint8_t    rx_ready;         /**< 接收完成标志 (1=有数据待处理) */
     
+    /* ==================== DMA环形接收 ==================== */
+    Modbus_RxMode_t     rx_mode;          /**< 接收模式 */
+    volatile uint16_t   rx_ring_tail;     /**< 当前接收帧在环形缓冲中的起始位置 */
+    volatile uint16_t   rx_frame_offset;  /**< 待处理帧在环形缓冲中的起始位置 */
+    
+    /* ==================== 帧定界 ==================== */
+    Modbus_FramingConfig_t framing;       /**< 帧定界配置 */
+    uint32_t            t15_us;           /**< 字符间隔超时t1.5 (us) */
+    uint32_t            t35_us;           /**< 帧间静默时间t3.5 (us) */
+    uint32_t            tidle_us;         /**< 空闲线检测延迟 (10位时间, us) */
+    volatile uint16_t   rx_arm_offset;    /**< 乒乓模式: 当前缓冲区中已接收的字节数 (候选帧尾后续接) */
+    volatile uint16_t   rx_timer_mark;    /**< 启动帧定时器时的接收位置 */
+    volatile uint8_t    rx_timer_stage;   /**< 帧定时阶段 (0=停止, 1=等待t1.5, 2=等待t3.5) */
+    volatile uint8_t    rx_gap_error;     /**< 当前帧出现超过t1.5的字符间隔 */
+    bool                mute_foreign;     /**< 他站帧硬件静默使能标志 */
+    bool                stop_wake;        /**< STOP模式唤醒使能标志 */
+    
+    /* ==================== 增量CRC ==================== */
+    bool                incremental_crc;  /**< 增量CRC使能标志 */
+    volatile uint16_t   rx_crc;           /**< 当前接收帧的滚动CRC状态 */
+    volatile uint16_t   rx_crc_pos;       /**< 已计入滚动CRC的字节数 */
+    volatile uint16_t   rx_crc_count;     /**< 环形模式: 当前帧已计入滚动CRC的字节数 (大于帧长时帧首已被覆盖) */
+    volatile uint8_t    rx_crc_result;    /**< 待处理帧的判定 (0=未知, 1=正确, 2=CRC错误, 3=字符间隔错误) */
+    
     /* ==================== 数据映射 ==================== */
     Modbus_DataMap_t    data_map;         /**< 数据区指针映射 */
+    const Modbus_Segment_t *area_segs[MODBUS_AREA_COUNT]; /**< 各数据区生效的段表 */
+    uint8_t             area_seg_count[MODBUS_AREA_COUNT]; /**< 各数据区段数 (0表示不支持) */
+    Modbus_Segment_t    area_flat[MODBUS_AREA_COUNT]; /**< 连续数组配置转换成的单段 */
+    Modbus_FastPathConfig_t fast_path;    /**< 中断快速路径配置 */
+    Modbus_RespCacheConfig_t resp_cache;  /**< 读响应缓存 */
+    uint8_t             resp_cache_next;  /**< 下一个替换的缓存项 */
+    volatile uint8_t    process_busy;     /**< Modbus_Process() 正在执行 (屏蔽快速路径) */
     
     /* ==================== 硬件配置 ==================== */
     Modbus_RS485Config_t rs485;           /**< RS485配置 */
     
     /* ==================== 运行时选项 ==================== */
     bool                use_dma_tx;       /**< DMA发送标志 */
-    bool                use_crc_table;    /**< CRC查表法标志 */
+    bool                pipelined_tx;     /**< 流水线发送标志 */
+    volatile uint8_t    tx_pipe_state;    /**< 流水线发送阶段 (0=空闲, 1=帧头发送中, 2=帧头已发完) */
+    volatile uint16_t   tx_pipe_len;      /**< 已就绪待接续发送的完整帧长度 (0=数据部分未就绪) */
+    
+    /* ==================== 发送队列 ==================== */
+    uint8_t            *tx_pool;          /**< 发送槽池 (tx_slots个, 每个tx_buf_size字节) */
+    uint8_t             tx_slots;         /**< 发送槽数量 */
+    volatile uint8_t    tx_head;          /**< 队首(正在发送)的槽序号 */
+    volatile uint8_t    tx_count;         /**< 已排队(含正在发送)的响应数 */
+    uint16_t            tx_slot_len[MODBUS_TX_QUEUE_MAX]; /**< 各槽响应帧长度 (含CRC) */
+    volatile Modbus_TxState_t tx_state;   /**< 发送状态 */
+    volatile uint32_t   tx_done_tick;     /**< 上一帧发送完成时刻 (ms, 传输层提供 now_us 时为us; 用于t3.5帧间隔) */
+    
+    /* ==================== 网关转发 ==================== */
+    const Modbus_Route_t *bridge_routes;  /**< 路由表 */
+    uint8_t             bridge_route_count;/**< 路由数量 */
+    uint16_t            bridge_timeout_ms;/**< 下游应答超时 (ms) */
+    uint32_t            bridge_map[8];    /**< 需转发的地址位图 (接收中断中判定地址) */
+    ModbusHandle_t * volatile bridge_origin; /**< 作为下游: 等待应答的请求来源实例 (NULL=空闲) */
+    volatile uint8_t    bridge_addr;      /**< 作为下游: 等待应答的从站地址 */
+    uint8_t             bridge_func;      /**< 作为下游: 等待应答的功能码 */
+    uint16_t            bridge_wait_ms;   /**< 作为下游: 本次等待的超时 (ms) */
+    uint32_t            bridge_tick;      /**< 作为下游: 请求转发时刻 (ms) */
+    
+    /* ==================== CRC后端 ==================== */
+    Modbus_CrcMode_t    crc_mode;         /**< 实际生效的CRC后端 */
+    Modbus_CrcFunc_t    crc_func;         /**< CRC计算函数 (初始化时根据crc_mode绑定) */
+    Modbus_HwCrcConfig_t hw_crc;          /**< 硬件CRC配置 */
     
     /* ==================== 回调函数 ==================== */
     Modbus_CustomConfigCallback_t custom_config_cb; /**< 0x64回调 */
     Modbus_WriteCallback_t        write_cb;         /**< 写入回调 */
+    Modbus_ReadyCallback_t        ready_cb;         /**< 帧就绪通知回调 */
+    Modbus_LockCallback_t         lock_cb;          /**< 数据区加锁回调 */
+    bool                data_locked;      /**< 数据区当前已加锁 */
+    Modbus_CommitCallback_t       commit_cb;        /**< 写入提交回调 */
+    uint16_t            commit_window_ms; /**< 提交合并窗口 (ms) */
+    uint8_t             commit_count;     /**< 待提交的变更范围数 */
+    uint32_t            commit_tick;      /**< 本批首个变更的时刻 (ms) */
+    Modbus_Change_t     commit_ranges[MODBUS_COMMIT_MAX_RANGES]; /**< 待提交的变更范围 */
+    Modbus_EventQueueConfig_t event_queue; /**< 写入事件队列 */
+    volatile uint16_t   event_head;       /**< 事件写入序号 (仅 Modbus_Process() 修改) */
+    volatile uint16_t   event_tail;       /**< 事件读取序号 (仅取出方修改) */
+    bool                event_staged;     /**< 队尾已填入事件，待写入生效后发布 */
+    
+    /* ==================== 统计与诊断 ==================== */
+#if MODBUS_STATS_ENABLED
+    Modbus_Stats_t      stats;            /**< 实例统计 */
+#endif
+#if MODBUS_STATS_TIMING
+    uint32_t            cycles_per_us;    /**< 每微秒周期数 (由 SystemCoreClock 得出) */
+    volatile uint32_t   rx_stamp;         /**< 最近一帧发布时的周期计数 */
+    uint32_t            parse_stamp;      /**< 当前帧开始解析时的周期计数 */
+    bool                parse_timing;     /**< 当前帧解析计时进行中 */
+    uint8_t             parse_func_code;  /**< 当前解析帧的功能码 */
+    volatile uint32_t   tx_stamp;         /**< 队首响应启动发送时的周期计数 */
+#endif
+    
+    /* ==================== 多实例注册表 ==================== */
+    uint8_t             registry_slot;    /**< 注册表槽序号 (MODBUS_MAX_INSTANCES 以上表示未登记) */
     
     /* ==================== 用户数据 ==================== */
     void               *user_data;        /**< 用户自定义数据指针 (可选) */
@@ -236,6 +1121,9 @@ struct ModbusHandle {
  * 
  * @note    调用此函数后，Modbus从站开始监听UART数据
  *          必须确保UART已在CubeMX中正确配置并初始化
+ *          启用注册表时实例按 huart->Instance 登记 (同一UART重复初始化时替换原实例;
+ *          配置 transport 时按 transport_ctx 登记)，注册表已满时返回false
+ *          配置 bridge 时本实例作为网关上游，路由表中的下游实例可在本实例之后初始化
  * 
  * @code
  *          // 使用示例
@@ -248,6 +1136,20 @@ struct ModbusHandle {
  */
 bool Modbus_Init(ModbusHandle_t *hmodbus, const Modbus_Config_t *config);
 
+/**
+ * @brief   初始化无串口的协议引擎实例 (供 Modbus TCP 等前端使用)
+ * @param   hmodbus 待初始化的Modbus句柄指针
+ * @param   config  初始化配置结构体指针
+ * @retval  true    初始化成功
+ * @retval  false   初始化失败 (从站地址无效、CRC后端或段表无效)
+ * 
+ * @note    只使用 config 中的 slave_addr、crc_mode/crc_func/hw_crc、data_map 与回调函数，
+ *          串口、缓冲区、接收模式、快速路径与RS485配置均被忽略; 实例不登记到注册表
+ *          应答须同步返回，不支持 bridge (route_count 非0时返回false)
+ *          请求经 Modbus_Execute() 处理，data_map 可与串口实例指向同一份数据 (以 lock_cb 互斥)
+ */
+bool Modbus_InitEngine(ModbusHandle_t *hmodbus, const Modbus_Config_t *config);
+
 /**
  * @brief   Modbus主处理函数
  * @param   hmodbus Modbus句柄指针
@@ -255,18 +1157,42 @@ bool Modbus_Init(ModbusHandle_t *hmodbus, const Modbus_Config_t *config);
  * @note    应在主循环中周期性调用
  *          此函数解析接收到的Modbus帧并生成响应
  *          采用乒乓缓冲机制，处理期间不会阻塞新数据接收
+ *          DMA发送时响应入队后立即返回; 发送槽全部占用时请求保持待处理，留待下次调用
  * 
  * @warning 此函数非线程安全，在RTOS环境中需确保单一任务调用
- *          或使用互斥锁保护
+ *          或使用互斥锁保护; 其他任务访问data_map时可配置 lock_cb 加锁 (见 modbus_rtos.h)
  */
 void Modbus_Process(ModbusHandle_t *hmodbus);
 
+/**
+ * @brief   同步处理一帧请求并在调用者缓冲区中生成响应
+ * @param   hmodbus  Modbus句柄指针 (Modbus_InitEngine() 或 Modbus_Init() 初始化)
+ * @param   req      请求: 从站地址 + PDU，with_crc 为true时末尾带2字节CRC
+ * @param   len      请求长度
+ * @param   tx       响应缓冲区
+ * @param   tx_size  响应缓冲区大小
+ * @param   with_crc 请求需校验CRC，响应追加CRC (RTU帧); false时均不含CRC，从站地址0 (MBAP单元号0) 也按本机处理
+ * @return  响应长度 (从站地址 + PDU [+ CRC])，0表示不响应 (地址不匹配、帧错误或处理函数不应答)
+ * 
+ * @note    使用与串口实例相同的分发表与数据区访问 (lock_cb 加锁、段表、变更跟踪)，
+ *          不经过发送队列与RS485控制; 响应首字节为本机地址，由调用者按需替换
+ *          写入变更的 commit_cb 在下一次 Modbus_Process() 中提交
+ * 
+ * @warning 同一句柄不可在多个任务中并发调用，也不可与该句柄的 Modbus_Process() 并发
+ */
+uint16_t Modbus_Execute(ModbusHandle_t *hmodbus, const uint8_t *req, uint16_t len,
+                        uint8_t *tx, uint16_t tx_size, bool with_crc);
+
 /**
  * @brief   UART接收完成/空闲中断回调
  * @param   hmodbus Modbus句柄指针
  * @param   size    接收到的数据长度
  * 
  * @note    需在 HAL_UARTEx_RxEventCallback() 中调用此函数
+ *          MODBUS_RX_DMA_RING 模式下 size 为DMA在环形缓冲中的写入位置，
+ *          协议栈在空闲事件时划分帧边界，HT/TC事件仅用于增量CRC
+ *          首字节既非本站地址也非广播地址(0xFF)的帧在此直接丢弃: 乒乓模式在同一缓冲区
+ *          重新启动接收，环形模式仅推进帧起点，均不置位rx_ready、不调用ready_cb
  * 
  * @code
  *          void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) {
@@ -280,13 +1206,55 @@ void Modbus_Process(ModbusHandle_t *hmodbus);
  */
 void Modbus_RxCallback(ModbusHandle_t *hmodbus, uint16_t size);
 
+/**
+ * @brief   UART中断钩子 (可选)
+ * @param   hmodbus Modbus句柄指针
+ * 
+ * @note    在 USARTx_IRQHandler() 中 HAL_UART_IRQHandler() 之前调用
+ *          启用 incremental_crc 时，每收到一个字节即将其计入滚动CRC，
+ *          使CRC计算分散到整个帧接收期间，空闲中断到来时校验结果已确定
+ *          不调用此函数时，剩余字节在空闲中断中一次性计入
+ *          MODBUS_FRAMING_RTO 模式下必须调用: 由此处理接收超时(t3.5)帧结束，
+ *          并在HAL将RTOF作为接收错误中止接收之前将其清除
+ *          启用 mute_foreign 时必须调用: 收到首字节即判定地址，他站帧令USART静默至帧尾，
+ *          其余字节不再产生接收中断
+ *          配置 transport 时由驱动在写入每个字节后调用 (仅用于增量CRC)
+ * 
+ * @code
+ *          void USART1_IRQHandler(void) {
+ *              Modbus_UART_IRQHandler(&hModbus1);
+ *              HAL_UART_IRQHandler(&huart1);
+ *          }
+ * @endcode
+ */
+void Modbus_UART_IRQHandler(ModbusHandle_t *hmodbus);
+
+/**
+ * @brief   帧定时器到期回调 (MODBUS_FRAMING_TIMER 模式专用)
+ * @param   hmodbus Modbus句柄指针
+ * 
+ * @note    需在 HAL_TIM_PeriodElapsedCallback() 中调用此函数
+ *          t3.5内未收到新字节时结束当前帧
+ * 
+ * @code
+ *          void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim) {
+ *              if (htim->Instance == TIM6) {
+ *                  Modbus_TimerCallback(&hModbus1);
+ *              }
+ *          }
+ * @endcode
+ */
+void Modbus_TimerCallback(ModbusHandle_t *hmodbus);
+
 /**
  * @brief   UART发送完成回调 (DMA模式专用)
  * @param   hmodbus Modbus句柄指针
  * 
  * @note    仅在 use_dma_tx = true 时需要调用
  *          需在 HAL_UART_TxCpltCallback() 中调用此函数
- *          用于DMA发送完成后切换RS485方向
+ *          用于DMA发送完成后切换RS485方向，流水线发送时在此接续发送帧头之后的数据部分
+ *          最后一个字节尚未移出时使能TC中断后立即返回，由TC中断再次回调完成切换，中断内不等待
+ *          配置 transport 时由驱动在最后一个字节完全移出后调用
  */
 void Modbus_TxCallback(ModbusHandle_t *hmodbus);
 
@@ -305,7 +1273,7 @@ void Modbus_SetSlaveAddr(ModbusHandle_t *hmodbus, uint8_t addr);
  * @param   hmodbus   Modbus句柄指针
  * @param   baud_rate 新的波特率
  * 
- * @note    此函数仅更新运行时波特率配置(用于超时计算)
+ * @note    此函数仅更新运行时波特率配置(用于超时计算及t1.5/t3.5帧定时)
  *          实际UART波特率修改需调用 HAL_UART_Init()
  */
 void Modbus_SetBaudRate(ModbusHandle_t *hmodbus, uint32_t baud_rate);
@@ -316,9 +1284,349 @@ void Modbus_SetBaudRate(ModbusHandle_t *hmodbus, uint32_t baud_rate);
  * 
  * @note    通常由 Modbus_Init() 自动调用
  *          在某些错误恢复场景下可手动调用以重新启动接收
+ *          (如在 HAL_UART_ErrorCallback() 中; 环形模式下会丢弃环中未完成的数据)
  */
 void Modbus_StartReceive(ModbusHandle_t *hmodbus);
 
+/**
+ * @brief   查询实例是否完全空闲
+ * @param   hmodbus Modbus句柄指针
+ * @retval  true    无接收中的帧、无待处理请求、响应已全部发完 (RS485已切回接收)，且无待提交的写入与等待中的网关请求
+ * @retval  false   仍有工作，应继续调用 Modbus_Process()
+ * 
+ * @note    用于判断能否进入低功耗模式; 传输层未提供 rx_count 时无法得知接收中的帧
+ *          为避免判断后、休眠前又收到数据，应在关中断后判断 (WFI在关中断时仍会被挂起的中断唤醒)
+ */
+bool Modbus_IsIdle(const ModbusHandle_t *hmodbus);
+
+/**
+ * @brief   进入STOP模式前调用: 实例空闲时使能USART唤醒
+ * @param   hmodbus Modbus句柄指针
+ * @retval  true    实例空闲，可以休眠 (配置 stop_wake 时已使能唤醒)
+ * @retval  false   实例不空闲，不应休眠
+ * 
+ * @note    stop_wake 需将该USART的内核时钟选为HSI或LSE (CubeMX: RCC_USARTxCLKSOURCE_HSI)，
+ *          波特率在STOP模式下保持不变，起始位唤醒MCU后该字节仍被完整接收;
+ *          Modbus地址不带地址标记位，无法使用USART地址匹配唤醒
+ *          唤醒后应先开中断处理接收，再恢复系统时钟，最后调用 Modbus_ExitStop()
+ * 
+ * @code
+ *          __disable_irq();
+ *          if (Modbus_EnterStop(&hModbus)) {
+ *              HAL_SuspendTick();
+ *              HAL_PWREx_EnterSTOP2Mode(PWR_STOPENTRY_WFI);
+ *              __enable_irq();           // 首字节的接收中断先于时钟恢复处理
+ *              SystemClock_Config();
+ *              HAL_ResumeTick();
+ *              Modbus_ExitStop(&hModbus);
+ *          }
+ *          __enable_irq();
+ * @endcode
+ */
+bool Modbus_EnterStop(ModbusHandle_t *hmodbus);
+
+/**
+ * @brief   自STOP模式唤醒后调用: 关闭USART唤醒并在接收已中止时重新启动接收
+ * @param   hmodbus Modbus句柄指针
+ * 
+ * @note    唤醒期间若发生溢出等错误使HAL中止了接收，此处重新启动接收，下一帧不会丢失
+ */
+void Modbus_ExitStop(ModbusHandle_t *hmodbus);
+
+#if MODBUS_MAX_INSTANCES > 0
+/**
+ * @brief   按UART查找已登记的Modbus实例
+ * @param   huart HAL UART句柄指针
+ * @return  Modbus句柄指针 (未登记时返回NULL)
+ * 
+ * @note    以USART外设地址为键的散列表查找，复杂度O(1)，可在中断中调用
+ */
+ModbusHandle_t *Modbus_FindByUart(const UART_HandleTypeDef *huart);
+
+/**
+ * @brief   接收事件分发
+ * @param   huart HAL UART句柄指针
+ * @param   size  接收数据长度
+ * 
+ * @note    替代 HAL_UARTEx_RxEventCallback() 中按实例的if/else分支
+ * 
+ * @code
+ *          void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) {
+ *              Modbus_DispatchRxEvent(huart, Size);
+ *          }
+ * @endcode
+ */
+void Modbus_DispatchRxEvent(UART_HandleTypeDef *huart, uint16_t size);
+
+/**
+ * @brief   发送完成分发
+ * @param   huart HAL UART句柄指针
+ * 
+ * @note    在 HAL_UART_TxCpltCallback() 中调用
+ */
+void Modbus_DispatchTxCplt(UART_HandleTypeDef *huart);
+
+/**
+ * @brief   处理所有就绪实例
+ * 
+ * @note    替代主循环中对每个实例调用 Modbus_Process()
+ *          仅处理就绪位图中置位的实例 (收到完整帧，或有排队响应待发送)，空闲实例不产生开销
+ * 
+ * @warning 与 Modbus_Process() 相同，需确保单一上下文调用
+ */
+void Modbus_ProcessAll(void);
+
+/**
+ * @brief   处理指定槽位中的就绪实例
+ * @param   slot_mask 注册表槽位掩码 (bit n 对应第n个登记的实例)
+ * @retval  true  仍有实例需要再次处理 (排队响应等待帧间隔或请求等待发送槽)
+ * @retval  false 所选实例均已处理完毕
+ * 
+ * @note    供RTOS端口将实例固定分配给多个工作任务使用，每个实例只能属于一个任务;
+ *          返回true时调用者应在约1ms后再次调用，此种再次就绪不会触发 ready_cb
+ */
+bool Modbus_ProcessReady(uint32_t slot_mask);
+
+/**
+ * @brief   检查网关路由两端是否落在同一处理分组
+ * @param   group_count 分组数 (实例按 注册表槽位 % group_count 分组)
+ * @retval  true    所有已登记实例的路由目标均已登记，且与来源实例槽位同余
+ * @retval  false   存在未登记的路由目标，或上下游分属不同分组
+ * 
+ * @note    转发、应答与超时在上下游实例间直接读写对方的发送队列与等待状态，
+ *          二者必须由同一上下文处理; 供RTOS端口在按槽位分配多个工作任务前校验
+ */
+bool Modbus_RoutesGrouped(uint32_t group_count);
+#endif
+
+/**
+ * @brief   读取帧内第 idx 字节
+ * @param   frame 帧描述符指针
+ * @param   idx   帧内字节序号 (0 = 从站地址)
+ * @return  字节值
+ */
+static inline uint8_t Modbus_FrameByte(const Modbus_Frame_t *frame, uint16_t idx) {
+    return (idx < frame->wrap) ? frame->base[frame->offset + idx] : frame->base[idx - frame->wrap];
+}
+
+/**
+ * @brief   读取帧内从 idx 开始的大端16位字段
+ * @param   frame 帧描述符指针
+ * @param   idx   高字节在帧内的序号
+ * @return  16位字段值
+ */
+static inline uint16_t Modbus_FrameU16(const Modbus_Frame_t *frame, uint16_t idx) {
+    return (uint16_t)((Modbus_FrameByte(frame, idx) << 8) | Modbus_FrameByte(frame, idx + 1));
+}
+
+/**
+ * @brief   获取帧内从 idx 开始的连续片段
+ * @param   frame 帧描述符指针
+ * @param   idx   起始字节序号
+ * @return  片段起始地址; 不回绕的连续长度由 Modbus_FrameSpanLen() 给出
+ */
+static inline const uint8_t* Modbus_FrameSpan(const Modbus_Frame_t *frame, uint16_t idx) {
+    return (idx < frame->wrap) ? &frame->base[frame->offset + idx] : &frame->base[idx - frame->wrap];
+}
+
+/**
+ * @brief   计算帧内从 idx 开始、期望长度 len 的片段中不回绕的连续长度
+ */
+static inline uint16_t Modbus_FrameSpanLen(const Modbus_Frame_t *frame, uint16_t idx, uint16_t len) {
+    return (idx < frame->wrap && frame->wrap - idx < len) ? (uint16_t)(frame->wrap - idx) : len;
+}
+
+/**
+ * @brief   从帧中拷贝 len 字节到线性缓冲区 (自动处理回绕)
+ * @param   frame 帧描述符指针
+ * @param   idx   起始字节序号
+ * @param   dst   目标缓冲区
+ * @param   len   拷贝长度
+ */
+void Modbus_FrameCopy(const Modbus_Frame_t *frame, uint16_t idx, uint8_t *dst, uint16_t len);
+
+/**
+ * @brief   寄存器数组转换为大端字节流 (0x03/0x04响应数据)
+ * @param   dst   目标字节缓冲区 (可不对齐)
+ * @param   src   源寄存器数组
+ * @param   count 寄存器数量
+ * 
+ * @note    每次读取两个寄存器(32位)，经 __REV16 交换字节序后整字写出
+ */
+void Modbus_RegsToBytes(uint8_t *dst, const uint16_t *src, uint16_t count);
+
+/**
+ * @brief   大端字节流转换为寄存器数组 (0x10请求数据)
+ * @param   dst   目标寄存器数组
+ * @param   src   源字节缓冲区 (可不对齐)
+ * @param   count 寄存器数量
+ */
+void Modbus_BytesToRegs(uint16_t *dst, const uint8_t *src, uint16_t count);
+
+/**
+ * @brief   从位压缩数组中提取连续位段 (0x01/0x02响应数据)
+ * @param   dst   目标字节缓冲区 (从bit0开始打包, 末字节高位补0)
+ * @param   src   源位压缩数组 (coils/discrete_inputs)
+ * @param   start 起始位序号 (可不按字节对齐)
+ * @param   count 位数
+ * 
+ * @note    按32位整字移位拼接，仅末尾不足一字的部分逐字节处理
+ */
+void Modbus_BitsExtract(uint8_t *dst, const uint8_t *src, uint16_t start, uint16_t count);
+
+/**
+ * @brief   将连续位段写入位压缩数组 (0x0F请求数据)
+ * @param   dst   目标位压缩数组 (coils)
+ * @param   start 起始位序号 (可不按字节对齐)
+ * @param   src   源字节缓冲区 (从bit0开始打包)
+ * @param   count 位数
+ * 
+ * @note    首尾字节按掩码合并，位段之外的位保持不变
+ */
+void Modbus_BitsInsert(uint8_t *dst, uint16_t start, const uint8_t *src, uint16_t count);
+
+/**
+ * @brief   注册功能码处理函数
+ * @param   func_code   功能码 (1 ~ MODBUS_FUNC_TABLE_SIZE-1)
+ * @param   handler     处理函数 (NULL=注销，该功能码返回非法功能码异常)
+ * @retval  true        已注册
+ * @retval  false       功能码超出分发表范围
+ * 
+ * @note    分发表为所有实例共用，处理函数可通过 hmodbus 区分实例; 可覆盖内置功能码
+ *          应在 Modbus_Init() 之前或确保无请求处理时调用
+ *          覆盖0x01~0x04后中断快速路径不再应答该功能码
+ * 
+ * @code
+ *          static uint16_t App_ReportSlaveId(ModbusHandle_t *hmodbus, const Modbus_Request_t *req, uint8_t *tx) {
+ *              tx[2] = 2;
+ *              tx[3] = 0x42;      // 设备标识
+ *              tx[4] = 0xFF;      // 运行状态
+ *              return 5;
+ *          }
+ *          Modbus_RegisterFunction(0x11, App_ReportSlaveId);
+ * @endcode
+ */
+bool Modbus_RegisterFunction(uint8_t func_code, Modbus_FuncHandler_t handler);
+
+/**
+ * @brief   使段读取缓存失效
+ * @param   seg 段指针
+ * 
+ * @note    应用层得知底层数据已变化时调用，下次读请求将重新调用提供者;
+ *          协议栈在写入该段后自动调用
+ */
+void Modbus_SegmentInvalidate(const Modbus_Segment_t *seg);
+
+/**
+ * @brief   通知协议栈数据区已被应用修改，使所有实例的响应缓存失效
+ * 
+ * @note    可在中断与任一任务中调用; 未配置 resp_cache 时无需调用
+ *          修改完成后调用: 修改期间组帧的响应在调用后不再重发
+ */
+void Modbus_DataChanged(void);
+
+/**
+ * @brief   取出一段被主站写入过的连续地址并清除其脏位
+ * @param   hmodbus  Modbus句柄指针
+ * @param   area     数据区 (MODBUS_AREA_COILS 或 MODBUS_AREA_HOLDING)
+ * @param   start    输出: 起始地址
+ * @param   quantity 输出: 数量
+ * @retval  true     取得一段变更
+ * @retval  false    该数据区没有未取出的变更
+ * 
+ * @note    按地址升序返回，仅扫描配置了脏位图的段，每个32位字一次判零;
+ *          先清除脏位再返回，调用方随后读取的数据不早于被清除的写入;
+ *          可在任意任务中调用，与协议栈置位互斥由短临界区保证
+ * 
+ * @code
+ *          uint16_t start, qty;
+ *          while (Modbus_DirtyFetch(&hModbus1, MODBUS_AREA_HOLDING, &start, &qty)) {
+ *              Control_ApplyRegisters(start, qty);
+ *          }
+ * @endcode
+ */
+bool Modbus_DirtyFetch(ModbusHandle_t *hmodbus, Modbus_Area_t area, uint16_t *start, uint16_t *quantity);
+
+/**
+ * @brief   从写入事件队列取出最早的一个事件
+ * @param   hmodbus Modbus句柄指针
+ * @param   event   输出: 事件
+ * @retval  true    取得一个事件
+ * @retval  false   队列为空或未配置 event_queue
+ * 
+ * @note    无锁，与 Modbus_Process() 可在不同任务或中断中并发执行;
+ *          同一实例只允许一个上下文取出 (不可与 Modbus_EventDispatch() 混用于不同任务)
+ */
+bool Modbus_EventFetch(ModbusHandle_t *hmodbus, Modbus_Event_t *event);
+
+/**
+ * @brief   取出并处理队列中的全部写入事件
+ * @param   hmodbus Modbus句柄指针
+ * @return  本次处理的事件数
+ * 
+ * @note    0x64事件 (defer_config) 调用 custom_config_cb，其返回值被忽略; 其他事件调用 event_cb;
+ *          应在低于 Modbus_Process() 的优先级调用，回调耗时不影响应答延迟
+ * 
+ * @code
+ *          void App_LowPriorityTask(void *arg) {
+ *              for (;;) {
+ *                  Modbus_EventDispatch(&hModbus1);
+ *                  osDelay(10);
+ *              }
+ *          }
+ * @endcode
+ */
+uint32_t Modbus_EventDispatch(ModbusHandle_t *hmodbus);
+
+/**
+ * @brief   开始更新顺序锁保护的数据 (序号变为奇数)
+ * @param   lock 顺序锁指针
+ * 
+ * @note    与 Modbus_SeqlockWriteEnd() 成对调用，期间完成的多个寄存器修改对读请求整体可见;
+ *          可在任务或中断中调用，不阻塞、不关中断; 同一把锁的写入方之间须自行互斥
+ *          (如应用写入方与协议栈写请求并存时配置 lock_cb)
+ * 
+ * @code
+ *          Modbus_SeqlockWriteBegin(&data_lock);
+ *          memcpy(&holding_regs[10], &flow_rate, sizeof(float));
+ *          Modbus_SeqlockWriteEnd(&data_lock);
+ * @endcode
+ */
+void Modbus_SeqlockWriteBegin(Modbus_Seqlock_t *lock);
+
+/**
+ * @brief   结束更新顺序锁保护的数据 (序号恢复为偶数)
+ * @param   lock 顺序锁指针
+ */
+void Modbus_SeqlockWriteEnd(Modbus_Seqlock_t *lock);
+
+#if MODBUS_STATS_ENABLED
+/**
+ * @brief   获取实例统计
+ * @param   hmodbus Modbus句柄指针
+ * @return  统计结构体指针 (由协议栈持续更新，读取期间可能变化)
+ * 
+ * @code
+ *          const Modbus_Stats_t *st = Modbus_GetStats(&hModbus1);
+ *          const Modbus_Histogram_t *parse = &st->timing[MODBUS_TIMING_PARSE];
+ *          if (parse->max_us > budget_us) {
+ *              Log("fc 0x%02X took %lu us", parse->max_func_code, parse->max_us);
+ *          }
+ * @endcode
+ */
+static inline const Modbus_Stats_t *Modbus_GetStats(const ModbusHandle_t *hmodbus) {
+    return &hmodbus->stats;
+}
+
+/**
+ * @brief   清零实例统计与耗时直方图
+ * @param   hmodbus Modbus句柄指针
+ * 
+ * @note    同时按当前 SystemCoreClock 重新换算周期计数，修改系统时钟后应调用一次
+ */
+void Modbus_StatsReset(ModbusHandle_t *hmodbus);
+#endif
+
 /**
  * @brief   获取当前从站地址
  * @param   hmodbus Modbus句柄指针
@@ -337,6 +1645,26 @@ static inline uint32_t Modbus_GetBaudRate(const ModbusHandle_t *hmodbus) {
     return hmodbus->baud_rate;
 }
 
+/**
+ * @brief   获取发送状态
+ * @param   hmodbus Modbus句柄指针
+ * @return  当前发送状态
+ */
+static inline Modbus_TxState_t Modbus_GetTxState(const ModbusHandle_t *hmodbus) {
+    return hmodbus->tx_state;
+}
+
+/**
+ * @brief   获取传输层驱动上下文
+ * @param   hmodbus Modbus句柄指针
+ * @return  Modbus_Config_t.transport_ctx
+ * 
+ * @note    供 Modbus_Transport_t 的实现由句柄找回驱动状态
+ */
+static inline void *Modbus_GetTransportCtx(const ModbusHandle_t *hmodbus) {
+    return hmodbus->transport_ctx;
+}
+
 /**
  * @brief   设置用户自定义数据
  * @param   hmodbus   Modbus句柄指针
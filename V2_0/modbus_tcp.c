@@ -0,0 +1,299 @@
+/**
+ * @file    modbus_tcp.c
+ * @brief   Modbus从站协议栈 Modbus TCP / RTU over TCP 服务端前端实现
+ * @version 2.0.0
+ * @date    2025
+ * 
+ * @details 本文件实现:
+ *          - 字节流分帧: MBAP按长度字段，RTU over TCP按功能码推算请求长度
+ *          - 完整请求直接在收到的数据中处理，只有跨报文的半帧才复制到连接缓存
+ *          - 请求经 Modbus_Execute() 处理，响应在共用的发送缓冲区中组帧后立即发出
+ *          - 连接表已满时替换最久未活动的连接，空闲超时关闭
+ */
+
+#include "modbus_tcp.h"
+#include <string.h>
+
+/* ============================================================================
+ *                              内部函数声明
+ * ============================================================================ */
+
+static ModbusTCP_Conn_t *ModbusTCP_Find(ModbusTCP_Server_t *server, const void *ctx);
+static int32_t ModbusTCP_FrameLen(const ModbusTCP_Server_t *server, const uint8_t *buf, uint16_t avail);
+static int32_t ModbusTCP_Consume(ModbusTCP_Server_t *server, ModbusTCP_Conn_t *conn,
+                                 const uint8_t *buf, uint16_t avail);
+static void ModbusTCP_Request(ModbusTCP_Server_t *server, ModbusTCP_Conn_t *conn,
+                              const uint8_t *frame, uint16_t len);
+
+/* ============================================================================
+ *                              API函数实现
+ * ============================================================================ */
+
+/**
+ * @brief   初始化TCP服务端
+ */
+bool ModbusTCP_Init(ModbusTCP_Server_t *server, const Modbus_Config_t *modbus, const ModbusTCP_Config_t *config) {
+    if (server == NULL || modbus == NULL || config == NULL || config->send == NULL) {
+        return false;
+    }
+    if (config->framing != MODBUS_TCP_MBAP && config->framing != MODBUS_TCP_RTU) {
+        return false;
+    }
+    
+    memset(server->conn, 0, sizeof(server->conn));
+    server->config = *config;
+    return Modbus_InitEngine(&server->engine, modbus);
+}
+
+/**
+ * @brief   登记新连接
+ */
+bool ModbusTCP_Open(ModbusTCP_Server_t *server, void *ctx) {
+    if (server == NULL || ctx == NULL) {
+        return false;
+    }
+    
+    /* 优先使用空闲槽，否则替换最久未收到数据的连接 */
+    ModbusTCP_Conn_t *conn = ModbusTCP_Find(server, NULL);
+    if (conn == NULL) {
+        if (server->config.close == NULL) {
+            return false;
+        }
+        uint32_t now = HAL_GetTick();
+        conn = &server->conn[0];
+        for (uint32_t i = 1; i < MODBUS_TCP_MAX_CONN; i++) {
+            if ((uint32_t)(now - server->conn[i].last_tick) > (uint32_t)(now - conn->last_tick)) {
+                conn = &server->conn[i];
+            }
+        }
+        server->config.close(conn->ctx);
+    }
+    
+    conn->ctx = ctx;
+    conn->rx_len = 0;
+    conn->last_tick = HAL_GetTick();
+    return true;
+}
+
+/**
+ * @brief   注销连接
+ */
+void ModbusTCP_Close(ModbusTCP_Server_t *server, void *ctx) {
+    if (server == NULL || ctx == NULL) {
+        return;
+    }
+    
+    ModbusTCP_Conn_t *conn = ModbusTCP_Find(server, ctx);
+    if (conn != NULL) {
+        conn->ctx = NULL;
+        conn->rx_len = 0;
+    }
+}
+
+/**
+ * @brief   处理收到的数据
+ */
+bool ModbusTCP_Receive(ModbusTCP_Server_t *server, void *ctx, const uint8_t *data, uint16_t len) {
+    if (server == NULL || ctx == NULL || (data == NULL && len > 0)) {
+        return false;
+    }
+    
+    ModbusTCP_Conn_t *conn = ModbusTCP_Find(server, ctx);
+    if (conn == NULL) {
+        return false;
+    }
+    conn->last_tick = HAL_GetTick();
+    
+    while (len > 0) {
+        if (conn->rx_len == 0) {
+            /* 无缓存半帧: 直接处理数据中的完整请求，剩余不足一帧的部分存入缓存 */
+            int32_t used = ModbusTCP_Consume(server, conn, data, len);
+            if (used < 0) {
+                return false;
+            }
+            data += used;
+            len -= (uint16_t)used;
+            memcpy(conn->rx_buf, data, len);
+            conn->rx_len = len;
+            break;
+        }
+        
+        /* 补足缓存中的半帧后处理，未用完的字节留待下一轮 */
+        uint16_t copy = MODBUS_TCP_ADU_MAX - conn->rx_len;
+        if (copy > len) {
+            copy = len;
+        }
+        memcpy(&conn->rx_buf[conn->rx_len], data, copy);
+        conn->rx_len += copy;
+        data += copy;
+        len -= copy;
+        
+        int32_t used = ModbusTCP_Consume(server, conn, conn->rx_buf, conn->rx_len);
+        if (used < 0) {
+            return false;
+        }
+        conn->rx_len -= (uint16_t)used;
+        memmove(conn->rx_buf, &conn->rx_buf[used], conn->rx_len);
+    }
+    
+    /* 响应已发出: 提交到期的写入变更 */
+    Modbus_Process(&server->engine);
+    return true;
+}
+
+/**
+ * @brief   周期处理: 提交写入变更、关闭空闲超时的连接
+ */
+void ModbusTCP_Poll(ModbusTCP_Server_t *server) {
+    if (server == NULL) {
+        return;
+    }
+    
+    Modbus_Process(&server->engine);
+    
+    if (server->config.idle_timeout_ms == 0 || server->config.close == NULL) {
+        return;
+    }
+    uint32_t now = HAL_GetTick();
+    for (uint32_t i = 0; i < MODBUS_TCP_MAX_CONN; i++) {
+        ModbusTCP_Conn_t *conn = &server->conn[i];
+        if (conn->ctx != NULL && (uint32_t)(now - conn->last_tick) >= server->config.idle_timeout_ms) {
+            void *ctx = conn->ctx;
+            conn->ctx = NULL;
+            conn->rx_len = 0;
+            server->config.close(ctx);
+        }
+    }
+}
+
+/* ============================================================================
+ *                              内部函数实现
+ * ============================================================================ */
+
+/**
+ * @brief   按连接句柄查找连接 (ctx 为NULL时查找空闲槽)
+ * @param   server  服务端状态
+ * @param   ctx     连接句柄
+ * @return  连接状态指针，未找到时返回NULL
+ */
+static ModbusTCP_Conn_t *ModbusTCP_Find(ModbusTCP_Server_t *server, const void *ctx) {
+    for (uint32_t i = 0; i < MODBUS_TCP_MAX_CONN; i++) {
+        if (server->conn[i].ctx == ctx) {
+            return &server->conn[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief   推算字节流开头一帧请求的长度
+ * @param   server  服务端状态
+ * @param   buf     帧起始
+ * @param   avail   已收到的字节数 (大于0)
+ * @return  帧长度 (可能大于 avail); 0表示需收到更多字节才能判定; -1表示帧格式错误
+ */
+static int32_t ModbusTCP_FrameLen(const ModbusTCP_Server_t *server, const uint8_t *buf, uint16_t avail) {
+    if (server->config.framing == MODBUS_TCP_MBAP) {
+        /* 协议号须为0; 长度字段计单元号与PDU，至少含功能码 */
+        if (avail >= 4 && (buf[2] != 0 || buf[3] != 0)) {
+            return -1;
+        }
+        if (avail < 6) {
+            return 0;
+        }
+        uint16_t length = (uint16_t)((buf[4] << 8) | buf[5]);
+        if (length < 2 || length > MODBUS_TCP_ADU_MAX - 6U) {
+            return -1;
+        }
+        return 6 + (int32_t)length;
+    }
+    
+    /* RTU over TCP: 按功能码确定请求长度 (含CRC) */
+    if (avail < 2) {
+        return 0;
+    }
+    int32_t length;
+    switch (buf[1]) {
+        case 0x01: case 0x02: case 0x03: case 0x04:
+        case 0x05: case 0x06: case 0x08: case 0x64:
+            return 8;
+        case 0x16:
+            return 10;
+        case 0x0F: case 0x10:
+            if (avail < 7) {
+                return 0;
+            }
+            length = 9 + (int32_t)buf[6];
+            break;
+        case 0x17:
+            if (avail < 11) {
+                return 0;
+            }
+            length = 13 + (int32_t)buf[10];
+            break;
+        default:
+            return avail;  /* 长度未知: 以已收到的数据为一帧 */
+    }
+    return (length > MODBUS_RTU_ADU_MAX) ? -1 : length;
+}
+
+/**
+ * @brief   依次处理缓冲区开头的完整请求
+ * @param   server  服务端状态
+ * @param   conn    连接状态
+ * @param   buf     字节流
+ * @param   avail   字节数
+ * @return  已处理的字节数; -1表示帧格式错误
+ */
+static int32_t ModbusTCP_Consume(ModbusTCP_Server_t *server, ModbusTCP_Conn_t *conn,
+                                 const uint8_t *buf, uint16_t avail) {
+    uint16_t pos = 0;
+    
+    while (pos < avail) {
+        int32_t len = ModbusTCP_FrameLen(server, &buf[pos], avail - pos);
+        if (len < 0) {
+            return -1;
+        }
+        if (len == 0 || len > (int32_t)(avail - pos)) {
+            break;  /* 半帧 */
+        }
+        ModbusTCP_Request(server, conn, &buf[pos], (uint16_t)len);
+        pos += (uint16_t)len;
+    }
+    return pos;
+}
+
+/**
+ * @brief   处理一帧请求并发送响应
+ * @param   server  服务端状态
+ * @param   conn    连接状态
+ * @param   frame   完整请求帧
+ * @param   len     帧长度
+ */
+static void ModbusTCP_Request(ModbusTCP_Server_t *server, ModbusTCP_Conn_t *conn,
+                              const uint8_t *frame, uint16_t len) {
+    uint8_t *tx = server->tx_buf;
+    uint16_t reply;
+    
+    if (server->config.framing == MODBUS_TCP_RTU) {
+        reply = Modbus_Execute(&server->engine, frame, len, tx, MODBUS_TCP_ADU_MAX, true);
+    } else {
+        /* PDU之前的单元号按RTU从站地址处理; 响应回送事务号与单元号 */
+        reply = Modbus_Execute(&server->engine, &frame[6], len - 6U, &tx[6], MODBUS_TCP_ADU_MAX - 6U, false);
+        if (reply == 0) {
+            return;
+        }
+        tx[0] = frame[0];
+        tx[1] = frame[1];
+        tx[2] = 0;
+        tx[3] = 0;
+        tx[4] = (uint8_t)(reply >> 8);
+        tx[5] = (uint8_t)reply;
+        tx[6] = frame[6];
+        reply += 6U;
+    }
+    
+    if (reply != 0) {
+        (void)server->config.send(conn->ctx, tx, reply);
+    }
+}
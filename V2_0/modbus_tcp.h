@@ -0,0 +1,200 @@
+/**
+ * @file    modbus_tcp.h
+ * @brief   Modbus从站协议栈 Modbus TCP / RTU over TCP 服务端前端 (可选)
+ * @version 2.0.0
+ * @date    2025
+ * 
+ * @details 以TCP字节流替代串口，请求经 Modbus_Execute() 交给与RTU实例相同的分发表与数据区:
+ *          1. MBAP帧 (事务号/协议号/长度/单元号 + PDU) 或 RTU over TCP 帧 (RTU帧原样经TCP传输)
+ *          2. 每个连接独立拼接跨TCP报文的半帧; 同一报文中的多个请求 (流水线事务号) 依次应答
+ *          3. 最多 MODBUS_TCP_MAX_CONN 个并发连接，已满时关闭最久未活动的连接接纳新连接
+ *          4. 无CRC计算 (MBAP) 与RS485控制，data_map 可与串口实例指向同一份数据
+ * 
+ * @note    与网络协议栈无关: 应用在接受连接、收到数据、连接关闭时调用对应函数，
+ *          并提供发送函数 (lwIP raw API 示例见 ModbusTCP_Init())
+ *          所有函数须在同一上下文中调用 (如lwIP的tcpip线程或NO_SYS主循环);
+ *          与串口实例在不同任务中运行时，经 lock_cb 互斥访问共享数据 (见 modbus_rtos.h)
+ */
+
+#ifndef __MODBUS_TCP_H
+#define __MODBUS_TCP_H
+
+#include "modbus_slave.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================
+ *                              前端配置
+ * ============================================================================ */
+
+/**
+ * @brief   最大并发连接数
+ */
+#ifndef MODBUS_TCP_MAX_CONN
+#define MODBUS_TCP_MAX_CONN          4
+#endif
+
+/**
+ * @brief   MBAP头长度 (事务号2 + 协议号2 + 长度2 + 单元号1)
+ */
+#define MODBUS_TCP_MBAP_LEN          7U
+
+/**
+ * @brief   最大帧长度: MBAP头之后 单元号 + 253字节PDU
+ */
+#define MODBUS_TCP_ADU_MAX           260U
+
+/**
+ * @brief   帧格式
+ */
+typedef enum {
+    MODBUS_TCP_MBAP = 0,          /**< Modbus TCP: MBAP头 + PDU，无CRC (默认) */
+    MODBUS_TCP_RTU                /**< RTU over TCP: 从站地址 + PDU + CRC */
+} ModbusTCP_Framing_t;
+
+/**
+ * @brief   发送响应函数
+ * @param   conn_ctx 连接句柄 (ModbusTCP_Open() 传入的值)
+ * @param   data     响应帧 (返回后缓冲区即被复用，须复制或立即发出)
+ * @param   len      响应帧长度
+ * @retval  true     已发出或已入队
+ * @retval  false    发送失败 (该响应被丢弃)
+ */
+typedef bool (*ModbusTCP_SendFunc_t)(void *conn_ctx, const uint8_t *data, uint16_t len);
+
+/**
+ * @brief   关闭连接函数 (连接被新连接替换或空闲超时时由前端调用)
+ * @param   conn_ctx 连接句柄
+ */
+typedef void (*ModbusTCP_CloseFunc_t)(void *conn_ctx);
+
+/**
+ * @brief   前端配置结构体
+ */
+typedef struct {
+    ModbusTCP_Framing_t   framing;          /**< 帧格式 */
+    ModbusTCP_SendFunc_t  send;             /**< 发送响应 (必须) */
+    ModbusTCP_CloseFunc_t close;            /**< 关闭连接 (可为NULL: 连接已满时拒绝新连接、不做空闲超时) */
+    uint32_t              idle_timeout_ms;  /**< 无请求超过该时间的连接由 ModbusTCP_Poll() 关闭 (0=不超时) */
+} ModbusTCP_Config_t;
+
+/**
+ * @brief   连接状态
+ */
+typedef struct {
+    void     *ctx;                           /**< 连接句柄 (NULL=空闲) */
+    uint32_t  last_tick;                     /**< 最近收到数据的时刻 (HAL_GetTick) */
+    uint16_t  rx_len;                        /**< 已缓存的半帧字节数 */
+    uint8_t   rx_buf[MODBUS_TCP_ADU_MAX];    /**< 半帧缓存 (跨TCP报文的请求) */
+} ModbusTCP_Conn_t;
+
+/**
+ * @brief   服务端状态
+ * @note    由 ModbusTCP_Init() 初始化，用户不应直接修改;
+ *          engine 可用于 Modbus_GetStats() / Modbus_SetUserData() 等
+ */
+typedef struct {
+    ModbusHandle_t      engine;                        /**< 协议引擎实例 (Modbus_InitEngine) */
+    ModbusTCP_Config_t  config;                        /**< 前端配置 */
+    ModbusTCP_Conn_t    conn[MODBUS_TCP_MAX_CONN];     /**< 连接表 */
+    uint8_t             tx_buf[MODBUS_TCP_ADU_MAX];    /**< 响应组帧缓冲区 (各连接共用) */
+} ModbusTCP_Server_t;
+
+/* ============================================================================
+ *                              API函数声明
+ * ============================================================================ */
+
+/**
+ * @brief   初始化TCP服务端
+ * @param   server  服务端状态
+ * @param   modbus  协议引擎配置 (slave_addr、data_map、回调等，见 Modbus_InitEngine())
+ * @param   config  前端配置
+ * @retval  true    初始化成功
+ * @retval  false   参数无效
+ * 
+ * @note    MBAP帧的单元号须为 slave_addr、0或0xFF (0与0xFF均指本服务端，多数客户端默认发送0)，响应回送请求的单元号;
+ *          RTU over TCP 帧的地址规则与RTU相同 (slave_addr 或0xFF)
+ * 
+ * @code
+ *          static ModbusTCP_Server_t tcp;
+ * 
+ *          static bool App_TcpSend(void *ctx, const uint8_t *data, uint16_t len) {
+ *              return tcp_write(ctx, data, len, TCP_WRITE_FLAG_COPY) == ERR_OK && tcp_output(ctx) == ERR_OK;
+ *          }
+ * 
+ *          static err_t App_TcpRecv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err) {
+ *              if (p == NULL) {
+ *                  ModbusTCP_Close(&tcp, pcb);
+ *                  tcp_close(pcb);
+ *                  return ERR_OK;
+ *              }
+ *              bool ok = true;
+ *              for (struct pbuf *q = p; q != NULL && ok; q = q->next) {
+ *                  ok = ModbusTCP_Receive(&tcp, pcb, q->payload, q->len);
+ *              }
+ *              tcp_recved(pcb, p->tot_len);
+ *              pbuf_free(p);
+ *              if (!ok) {
+ *                  ModbusTCP_Close(&tcp, pcb);
+ *                  tcp_abort(pcb);
+ *                  return ERR_ABRT;
+ *              }
+ *              return ERR_OK;
+ *          }
+ * 
+ *          Modbus_Config_t engine_cfg = { .slave_addr = 1, .data_map = shared_map, .lock_cb = App_Lock };
+ *          ModbusTCP_Config_t tcp_cfg = { .send = App_TcpSend, .close = App_TcpClose, .idle_timeout_ms = 60000 };
+ *          ModbusTCP_Init(&tcp, &engine_cfg, &tcp_cfg);
+ *          // accept回调: if (!ModbusTCP_Open(&tcp, newpcb)) { tcp_abort(newpcb); return ERR_ABRT; }
+ * @endcode
+ */
+bool ModbusTCP_Init(ModbusTCP_Server_t *server, const Modbus_Config_t *modbus, const ModbusTCP_Config_t *config);
+
+/**
+ * @brief   登记新连接
+ * @param   server  服务端状态
+ * @param   ctx     连接句柄 (如 struct tcp_pcb *, 不可为NULL)
+ * @retval  true    已登记
+ * @retval  false   连接表已满且未配置 close，应拒绝该连接
+ * 
+ * @note    连接表已满时以 close 关闭最久未收到数据的连接，再登记新连接
+ */
+bool ModbusTCP_Open(ModbusTCP_Server_t *server, void *ctx);
+
+/**
+ * @brief   注销连接 (对端关闭、出错或应用主动关闭时调用)
+ * @param   server  服务端状态
+ * @param   ctx     连接句柄 (未登记时不做任何操作)
+ */
+void ModbusTCP_Close(ModbusTCP_Server_t *server, void *ctx);
+
+/**
+ * @brief   处理收到的数据
+ * @param   server  服务端状态
+ * @param   ctx     连接句柄
+ * @param   data    收到的字节流片段
+ * @param   len     片段长度
+ * @retval  true    已处理 (完整的请求已应答，半帧留待下次拼接)
+ * @retval  false   连接未登记或帧格式错误 (MBAP协议号非0、长度无效, RTU帧超长)，应关闭连接
+ * 
+ * @note    MBAP: 按长度字段划分请求; RTU over TCP: 按功能码推算请求长度 (0x01~0x06/0x08/0x0F/
+ *          0x10/0x16/0x17/0x64)，其他功能码以已收到的数据为一帧
+ *          应答经 config.send 在本函数内发出
+ */
+bool ModbusTCP_Receive(ModbusTCP_Server_t *server, void *ctx, const uint8_t *data, uint16_t len);
+
+/**
+ * @brief   周期处理: 提交写入变更、关闭空闲超时的连接
+ * @param   server  服务端状态
+ * 
+ * @note    在主循环或网络任务中周期调用 (配置 commit_window_ms 或 idle_timeout_ms 时必需)
+ */
+void ModbusTCP_Poll(ModbusTCP_Server_t *server);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MODBUS_TCP_H */